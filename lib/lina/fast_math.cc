@@ -0,0 +1,86 @@
+#include "fast_math.h"
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+
+// The angle is reduced onto [-pi/4, pi/4] by subtracting the closest multiple of pi/2, where the Taylor series
+// converge fast enough. The multiple of pi/2 is subtracted in two parts (Cody-Waite reduction). The first part has
+// only 33 significant bits, so its product with the quadrant stays exact, the second part holds the remaining bits.
+// Taylor remainders on [-pi/4, pi/4]: (pi/4)^17 / 17! < 5e-17 for the sine, (pi/4)^18 / 18! < 3e-18 for the cosine.
+auto lina::fastSinCos(double radians) -> SinCos
+{
+  constexpr auto twoOverPi = 2.0 / std::numbers::pi;
+  constexpr auto halfPiHigh = 1.5707963267341256e+00;
+  constexpr auto halfPiLow = 6.0771005065061922e-11;
+
+  auto const quadrant = std::floor((radians * twoOverPi) + 0.5);
+  auto const r = (radians - (quadrant * halfPiHigh)) - (quadrant * halfPiLow);
+  auto const r2 = r * r;
+
+  // Horner's scheme of the Taylor series
+  auto const sine =
+    r
+    + (r * r2
+       * (-1.0 / 6.0
+          + r2
+              * (1.0 / 120.0
+                 + r2
+                     * (-1.0 / 5040.0
+                        + r2
+                            * (1.0 / 362880.0
+                               + r2
+                                   * (-1.0 / 39916800.0
+                                      + r2 * (1.0 / 6227020800.0 + r2 * (-1.0 / 1307674368000.0))))))));
+  auto const cosine =
+    1.0
+    + (r2
+       * (-1.0 / 2.0
+          + r2
+              * (1.0 / 24.0
+                 + r2
+                     * (-1.0 / 720.0
+                        + r2
+                            * (1.0 / 40320.0
+                               + r2
+                                   * (-1.0 / 3628800.0
+                                      + r2 * (1.0 / 479001600.0
+                                               + r2 * (-1.0 / 87178291200.0 + r2 * (1.0 / 20922789888000.0)))))))));
+
+  // rotate the result back into the original quadrant
+  // NOLINTBEGIN(hicpp-signed-bitwise)
+  switch (static_cast<int64_t>(quadrant) & 3) {
+  case 0:
+    return SinCos{ sine, cosine };
+  case 1:
+    return SinCos{ cosine, -sine };
+  case 2:
+    return SinCos{ -sine, -cosine };
+  default:
+    return SinCos{ -cosine, sine };
+  }
+  // NOLINTEND(hicpp-signed-bitwise)
+}
+
+// The starting guess comes from dividing the exponent (and the mantissa with it) by three directly on the bit
+// pattern, which is within a few percent of the result. Each of Halley's iterations cubes the relative error, so
+// two of them are enough: ~3e-2 -> ~3e-5 -> ~3e-14.
+// Source: https://web.archive.org/web/20131227144655/http://metamerist.com/cbrt/cbrt.htm
+auto lina::fastCbrt(double value) -> double
+{
+  if (value == 0.0 || !std::isfinite(value)) { return value; }
+  auto const magnitude = std::fabs(value);
+  // Subnormal numbers would throw off the bit trick, so they are scaled up by 2^54 first, and the result down by 2^18.
+  auto const subnormal = magnitude < 2.2250738585072014e-308;
+  auto const scaled = subnormal ? magnitude * 18014398509481984.0 : magnitude;
+
+  constexpr auto magic = std::uint64_t{ 0x2A9F7893782DA1CE };
+  auto guess = std::bit_cast<double>((std::bit_cast<std::uint64_t>(scaled) / 3) + magic);
+  for (auto i = 0; i < 2; ++i) {
+    auto const cube = guess * guess * guess;
+    guess *= (cube + (2.0 * scaled)) / ((2.0 * cube) + scaled);
+  }
+  if (subnormal) { guess /= 262144.0; }
+  return std::copysign(guess, value);
+}
@@ -0,0 +1,25 @@
+#ifndef RAY_BUSTER_LIB_LINA_FAST_MATH_H_
+#define RAY_BUSTER_LIB_LINA_FAST_MATH_H_
+
+// Approximations of a few functions from <cmath>, that end up on the hot path of the sampling routines.
+// They are plain arithmetic, without any table lookups and with as few branches as possible, so they are cheap to
+// call and the compiler is free to vectorize loops using them. Their error bounds are well below anything visible
+// in a render, but they are not meant to replace the standard functions in general.
+namespace lina {
+
+struct SinCos
+{
+  double sin = 0.0;
+  double cos = 1.0;
+};
+
+// Both the sine and cosine of the angle at once.
+// The absolute error is below 1e-14 for |radians| < 1e6, where the argument reduction is still exact enough.
+auto fastSinCos(double radians) -> SinCos;
+
+// Cube root with a relative error below 1e-13, for any finite value.
+auto fastCbrt(double value) -> double;
+
+}// namespace lina
+
+#endif
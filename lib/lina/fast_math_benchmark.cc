@@ -0,0 +1,55 @@
+#include "lib/lina/fast_math.h"
+
+#include <array>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+
+// The inputs cover the ranges the sampling routines use: angles in [-pi, pi) and values in [0, 1).
+constexpr auto inputCount = std::size_t{ 1024 };
+
+static auto inputs(double min, double max) -> std::array<double, inputCount>
+{
+  auto values = std::array<double, inputCount>{};
+  for (auto i = std::size_t{ 0 }; i < inputCount; ++i) {
+    values.at(i) = min + ((max - min) * static_cast<double>((i * 509) % inputCount) / static_cast<double>(inputCount));
+  }
+  return values;
+}
+
+static void stdSinCos(benchmark::State& state)
+{
+  auto const angles = inputs(-std::numbers::pi, std::numbers::pi);
+  auto i = std::size_t{ 0 };
+  for (auto _ : state) {
+    auto const radians = angles[i++ % inputCount];
+    benchmark::DoNotOptimize(std::sin(radians));
+    benchmark::DoNotOptimize(std::cos(radians));
+  }
+}
+BENCHMARK(stdSinCos);
+
+static void fastSinCos(benchmark::State& state)
+{
+  auto const angles = inputs(-std::numbers::pi, std::numbers::pi);
+  auto i = std::size_t{ 0 };
+  for (auto _ : state) { benchmark::DoNotOptimize(lina::fastSinCos(angles[i++ % inputCount])); }
+}
+BENCHMARK(fastSinCos);
+
+static void stdCbrt(benchmark::State& state)
+{
+  auto const values = inputs(0.0, 1.0);
+  auto i = std::size_t{ 0 };
+  for (auto _ : state) { benchmark::DoNotOptimize(std::cbrt(values[i++ % inputCount])); }
+}
+BENCHMARK(stdCbrt);
+
+static void fastCbrt(benchmark::State& state)
+{
+  auto const values = inputs(0.0, 1.0);
+  auto i = std::size_t{ 0 };
+  for (auto _ : state) { benchmark::DoNotOptimize(lina::fastCbrt(values[i++ % inputCount])); }
+}
+BENCHMARK(fastCbrt);
@@ -0,0 +1,60 @@
+#include "lib/lina/fast_math.h"
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <numbers>
+
+TEST(fastSinCos, absoluteErrorIsBoundedOverSeveralPeriods)
+{
+  auto maxError = 0.0;
+  auto const steps = 1000000;
+  auto const range = 10.0 * std::numbers::pi;
+  for (auto i = 0; i <= steps; ++i) {
+    auto const radians = -range + (2.0 * range * static_cast<double>(i) / steps);
+    auto const result = lina::fastSinCos(radians);
+    maxError = std::max(maxError, std::fabs(result.sin - std::sin(radians)));
+    maxError = std::max(maxError, std::fabs(result.cos - std::cos(radians)));
+  }
+  EXPECT_LT(maxError, 1e-14);
+}
+
+TEST(fastSinCos, quadrantBoundariesAndLargeAngles)
+{
+  for (auto quadrant = -8; quadrant <= 8; ++quadrant) {
+    auto const radians = quadrant * std::numbers::pi / 4.0;
+    auto const result = lina::fastSinCos(radians);
+    EXPECT_NEAR(result.sin, std::sin(radians), 1e-14);
+    EXPECT_NEAR(result.cos, std::cos(radians), 1e-14);
+  }
+  for (auto const radians : { 12345.678, -98765.4321, 999999.0 }) {
+    auto const result = lina::fastSinCos(radians);
+    EXPECT_NEAR(result.sin, std::sin(radians), 1e-14);
+    EXPECT_NEAR(result.cos, std::cos(radians), 1e-14);
+  }
+}
+
+TEST(fastCbrt, relativeErrorIsBoundedOverTheWholeRange)
+{
+  auto maxError = 0.0;
+  for (auto exponent = -300.0; exponent <= 300.0; exponent += 0.001) {
+    auto const value = std::pow(10.0, exponent);
+    maxError = std::max(maxError, std::fabs(lina::fastCbrt(value) - std::cbrt(value)) / std::cbrt(value));
+  }
+  // the range of the sampling routines
+  for (auto i = 1; i <= 100000; ++i) {
+    auto const value = static_cast<double>(i) / 100000.0;
+    maxError = std::max(maxError, std::fabs(lina::fastCbrt(value) - std::cbrt(value)) / std::cbrt(value));
+  }
+  EXPECT_LT(maxError, 1e-13);
+}
+
+TEST(fastCbrt, specialValues)
+{
+  EXPECT_EQ(lina::fastCbrt(0.0), 0.0);
+  EXPECT_DOUBLE_EQ(lina::fastCbrt(1.0), 1.0);
+  EXPECT_DOUBLE_EQ(lina::fastCbrt(27.0), 3.0);
+  EXPECT_DOUBLE_EQ(lina::fastCbrt(-8.0), -2.0);
+  EXPECT_TRUE(std::isinf(lina::fastCbrt(INFINITY)));
+  auto const subnormal = 1e-310;
+  EXPECT_NEAR(lina::fastCbrt(subnormal) / std::cbrt(subnormal), 1.0, 1e-13);
+}
@@ -232,4 +232,11 @@ TEST(Dot, Random)
   EXPECT_DOUBLE_EQ(result, expected);
   result = lina::dot(rhs, lhs);
   EXPECT_DOUBLE_EQ(result, expected);
-}
\ No newline at end of file
+}
+TEST(inlineDot, sameAsDot)
+{
+  auto const lhs = std::array<double, 3>{ 3.565555, -2.123, 1.46899e-7 };
+  auto const rhs = std::array<double, 3>{ -2.12, 7.888675, 12.3e5 };
+  EXPECT_EQ(lina::inlineDot(lhs, rhs), lina::dot(lhs, rhs));
+  EXPECT_EQ(lina::inlineCross(lhs, rhs), lina::cross(lhs, rhs));
+}
@@ -2,12 +2,12 @@
 
 #include "lib/lina/vec3.h"
 #include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
 #include "lib/trace/util.h"
 
 #include <cmath>
 #include <cstddef>
 #include <format>
-#include <random>
 #include <stdexcept>
 
 namespace trace {
@@ -53,7 +53,8 @@ Camera::Camera(std::size_t imageWidth,
 
 // Generate a sample ray at the given location
 // If out of range, returns an error.
-auto Camera::GetSampleRayAt(std::size_t i, std::size_t j, std::mt19937& randomGenerator, bool multiSampled) const -> Ray
+auto Camera::GetSampleRayAt(std::size_t i, std::size_t j, Sampler& sampler, bool multiSampled) const
+  -> Ray
 {
   if (i >= imageHeight_ || j >= imageWidth_) {
     throw std::logic_error(std::format(
@@ -62,11 +63,11 @@ auto Camera::GetSampleRayAt(std::size_t i, std::size_t j, std::mt19937& randomGe
 
   auto pixelCenter =
     firstPixelPosition_ + (static_cast<double>(j) * pixelDeltaU_) + (static_cast<double>(i) * pixelDeltaV_);
-  auto pixelSample = pixelCenter + sampleInUnitSquare(randomGenerator, pixelDeltaU_, pixelDeltaV_);
+  auto pixelSample = pixelCenter + sampleInUnitSquare(sampler, pixelDeltaU_, pixelDeltaV_);
   // in case we want only a single sample it should go through the center of the pixel
   if (!multiSampled) { pixelSample = pixelCenter; }
 
-  auto raySource = sampleInUnitDisk(randomGenerator, cameraCenter_, lenseU_, lenseV_);
+  auto raySource = sampleInUnitDisk(sampler, cameraCenter_, lenseU_, lenseV_);
   auto rayDirection = lina::unit(pixelSample - raySource);
   return Ray{ pixelSample, rayDirection };
 }
@@ -75,20 +76,21 @@ auto Camera::ImageWidth() const -> std::size_t { return imageWidth_; }
 
 auto Camera::ImageHeight() const -> std::size_t { return imageHeight_; }
 
-auto sampleInUnitSquare(std::mt19937& randomGenerator, lina::Vec3 const& unitDeltaU, lina::Vec3 const& unitDeltaV)
+auto sampleInUnitSquare(Sampler& sampler, lina::Vec3 const& unitDeltaU, lina::Vec3 const& unitDeltaV)
   -> lina::Vec3
 {
-  auto uOffset = randomUniformDouble(randomGenerator, -0.5, 0.5);
-  auto vOffset = randomUniformDouble(randomGenerator, -0.5, 0.5);
+  auto const [u, v] = sampler.Uniform2D();
+  auto uOffset = u - 0.5;
+  auto vOffset = v - 0.5;
   return (uOffset * unitDeltaU) + (vOffset * unitDeltaV);
 }
 
-auto sampleInUnitDisk(std::mt19937& randomGenerator,
+auto sampleInUnitDisk(Sampler& sampler,
   lina::Vec3 const& center,
   lina::Vec3 const& lenseU,
   lina::Vec3 const& lenseV) -> lina::Vec3
 {
-  auto onUnitDisk = randomOnUnitDisk(randomGenerator);
+  auto onUnitDisk = randomOnUnitDisk(sampler);
   return center + (lenseU * onUnitDisk.Components()[0]) + (lenseV * onUnitDisk.Components()[1]);
 }
 
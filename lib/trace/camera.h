@@ -3,9 +3,9 @@
 
 #include "lib/lina/vec3.h"
 #include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
 
 #include <cstddef>
-#include <random>
 
 namespace trace {
 
@@ -24,7 +24,7 @@ public:
 
   // Generate a matrix of rays, with multisamplingCount number of rays per pixel
   [[nodiscard]] auto
-    GetSampleRayAt(std::size_t i, std::size_t j, std::mt19937& randomGenerator, bool multiSampled = false) const
+    GetSampleRayAt(std::size_t i, std::size_t j, Sampler& sampler, bool multiSampled = false) const
     -> trace::Ray;
 
   [[nodiscard]] auto ImageWidth() const -> std::size_t;
@@ -46,10 +46,10 @@ private:
   lina::Vec3 lenseV_;
 };
 
-auto sampleInUnitSquare(std::mt19937& randomGenerator, lina::Vec3 const& unitDeltaU, lina::Vec3 const& unitDeltaV)
+auto sampleInUnitSquare(Sampler& sampler, lina::Vec3 const& unitDeltaU, lina::Vec3 const& unitDeltaV)
   -> lina::Vec3;
 
-auto sampleInUnitDisk(std::mt19937& randomGenerator,
+auto sampleInUnitDisk(Sampler& sampler,
   lina::Vec3 const& center,
   lina::Vec3 const& lenseU,
   lina::Vec3 const& lenseV) -> lina::Vec3;
@@ -3,10 +3,14 @@
 #include "lib/lina/vec3.h"
 #include "lib/trace/geometry/mesh.h"
 #include "lib/trace/geometry/triangle_data.h"
+#include "lib/trace/ray.h"
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <limits>
+#include <optional>
+#include <utility>
 
 namespace trace {
 
@@ -43,6 +47,37 @@ auto collide(Aabb const& lhs, Aabb const& rhs) -> bool
   // NOLINTEND(readability-simplify-boolean-expr)
 }
 
+// Source: https://tavianator.com/2011/ray_box.html
+// Each pair of parallel box sides form a slab. The ray is inside the box where it is inside all three slabs at once,
+// so the entry distance is the largest of the slab entries and the exit distance is the smallest of the slab exits.
+auto slabCollide(Aabb const& box, Ray const& ray) -> std::optional<SlabCollision>
+{
+  auto const& source = ray.Source();
+  auto const& direction = ray.Direction();
+  auto const& inverseDirection = ray.InverseDirection();
+  auto const mins = std::array<double, 3>{ box.minX, box.minY, box.minZ };
+  auto const maxs = std::array<double, 3>{ box.maxX, box.maxY, box.maxZ };
+
+  auto entry = std::numeric_limits<double>::lowest();
+  auto exit = std::numeric_limits<double>::max();
+  for (auto axis = std::size_t{ 0 }; axis < 3; ++axis) {
+    // A ray parallel with the slab never crosses it, it is either always inside or never.
+    // Handled separately as 0.0 * infinity would yield NaN.
+    if (direction[axis] == 0.0) {
+      if (source[axis] < mins.at(axis) || source[axis] > maxs.at(axis)) { return std::optional<SlabCollision>{}; }
+      continue;
+    }
+    auto tNear = (mins.at(axis) - source[axis]) * inverseDirection[axis];
+    auto tFar = (maxs.at(axis) - source[axis]) * inverseDirection[axis];
+    if (tNear > tFar) { std::swap(tNear, tFar); }
+    entry = std::max(entry, tNear);
+    exit = std::min(exit, tFar);
+  }
+
+  if (entry > exit || exit < 0.0) { return std::optional<SlabCollision>{}; }
+  return SlabCollision{ entry, exit };
+}
+
 auto meshAabb(trace::Mesh const& mesh) -> Aabb
 {
   auto limits = Aabb{};
@@ -59,6 +94,18 @@ auto meshAabb(trace::Mesh const& mesh) -> Aabb
   return limits;
 }
 
+auto worldAabb(trace::Mesh const& mesh) -> Aabb
+{
+  auto limits = meshAabb(mesh);
+  limits.minX += mesh.center[0];
+  limits.maxX += mesh.center[0];
+  limits.minY += mesh.center[1];
+  limits.maxY += mesh.center[1];
+  limits.minZ += mesh.center[2];
+  limits.maxZ += mesh.center[2];
+  return limits;
+}
+
 auto triangleAabb(TriangleData const& triangleData) -> Aabb
 {
   auto limits = Aabb{ std::numeric_limits<double>::max(),
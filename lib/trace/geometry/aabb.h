@@ -3,8 +3,10 @@
 
 #include "lib/trace/geometry/mesh.h"
 #include "lib/trace/geometry/triangle_data.h"
+#include "lib/trace/ray.h"
 
 #include <limits>
+#include <optional>
 
 namespace trace {
 
@@ -22,12 +24,28 @@ struct Aabb
   [[nodiscard]] auto volume() const -> double;
 };
 
+// The distances along a ray, where it enters and exits an Aabb.
+// A negative entry distance means that the ray has started inside the box.
+struct SlabCollision
+{
+  double entry = 0.0;
+  double exit = 0.0;
+};
+
 auto mergeAABB(Aabb const& lhs, Aabb const& rhs) -> Aabb;
 
 auto collide(Aabb const& lhs, Aabb const& rhs) -> bool;
 
+// Slab test using the precomputed inverse direction of the ray. Boxes that are completely behind the ray's source
+// are reported as missed.
+auto slabCollide(Aabb const& box, Ray const& ray) -> std::optional<SlabCollision>;
+
+// The limits of the vertices relative to the mesh center.
 auto meshAabb(trace::Mesh const& mesh) -> Aabb;
 
+// The limits of the mesh in world coordinates, i.e. offset by the mesh center.
+auto worldAabb(trace::Mesh const& mesh) -> Aabb;
+
 auto triangleAabb(TriangleData const& triangleData) -> Aabb;
 
 }// namespace trace
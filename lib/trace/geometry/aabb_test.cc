@@ -0,0 +1,56 @@
+#include "lib/lina/vec3.h"
+#include "lib/trace/geometry/aabb.h"
+#include "lib/trace/ray.h"
+
+#include <gtest/gtest.h>
+
+TEST(slabCollide, rayFromOutsideHitsBox)
+{
+  auto box = trace::Aabb{ -1.0, 1.0, -1.0, 1.0, -1.0, 1.0 };
+  auto collision = trace::slabCollide(box, trace::Ray{ lina::Vec3{ -5.0, 0.0, 0.0 }, lina::Vec3{ 1.0, 0.0, 0.0 } });
+  ASSERT_TRUE(collision);
+  EXPECT_DOUBLE_EQ(collision->entry, 4.0);
+  EXPECT_DOUBLE_EQ(collision->exit, 6.0);
+}
+
+TEST(slabCollide, rayFromInsideHasNegativeEntry)
+{
+  auto box = trace::Aabb{ -1.0, 1.0, -1.0, 1.0, -1.0, 1.0 };
+  auto collision = trace::slabCollide(box, trace::Ray{ lina::Vec3{ 0.0, 0.0, 0.0 }, lina::Vec3{ 0.0, 0.0, -1.0 } });
+  ASSERT_TRUE(collision);
+  EXPECT_DOUBLE_EQ(collision->entry, -1.0);
+  EXPECT_DOUBLE_EQ(collision->exit, 1.0);
+}
+
+TEST(slabCollide, rayPointingAwayMisses)
+{
+  auto box = trace::Aabb{ -1.0, 1.0, -1.0, 1.0, -1.0, 1.0 };
+  EXPECT_FALSE(trace::slabCollide(box, trace::Ray{ lina::Vec3{ -5.0, 0.0, 0.0 }, lina::Vec3{ -1.0, 0.0, 0.0 } }));
+}
+
+TEST(slabCollide, rayPassingBesideMisses)
+{
+  auto box = trace::Aabb{ -1.0, 1.0, -1.0, 1.0, -1.0, 1.0 };
+  EXPECT_FALSE(trace::slabCollide(box, trace::Ray{ lina::Vec3{ -5.0, 1.5, 0.0 }, lina::Vec3{ 1.0, 0.0, 0.0 } }));
+  EXPECT_FALSE(trace::slabCollide(box, trace::Ray{ lina::Vec3{ -5.0, 0.0, 0.0 }, lina::Vec3{ 1.0, 1.0, 0.0 } }));
+}
+
+TEST(slabCollide, diagonalRayEntersThroughCorner)
+{
+  auto box = trace::Aabb{ 0.0, 1.0, 0.0, 1.0, 0.0, 1.0 };
+  auto collision = trace::slabCollide(box, trace::Ray{ lina::Vec3{ -1.0, -1.0, -1.0 }, lina::Vec3{ 1.0, 1.0, 1.0 } });
+  ASSERT_TRUE(collision);
+  auto const diagonal = lina::Vec3{ 1.0, 1.0, 1.0 }.Length();
+  EXPECT_NEAR(collision->entry, diagonal, 1e-12);
+  EXPECT_NEAR(collision->exit, 2.0 * diagonal, 1e-12);
+}
+
+TEST(slabCollide, flatBoxCanStillBeHit)
+{
+  // a box with no thickness along the Z axis, like the one of a plane
+  auto box = trace::Aabb{ -1.0, 1.0, -1.0, 1.0, 0.0, 0.0 };
+  auto collision = trace::slabCollide(box, trace::Ray{ lina::Vec3{ 0.5, 0.5, 2.0 }, lina::Vec3{ 0.0, 0.0, -1.0 } });
+  ASSERT_TRUE(collision);
+  EXPECT_DOUBLE_EQ(collision->entry, 2.0);
+  EXPECT_DOUBLE_EQ(collision->exit, 2.0);
+}
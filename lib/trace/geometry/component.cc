@@ -3,31 +3,47 @@
 #include "lib/lina/lina.h"
 #include "lib/lina/vec3.h"
 #include "lib/trace/collision.h"
+#include "lib/trace/geometry/aabb.h"
 #include "lib/trace/geometry/mesh.h"
 #include "lib/trace/geometry/triangle_data.h"
+#include "lib/trace/geometry/triangle_hierarchy.h"
 #include "lib/trace/pdf.h"
 #include "lib/trace/ray.h"
 #include "lib/trace/transform.h"
 
 #include <array>
 #include <cstddef>
+#include <limits>
 #include <optional>
-#include <random>
 #include <span>
 #include <utility>
 #include <vector>
 
 namespace trace {
 
-Component::Component(Mesh mesh) : mesh_{ std::move(mesh) } {}
+Component::Component(Mesh mesh) : mesh_{ std::move(mesh) }
+{
+  triangleHierarchy_ = buildTriangleHierarchy(mesh_.triangleData);
+  updateCumulativeTriangleAreas();
+}
 
 auto Component::Collide(Ray const& ray) const -> std::optional<Collision>
 {
-  auto closestCollisionData = meshCollide(ray, mesh_.triangles, mesh_.triangleData);
+  auto closestCollisionData = hierarchyCollide(ray, triangleHierarchy_, mesh_.triangleData);
   if (!closestCollisionData) { return std::optional<Collision>{}; }
   return std::optional<Collision>{ closestCollisionData->collision };
 }
 
+// Every ray goes through the Collide of the actual class, for the classes without a CollideDistances of their own.
+auto Component::CollideDistances(std::span<Ray const> rays, std::span<double> distances) const -> void
+{
+  for (auto i = std::size_t{ 0 }; i < rays.size(); ++i) {
+    auto const collision = Collide(rays[i]);
+    distances[i] =
+      collision ? (collision->point - rays[i].Source()).Length() : std::numeric_limits<double>::infinity();
+  }
+}
+
 // Apply the linear transformation matrix to the object.
 auto Component::Transform(std::span<double const, 16> transformationMatrix) -> void
 {
@@ -42,11 +58,33 @@ auto Component::Transform(std::span<double const, 16> transformationMatrix) -> v
   updateTriangleData();
 }
 
-auto Component::SamplingPDF(std::mt19937& /*randomGenerator*/, lina::Vec3 const& /*from*/) const -> PDF
+auto Component::SamplingPDF(lina::Vec3 const& from) const -> PDF
+{
+  if (cumulativeTriangleAreas_.empty()) { return PDF{}; }
+  return PDF{ TriangleMeshPDF{ from, &mesh_.triangleData, &triangleHierarchy_, &cumulativeTriangleAreas_ } };
+}
+
+auto Component::Shape() const -> std::optional<SamplingShape>
+{
+  if (cumulativeTriangleAreas_.empty()) { return std::optional<SamplingShape>{}; }
+  return std::optional<SamplingShape>{
+    TriangleMeshShape{ &mesh_.triangleData, &triangleHierarchy_, &cumulativeTriangleAreas_ }
+  };
+}
+
+auto Component::HasSamplingPDF() const -> bool { return Shape().has_value(); }
+
+auto Component::SurfaceArea() const -> double
 {
-  return PDF{};
+  return cumulativeTriangleAreas_.empty() ? 0.0 : cumulativeTriangleAreas_.back();
 }
 
+auto Component::FrontNormal() const -> std::optional<lina::Vec3> { return std::optional<lina::Vec3>{}; }
+
+auto Component::IsAnalytic() const -> bool { return false; }
+
+auto Component::GetBoundingBox() const -> Aabb { return worldAabb(mesh_); }
+
 auto Component::GetMesh() const -> Mesh const& { return mesh_; }
 
 auto Component::updateTriangleData() -> void
@@ -60,6 +98,20 @@ auto Component::updateTriangleData() -> void
 
     mesh_.triangleData[triangleId] = TriangleData{ localizedTriangle };
   }
+  triangleHierarchy_ = buildTriangleHierarchy(mesh_.triangleData);
+  updateCumulativeTriangleAreas();
+}
+
+auto Component::updateCumulativeTriangleAreas() -> void
+{
+  cumulativeTriangleAreas_.clear();
+  auto area = 0.0;
+  // the length of the cross product of the edges is twice the area of the triangle
+  for (auto const& triangleData : mesh_.triangleData) {
+    area += triangleData.n.Length() / 2.0;
+    cumulativeTriangleAreas_.emplace_back(area);
+  }
+  if (!(area > 0.0)) { cumulativeTriangleAreas_.clear(); }
 }
 
-}// namespace trace
\ No newline at end of file
+}// namespace trace
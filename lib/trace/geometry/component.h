@@ -3,13 +3,15 @@
 
 #include "lib/lina/vec3.h"
 #include "lib/trace/collision.h"
+#include "lib/trace/geometry/aabb.h"
 #include "lib/trace/geometry/mesh.h"
+#include "lib/trace/geometry/triangle_hierarchy.h"
 #include "lib/trace/pdf.h"
 #include "lib/trace/ray.h"
 
 #include <optional>
-#include <random>
 #include <span>
+#include <vector>
 
 namespace trace {
 
@@ -25,13 +27,32 @@ public:
   virtual ~Component() = default;
 
   [[nodiscard]] virtual auto Collide(Ray const& ray) const -> std::optional<Collision>;
+  // The distances from the sources of the rays to their collisions, the same as Collide would find, infinity for the
+  // rays missing the component. For checking many rays against the same component at once.
+  virtual auto CollideDistances(std::span<Ray const> rays, std::span<double> distances) const -> void;
   // Apply the linear transformation matrix to the object.
   virtual auto Transform(std::span<double const, 16> transformationMatrix) -> void;
 
-  // For a sampling PDF, AdjustedCollisionPoint function will not be implemented, because it makes no sense.
-  // So just watch out, never to call it, until this PDF implementation could be replaced with something more
-  // general.
-  [[nodiscard]] virtual auto SamplingPDF(std::mt19937& randomGenerator, lina::Vec3 const& from) const -> PDF;
+  // The density of the directions from the point towards the surface, empty unless HasSamplingPDF.
+  // The PDF may refer to the component, so it must not outlive it.
+  // By default the triangles of the mesh are sampled by their area.
+  [[nodiscard]] virtual auto SamplingPDF(lina::Vec3 const& from) const -> PDF;
+  // The shape the SamplingPDF samples, for building the same density without the component, see samplingPDF.
+  // By default the triangles of the mesh, nothing if they have no area. A triangle mesh shape refers to the
+  // component, so it must not outlive it.
+  [[nodiscard]] virtual auto Shape() const -> std::optional<SamplingShape>;
+  // Whether the SamplingPDF can be sampled, so the component can be sampled as a light.
+  [[nodiscard]] auto HasSamplingPDF() const -> bool;
+  // The area of the surface in world coordinates.
+  [[nodiscard]] virtual auto SurfaceArea() const -> double;
+  // The normal of the front faces, for flat components, where it is the same everywhere.
+  [[nodiscard]] virtual auto FrontNormal() const -> std::optional<lina::Vec3>;
+
+  // Analytic components are not described by the triangles of their mesh (it is left empty, except for the center),
+  // but by an equation. There is nothing to index them by in the voxel space, they get a hierarchy of their boxes.
+  [[nodiscard]] virtual auto IsAnalytic() const -> bool;
+  // Axis aligned bounding box in world coordinates.
+  [[nodiscard]] virtual auto GetBoundingBox() const -> Aabb;
 
   [[nodiscard]] auto GetMesh() const -> Mesh const&;
 
@@ -39,6 +60,13 @@ protected:
   virtual auto updateTriangleData() -> void;
 
   Mesh mesh_;
+  // The triangles of the mesh in a hierarchy, for the collisions with them, updated with the triangle data.
+  TriangleHierarchy triangleHierarchy_;
+  // The area of the triangles up to and including the one at the same index, empty if they have none at all.
+  std::vector<double> cumulativeTriangleAreas_;
+
+private:
+  auto updateCumulativeTriangleAreas() -> void;
 };
 
 }// namespace trace
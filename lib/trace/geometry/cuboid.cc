@@ -2,16 +2,22 @@
 
 #include "lib/lina/lina.h"
 #include "lib/lina/vec3.h"
+#include "lib/trace/collision.h"
 #include "lib/trace/geometry/component.h"
 #include "lib/trace/geometry/mesh.h"
 #include "lib/trace/geometry/triangle_data.h"
 #include "lib/trace/geometry/vertex_data.h"
+#include "lib/trace/ray.h"
 #include "lib/trace/transform.h"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstddef>
 #include <format>
+#include <limits>
+#include <optional>
+#include <span>
 #include <stdexcept>
 #include <vector>
 
@@ -47,6 +53,112 @@ Cuboid::Cuboid()
   mesh_.triangles.at(9) = std::array<std::size_t, 3>{ 1, 7, 5 };
   mesh_.triangles.at(10) = std::array<std::size_t, 3>{ 4, 5, 6 };
   mesh_.triangles.at(11) = std::array<std::size_t, 3>{ 6, 5, 7 };
+
+  Component::updateTriangleData();
+  updateInverseAxes();
+}
+
+// The ray is moved into the coordinate system of the cuboid, where it is the [-1, 1] cube, then it is the usual
+// slab test. The mapping is affine, so the distances along the ray stay the same.
+auto Cuboid::Collide(Ray const& ray) const -> std::optional<Collision>
+{
+  auto const delta = ray.Source() - mesh_.center;
+  auto entry = -std::numeric_limits<double>::infinity();
+  auto exit = std::numeric_limits<double>::infinity();
+  auto entryAxis = std::size_t{ 0 };
+  auto exitAxis = std::size_t{ 0 };
+  auto entrySide = 1.0;
+  auto exitSide = 1.0;
+  for (auto axis = std::size_t{ 0 }; axis < 3; ++axis) {
+    auto const source = lina::dot(inverseAxes_[axis], delta);
+    auto const direction = lina::dot(inverseAxes_[axis], ray.Direction());
+    if (direction == 0.0) {
+      if (source < -1.0 || 1.0 < source) { return std::optional<Collision>{}; }
+      continue;
+    }
+    // the ray travelling towards the positive side enters on the negative one
+    auto const side = direction > 0.0 ? -1.0 : 1.0;
+    auto const near = (side - source) / direction;
+    auto const far = (-side - source) / direction;
+    if (near > entry) {
+      entry = near;
+      entryAxis = axis;
+      entrySide = side;
+    }
+    if (far < exit) {
+      exit = far;
+      exitAxis = axis;
+      exitSide = -side;
+    }
+  }
+  if (entry > exit || exit <= 0.0) { return std::optional<Collision>{}; }
+
+  // starting inside the cuboid we hit it on the way out
+  auto const inside = entry <= 0.0;
+  auto const t = inside ? exit : entry;
+  auto const axis = inside ? exitAxis : entryAxis;
+  auto const side = inside ? exitSide : entrySide;
+
+  auto collision = Collision{};
+  collision.point = ray.Source() + ray.Direction() * t;
+  collision.normal = lina::unit(inverseAxes_[axis] * side);
+  collision.frontFace = !inside;
+  return std::optional<Collision>{ collision };
+}
+
+// Collide without the vector operations of lina, each of which would be a call.
+auto Cuboid::CollideDistances(std::span<Ray const> rays, std::span<double> distances) const -> void
+{
+  auto const& center = mesh_.center.Components();
+  for (auto i = std::size_t{ 0 }; i < rays.size(); ++i) {
+    distances[i] = std::numeric_limits<double>::infinity();
+    auto const& source = rays[i].Source().Components();
+    auto const& direction = rays[i].Direction().Components();
+    auto delta = std::array<double, 3>{};
+    for (auto axis = std::size_t{ 0 }; axis < 3; ++axis) { delta[axis] = source[axis] - center[axis]; }
+    auto entry = -std::numeric_limits<double>::infinity();
+    auto exit = std::numeric_limits<double>::infinity();
+    auto missed = false;
+    for (auto axis = std::size_t{ 0 }; axis < 3; ++axis) {
+      auto const& inverseAxis = inverseAxes_[axis].Components();
+      auto const axisSource = lina::inlineDot(inverseAxis, delta);
+      auto const axisDirection = lina::inlineDot(inverseAxis, direction);
+      if (axisDirection == 0.0) {
+        missed = missed || axisSource < -1.0 || 1.0 < axisSource;
+        continue;
+      }
+      auto const side = axisDirection > 0.0 ? -1.0 : 1.0;
+      entry = std::max(entry, (side - axisSource) / axisDirection);
+      exit = std::min(exit, (-side - axisSource) / axisDirection);
+    }
+    if (missed || entry > exit || exit <= 0.0) { continue; }
+    auto const t = entry <= 0.0 ? exit : entry;
+    auto offset = std::array<double, 3>{};
+    for (auto axis = std::size_t{ 0 }; axis < 3; ++axis) {
+      offset[axis] = (source[axis] + direction[axis] * t) - source[axis];
+    }
+    distances[i] = std::sqrt(lina::inlineDot(offset, offset));
+  }
+}
+
+auto Cuboid::IsAnalytic() const -> bool { return true; }
+
+auto Cuboid::updateTriangleData() -> void
+{
+  Component::updateTriangleData();
+  updateInverseAxes();
+}
+
+auto Cuboid::updateInverseAxes() -> void
+{
+  auto const halfX = (mesh_.vertices[2] - mesh_.vertices[0]) / 2.0;
+  auto const halfY = (mesh_.vertices[1] - mesh_.vertices[0]) / 2.0;
+  auto const halfZ = (mesh_.vertices[4] - mesh_.vertices[0]) / 2.0;
+  // the inverse of a 3x3 matrix, by the cross products of its columns
+  auto const determinant = lina::dot(halfX, lina::cross(halfY, halfZ));
+  inverseAxes_[0] = lina::cross(halfY, halfZ) / determinant;
+  inverseAxes_[1] = lina::cross(halfZ, halfX) / determinant;
+  inverseAxes_[2] = lina::cross(halfX, halfY) / determinant;
 }
 
 auto buildCuboid(lina::Vec3 center, double width, double depth, double height) -> Cuboid
@@ -2,10 +2,18 @@
 #define RAY_BUSTER_LIB_TRACE_GEOMETRY_CUBOID_H_
 
 #include "lib/lina/vec3.h"
+#include "lib/trace/collision.h"
 #include "lib/trace/geometry/component.h"
+#include "lib/trace/ray.h"
+
+#include <array>
+#include <optional>
+#include <span>
 
 namespace trace {
 
+// The mesh is kept, but collisions are calculated against the box as a whole, with a slab test in its own
+// coordinate system. So it stays a single test even if the cuboid has been rotated or sheared.
 class Cuboid : public Component
 {
 public:
@@ -16,7 +24,23 @@ public:
   auto operator=(Cuboid&&) -> Cuboid& = default;
   ~Cuboid() override = default;
 
+  [[nodiscard]] auto Collide(Ray const& ray) const -> std::optional<Collision> override;
+  auto CollideDistances(std::span<Ray const> rays, std::span<double> distances) const -> void override;
+  [[nodiscard]] auto IsAnalytic() const -> bool override;
+
   friend auto buildCuboid(lina::Vec3 center, double width, double depth, double height) -> Cuboid;
+
+protected:
+  auto updateTriangleData() -> void override;
+
+private:
+  // Not virtual, so the constructor can call it.
+  auto updateInverseAxes() -> void;
+
+  // The rows of the inverse of the matrix made up of the half edge vectors, the ones pointing from the center
+  // to the middle of the sides. It maps the cuboid onto the [-1, 1] cube, while each row is also the (not unit)
+  // normal vector of the corresponding side pair.
+  std::array<lina::Vec3, 3> inverseAxes_;
 };
 
 // Build a cuboid at origin, then scale and move it to the target position. By default the constructed cuboid will be 2
@@ -2,8 +2,13 @@
 #include "lib/trace/geometry/aabb.h"
 #include "lib/trace/geometry/cuboid.h"
 #include "lib/trace/geometry/mesh.h"
+#include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
+#include "lib/trace/transform.h"
+#include "lib/trace/util.h"
 
 #include <gtest/gtest.h>
+#include <numbers>
 
 TEST(buildCuboid, defaultBuildsCuboidWithTwoUnitLongDimensions)
 {
@@ -49,3 +54,78 @@ TEST(buildCuboid, unitWideCubeWithShiftedCenter)
   ASSERT_EQ(limits.minZ, -0.5);
   ASSERT_EQ(limits.maxZ, 0.5);
 }
+
+TEST(cuboidCollide, hitFromOutsideAndInside)
+{
+  auto cuboid = trace::buildCuboid(lina::Vec3(1.0, 2.0, 3.0), 2.0, 4.0, 6.0);
+
+  auto outside = cuboid.Collide(trace::Ray{ lina::Vec3{ 1.0, 10.0, 3.0 }, lina::Vec3{ 0.0, -1.0, 0.0 } });
+  ASSERT_TRUE(outside);
+  EXPECT_DOUBLE_EQ(outside->point[1], 4.0);
+  EXPECT_DOUBLE_EQ(outside->normal[1], 1.0);
+  EXPECT_TRUE(outside->frontFace);
+
+  auto inside = cuboid.Collide(trace::Ray{ lina::Vec3{ 1.0, 2.0, 3.0 }, lina::Vec3{ 0.0, 0.0, -1.0 } });
+  ASSERT_TRUE(inside);
+  EXPECT_DOUBLE_EQ(inside->point[2], 0.0);
+  EXPECT_DOUBLE_EQ(inside->normal[2], -1.0);
+  EXPECT_FALSE(inside->frontFace);
+
+  EXPECT_FALSE(cuboid.Collide(trace::Ray{ lina::Vec3{ 1.0, 10.0, 3.0 }, lina::Vec3{ 0.0, 1.0, 0.0 } }));
+  EXPECT_FALSE(cuboid.Collide(trace::Ray{ lina::Vec3{ 2.5, 10.0, 3.0 }, lina::Vec3{ 0.0, -1.0, 0.0 } }));
+}
+
+TEST(cuboidCollide, matchesTheCollisionWithItsMesh)
+{
+  auto cuboid = trace::buildCuboid(lina::Vec3(1.0, -2.0, 0.5), 1.0, 3.0, 2.0);
+  cuboid.Transform(trace::rotateAlongZ(trace::degreesToRadians(30.0)));
+  cuboid.Transform(trace::rotateAlongX(trace::degreesToRadians(-50.0)));
+
+  auto sampler = trace::IndependentSampler{ 42 };
+  auto hits = 0;
+  for (auto i = 0; i < 1000; ++i) {
+    auto const source = trace::randomOnUnitSphere(sampler) * 5.0;
+    auto const target = trace::randomOnUnitSphere(sampler) * 1.5;
+    auto const ray = trace::Ray{ source, target - source };
+
+    auto const collision = cuboid.Collide(ray);
+    auto const meshCollision =
+      trace::meshCollide(ray, cuboid.GetMesh().triangles, cuboid.GetMesh().triangleData);
+    ASSERT_EQ(collision.has_value(), meshCollision.has_value());
+    if (!collision) { continue; }
+    ++hits;
+    EXPECT_NEAR((collision->point - meshCollision->collision.point).Length(), 0.0, 1e-9);
+    EXPECT_NEAR((collision->normal - meshCollision->collision.normal).Length(), 0.0, 1e-9);
+    EXPECT_EQ(collision->frontFace, meshCollision->collision.frontFace);
+  }
+  EXPECT_GT(hits, 100);
+}
+
+TEST(cuboidSurfaceArea, sumsTheAreaOfTheFaces)
+{
+  auto const cuboid = trace::buildCuboid(lina::Vec3{ 1.0, 2.0, 3.0 }, 2.0, 3.0, 4.0);
+  EXPECT_NEAR(cuboid.SurfaceArea(), 2.0 * ((2.0 * 3.0) + (2.0 * 4.0) + (3.0 * 4.0)), 1e-9);
+}
+
+TEST(cuboidSamplingPDF, samplesLandOnTheSurfaceAndTheDensityIntegratesToOne)
+{
+  auto const cuboid = trace::buildCuboid(lina::Vec3{ 1.5, 5.0, 0.5 }, 2.0, 3.0, 4.0);
+  ASSERT_TRUE(cuboid.HasSamplingPDF());
+  auto sampler = trace::IndependentSampler{ 42 };
+  auto const from = lina::Vec3{ 0.0, 0.0, 0.0 };
+  auto const pdf = cuboid.SamplingPDF(from);
+  for (auto i = 0; i < 100; ++i) {
+    auto const direction = pdf.GenerateSample(sampler);
+    EXPECT_TRUE(cuboid.Collide(trace::Ray{ from, direction }));
+    EXPECT_GT(pdf.Evaluate(direction), 0.0);
+  }
+  EXPECT_EQ(pdf.Evaluate(lina::Vec3{ 0.0, -1.0, 0.0 }), 0.0);
+
+  // a Monte Carlo estimate of the integral over all directions, with uniformly distributed ones
+  auto constexpr samples = 200000;
+  auto integral = 0.0;
+  for (auto i = 0; i < samples; ++i) {
+    integral += pdf.Evaluate(trace::randomOnUnitSphere(sampler)) * 4.0 * std::numbers::pi / samples;
+  }
+  EXPECT_NEAR(integral, 1.0, 0.02);
+}
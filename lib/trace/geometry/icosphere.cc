@@ -3,8 +3,8 @@
 #include "lib/lina/lina.h"
 #include "lib/lina/vec3.h"
 #include "lib/trace/collision.h"
+#include "lib/trace/geometry/aabb.h"
 #include "lib/trace/geometry/component.h"
-#include "lib/trace/geometry/cuboid.h"
 #include "lib/trace/geometry/mesh.h"
 #include "lib/trace/geometry/triangle_data.h"
 #include "lib/trace/geometry/vertex_data.h"
@@ -34,14 +34,7 @@ Icosphere::Icosphere()
     std::vector<lina::Vec3>(12),
     std::vector<VertexData>(12),
     std::vector<std::array<std::size_t, 3>>(20),
-    std::vector<TriangleData>(20) } },
-    boundingBox_{
-      buildCuboid(lina::Vec3{ 0.0, 0.0, 0.0 },
-        2.0,
-        2.0,
-        2.0)// the default bounding cuboid should retain it's unit side length property after construction to properly
-            // scale with the icosphere
-    }
+    std::vector<TriangleData>(20) } }
 {
   // the exact value of phi or a doesn't matter at all
   // only that the follow the golden ratio property
@@ -192,17 +185,18 @@ auto Icosphere::updateTriangleData() -> void
 
 auto Icosphere::Collide(Ray const& ray) const -> std::optional<Collision>
 {
-  if (!boundingBox_.Collide(ray)) { return std::optional<Collision>{}; }
+  if (!slabCollide(boundingBox_, ray)) { return std::optional<Collision>{}; }
   return Component::Collide(ray);
 }
 // Apply the linear transformation matrix to the object.
 auto Icosphere::Transform(std::span<double const, 16> transformationMatrix) -> void
 {
   Component::Transform(transformationMatrix);
-  boundingBox_.Transform(transformationMatrix);
+  // Refitting the box to the transformed vertices keeps it tight, even after rotations.
+  boundingBox_ = worldAabb(mesh_);
 }
 
-auto Icosphere::GetBoundingBox() const -> Cuboid const& { return boundingBox_; }
+auto Icosphere::GetBoundingBox() const -> Aabb { return boundingBox_; }
 
 auto buildIcosphere(lina::Vec3 center, double diameter, std::size_t subdivisionLevel) -> Icosphere
 {
@@ -228,7 +222,7 @@ auto buildIcosphere(lina::Vec3 center, double diameter, std::size_t subdivisionL
   // update the size of the trianglesData_ storage
   sphere.mesh_.vertexData = std::vector<VertexData>(sphere.mesh_.vertices.size());
   sphere.mesh_.triangleData = std::vector<TriangleData>(sphere.mesh_.triangles.size());
-  sphere.Transform(transformMatrix);// this will scale the bounding box as well
+  sphere.Transform(transformMatrix);// this will fit the bounding box as well
 
   return sphere;
 }
@@ -3,8 +3,8 @@
 
 #include "lib/lina/vec3.h"
 #include "lib/trace/collision.h"
+#include "lib/trace/geometry/aabb.h"
 #include "lib/trace/geometry/component.h"
-#include "lib/trace/geometry/cuboid.h"
 #include "lib/trace/ray.h"
 
 #include <cstddef>
@@ -37,7 +37,7 @@ public:
   // Apply the linear transformation matrix to the object.
   auto Transform(std::span<double const, 16> transformationMatrix) -> void override;
 
-  [[nodiscard]] auto GetBoundingBox() const -> Cuboid const&;
+  [[nodiscard]] auto GetBoundingBox() const -> Aabb override;
 
   friend auto buildIcosphere(lina::Vec3 center, double diameter, std::size_t subdivisionLevel) -> Icosphere;
 
@@ -47,7 +47,7 @@ protected:
 private:
   Icosphere();
 
-  Cuboid boundingBox_;
+  Aabb boundingBox_;// in world coordinates, refreshed on every transformation
 };
 
 // Build an icosphere at origo, scale and move it to the target position.
@@ -1,6 +1,8 @@
 #include "lib/lina/vec3.h"
 #include "lib/trace/geometry/aabb.h"
 #include "lib/trace/geometry/icosphere.h"
+#include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
 
 #include <gtest/gtest.h>
 
@@ -22,11 +24,7 @@ TEST(buildIcosphere, DefaultIcosphereHasDimensionsOfTwo)
 TEST(buildIcosphere, DefaultIcosphereHasBoundingBoxWithDimensionsOfTwo)
 {
   auto icosphere = trace::buildIcosphere();
-  auto const& boundingBox = icosphere.GetBoundingBox();
-  ASSERT_DOUBLE_EQ(boundingBox.GetMesh().center[0], 0.0);
-  ASSERT_DOUBLE_EQ(boundingBox.GetMesh().center[1], 0.0);
-  ASSERT_DOUBLE_EQ(boundingBox.GetMesh().center[2], 0.0);
-  auto limits = trace::meshAabb(boundingBox.GetMesh());
+  auto const& limits = icosphere.GetBoundingBox();
   ASSERT_EQ(limits.minX, -1.0);
   ASSERT_EQ(limits.maxX, 1.0);
   ASSERT_EQ(limits.minY, -1.0);
@@ -68,17 +66,14 @@ TEST(buildIcosphere, ScaledIcosphereWithShiftedCenter)
 TEST(buildIcosphere, IcosphereWithShiftedCenterHasShiftedBoundingBox)
 {
   auto icosphere = trace::buildIcosphere(lina::Vec3(3.3, 2.0, 1.0), 1.0);
-  auto const& boundingBox = icosphere.GetBoundingBox();
-  ASSERT_DOUBLE_EQ(boundingBox.GetMesh().center[0], 3.3);
-  ASSERT_DOUBLE_EQ(boundingBox.GetMesh().center[1], 2.0);
-  ASSERT_DOUBLE_EQ(boundingBox.GetMesh().center[2], 1.0);
-  auto limits = trace::meshAabb(boundingBox.GetMesh());
-  ASSERT_EQ(limits.minX, -0.5);
-  ASSERT_EQ(limits.maxX, 0.5);
-  ASSERT_EQ(limits.minY, -0.5);
-  ASSERT_EQ(limits.maxY, 0.5);
-  ASSERT_EQ(limits.minZ, -0.5);
-  ASSERT_EQ(limits.maxZ, 0.5);
+  // the bounding box is in world coordinates
+  auto const& limits = icosphere.GetBoundingBox();
+  ASSERT_DOUBLE_EQ(limits.minX, 2.8);
+  ASSERT_DOUBLE_EQ(limits.maxX, 3.8);
+  ASSERT_DOUBLE_EQ(limits.minY, 1.5);
+  ASSERT_DOUBLE_EQ(limits.maxY, 2.5);
+  ASSERT_DOUBLE_EQ(limits.minZ, 0.5);
+  ASSERT_DOUBLE_EQ(limits.maxZ, 1.5);
 }
 
 TEST(buildIcosphere, IcosahedronHasTwelveVerticesAndTwentyTriangles)
@@ -129,3 +124,18 @@ TEST(buildIcosphere, IcosphereAfterThreeSubdivision)
   EXPECT_EQ(mesh.triangles.size(), 1280);
   EXPECT_EQ(mesh.triangleData.size(), 1280);
 }
+
+TEST(icosphereSamplingPDF, samplesPointTowardsTheIcosphereWithPositiveDensity)
+{
+  auto const icosphere = trace::buildIcosphere(lina::Vec3{ 0.0, 10.0, 0.0 }, 2.0, 2);
+  ASSERT_TRUE(icosphere.HasSamplingPDF());
+  auto sampler = trace::IndependentSampler{ 42 };
+  auto const from = lina::Vec3{ 0.0, 0.0, 0.0 };
+  auto const pdf = icosphere.SamplingPDF(from);
+  for (auto i = 0; i < 100; ++i) {
+    auto const direction = pdf.GenerateSample(sampler);
+    EXPECT_TRUE(icosphere.Collide(trace::Ray{ from, direction }));
+    EXPECT_GT(pdf.Evaluate(direction), 0.0);
+  }
+  EXPECT_EQ(pdf.Evaluate(lina::Vec3{ 0.0, -1.0, 0.0 }), 0.0);
+}
@@ -16,8 +16,8 @@
 #include <cmath>
 #include <cstddef>
 #include <format>
+#include <limits>
 #include <optional>
-#include <random>
 #include <span>
 #include <stdexcept>
 #include <vector>
@@ -40,35 +40,78 @@ Plane::Plane()
   mesh_.triangles.at(1) = std::array<std::size_t, 3>{ 2, 1, 3 };
 }
 
-auto Plane::SamplingPDF(std::mt19937& randomGenerator, lina::Vec3 const& from) const -> PDF
+// Same as the triangle collision, only the barycentric limit differs.
+auto Plane::Collide(Ray const& ray) const -> std::optional<Collision>
 {
-  auto samplingPDF = PDF{};
-  samplingPDF.Evaluate = [this, from](lina::Vec3 const& rayDirection) -> double {
-    auto collision = this->Collide(Ray{ from, rayDirection });
-    if (!collision) { return 0.0; }
-
-    auto delta = collision.value().point - from;
-    auto distanceSquared = lina::lengthSquared(delta.Components());
-    auto cosine = std::fabs(lina::dot(rayDirection, collision.value().normal));
-
-    // the length of the cross product is equal to the size of the parallelogram described by the vectors
-    // the order matters for a positive cross product
-    auto area =
-      lina::cross(this->mesh_.vertices[2] - this->mesh_.vertices[0], this->mesh_.vertices[1] - this->mesh_.vertices[0])
-        .Length();
-    return distanceSquared / (cosine * area);
-  };
-
-  samplingPDF.GenerateSample = [&randomGenerator, this, from]() -> lina::Vec3 {
-    auto Q = this->mesh_.vertices[0] + this->mesh_.center;
-    auto u = this->mesh_.vertices[2] - this->mesh_.vertices[0];
-    auto v = this->mesh_.vertices[1] - this->mesh_.vertices[0];
-
-    auto onPlane =
-      Q + (randomUniformDouble(randomGenerator, 0.0, 1.0) * u) + (randomUniformDouble(randomGenerator, 0.0, 1.0) * v);
-    return lina::unit(onPlane - from);
-  };
-  return samplingPDF;
+  auto const denominator = lina::dot(parallelogram_.normal, ray.Direction());
+  if (denominator == 0.0) { return std::optional<Collision>{}; }
+
+  auto const t = (parallelogram_.D - lina::dot(parallelogram_.normal, ray.Source())) / denominator;
+  if (t <= 0.0) { return std::optional<Collision>{}; }
+  auto const collisionPoint = ray.Source() + ray.Direction() * t;
+
+  auto const planeDelta = collisionPoint - parallelogram_.Q;
+  auto const alpha = lina::dot(parallelogram_.common, lina::cross(planeDelta, parallelogram_.v));
+  auto const beta = lina::dot(parallelogram_.common, lina::cross(parallelogram_.u, planeDelta));
+  if (0.0 > alpha || alpha > 1.0 || 0.0 > beta || beta > 1.0) { return std::optional<Collision>{}; }
+
+  auto collision = Collision{};
+  collision.point = collisionPoint;
+  collision.normal = parallelogram_.normal;
+  collision.frontFace = denominator < 0.0;
+  return std::optional<Collision>{ collision };
+}
+
+// Collide without the vector operations of lina, each of which would be a call.
+auto Plane::CollideDistances(std::span<Ray const> rays, std::span<double> distances) const -> void
+{
+  auto const& normal = parallelogram_.normal.Components();
+  auto const& corner = parallelogram_.Q.Components();
+  auto const& u = parallelogram_.u.Components();
+  auto const& v = parallelogram_.v.Components();
+  auto const& common = parallelogram_.common.Components();
+  for (auto i = std::size_t{ 0 }; i < rays.size(); ++i) {
+    distances[i] = std::numeric_limits<double>::infinity();
+    auto const& source = rays[i].Source().Components();
+    auto const& direction = rays[i].Direction().Components();
+    auto const denominator = lina::inlineDot(normal, direction);
+    if (denominator == 0.0) { continue; }
+    auto const t = (parallelogram_.D - lina::inlineDot(normal, source)) / denominator;
+    if (t <= 0.0) { continue; }
+    auto point = std::array<double, 3>{};
+    auto planeDelta = std::array<double, 3>{};
+    for (auto axis = std::size_t{ 0 }; axis < 3; ++axis) {
+      point[axis] = source[axis] + direction[axis] * t;
+      planeDelta[axis] = point[axis] - corner[axis];
+    }
+    auto const alpha = lina::inlineDot(common, lina::inlineCross(planeDelta, v));
+    auto const beta = lina::inlineDot(common, lina::inlineCross(u, planeDelta));
+    if (0.0 > alpha || alpha > 1.0 || 0.0 > beta || beta > 1.0) { continue; }
+    auto offset = std::array<double, 3>{};
+    for (auto axis = std::size_t{ 0 }; axis < 3; ++axis) { offset[axis] = point[axis] - source[axis]; }
+    distances[i] = std::sqrt(lina::inlineDot(offset, offset));
+  }
+}
+
+// Planes are rectangles, sampled by solid angle, unless a transformation sheared them.
+auto Plane::SamplingPDF(lina::Vec3 const& from) const -> PDF { return parallelogramPDF(from, &shape_); }
+
+auto Plane::Shape() const -> std::optional<SamplingShape> { return std::optional<SamplingShape>{ shape_ }; }
+
+auto Plane::SurfaceArea() const -> double { return shape_.area; }
+
+auto Plane::FrontNormal() const -> std::optional<lina::Vec3>
+{
+  return std::optional<lina::Vec3>{ parallelogram_.normal };
+}
+
+auto Plane::IsAnalytic() const -> bool { return true; }
+
+auto Plane::updateTriangleData() -> void
+{
+  Component::updateTriangleData();
+  parallelogram_ = mesh_.triangleData[0];
+  shape_ = parallelogramShape(parallelogram_.Q, parallelogram_.u, parallelogram_.v);
 }
 
 auto buildPlane(lina::Vec3 center, double width, double depth, Axis normalAxis, Orientation orientation) -> Plane
@@ -2,11 +2,15 @@
 #define RAY_BUSTER_LIB_TRACE_GEOMETRY_PLANE_H_
 
 #include "lib/lina/vec3.h"
+#include "lib/trace/collision.h"
 #include "lib/trace/geometry/component.h"
+#include "lib/trace/geometry/triangle_data.h"
 #include "lib/trace/pdf.h"
+#include "lib/trace/ray.h"
 
 #include <cstdint>
-#include <random>
+#include <optional>
+#include <span>
 
 namespace trace {
 
@@ -19,6 +23,7 @@ enum class Orientation : std::uint8_t { Aligned, Reverse };
 // being I see no other practical way of defining a plane.
 // This way the initialization is simple and we can still have all possible plane orientations by allowing
 // its transformation.
+// The mesh is kept, but collisions are calculated against the parallelogram as a whole.
 class Plane : public Component
 {
 public:
@@ -28,13 +33,27 @@ public:
   auto operator=(Plane&&) -> Plane& = default;
   ~Plane() override = default;
 
-  [[nodiscard]] auto SamplingPDF(std::mt19937& randomGenerator, lina::Vec3 const& from) const -> PDF override;
+  [[nodiscard]] auto Collide(Ray const& ray) const -> std::optional<Collision> override;
+  auto CollideDistances(std::span<Ray const> rays, std::span<double> distances) const -> void override;
+  [[nodiscard]] auto SamplingPDF(lina::Vec3 const& from) const -> PDF override;
+  [[nodiscard]] auto Shape() const -> std::optional<SamplingShape> override;
+  [[nodiscard]] auto SurfaceArea() const -> double override;
+  [[nodiscard]] auto FrontNormal() const -> std::optional<lina::Vec3> override;
+  [[nodiscard]] auto IsAnalytic() const -> bool override;
   friend auto buildPlane(lina::Vec3 center, double width, double depth, Axis normalAxis, Orientation orientation)
     -> Plane;
 
+protected:
+  auto updateTriangleData() -> void override;
+
 private:
   // The plane constructed plane will always have a size of 1.0 * 1.0.
   Plane();
+
+  // The triangle data of the first triangle spans the whole parallelogram, only the alpha + beta <= 1.0
+  // limit has to be dropped.
+  TriangleData parallelogram_;
+  ParallelogramShape shape_;
 };
 
 // Build a plane conveniently oriented along any of the major axis.
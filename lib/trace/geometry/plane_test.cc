@@ -0,0 +1,112 @@
+#include "lib/lina/vec3.h"
+#include "lib/trace/geometry/mesh.h"
+#include "lib/trace/geometry/plane.h"
+#include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
+#include "lib/trace/transform.h"
+#include "lib/trace/util.h"
+
+#include <cmath>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <numbers>
+
+TEST(planeCollide, hitsTheWholeParallelogram)
+{
+  auto plane = trace::buildPlane(lina::Vec3{ 0.0, 0.0, 1.0 }, 2.0, 4.0);
+
+  // close to the corners on both triangles of the mesh
+  auto first = plane.Collide(trace::Ray{ lina::Vec3{ -0.99, -1.99, 5.0 }, lina::Vec3{ 0.0, 0.0, -1.0 } });
+  ASSERT_TRUE(first);
+  EXPECT_DOUBLE_EQ(first->point[2], 1.0);
+  EXPECT_DOUBLE_EQ(first->normal[2], 1.0);
+  EXPECT_TRUE(first->frontFace);
+  auto second = plane.Collide(trace::Ray{ lina::Vec3{ 0.99, 1.99, -5.0 }, lina::Vec3{ 0.0, 0.0, 1.0 } });
+  ASSERT_TRUE(second);
+  EXPECT_DOUBLE_EQ(second->point[2], 1.0);
+  EXPECT_FALSE(second->frontFace);
+
+  EXPECT_FALSE(plane.Collide(trace::Ray{ lina::Vec3{ 1.01, 0.0, 5.0 }, lina::Vec3{ 0.0, 0.0, -1.0 } }));
+  EXPECT_FALSE(plane.Collide(trace::Ray{ lina::Vec3{ 0.0, 0.0, 5.0 }, lina::Vec3{ 0.0, 0.0, 1.0 } }));
+  EXPECT_FALSE(plane.Collide(trace::Ray{ lina::Vec3{ 0.0, 0.0, 5.0 }, lina::Vec3{ 1.0, 0.0, 0.0 } }));
+}
+
+TEST(planeCollide, matchesTheCollisionWithItsMesh)
+{
+  auto plane = trace::buildPlane(lina::Vec3{ 0.5, 1.0, -0.5 }, 3.0, 1.5, trace::Axis::X, trace::Orientation::Reverse);
+  plane.Transform(trace::rotateAlongY(trace::degreesToRadians(20.0)));
+
+  auto sampler = trace::IndependentSampler{ 42 };
+  auto hits = 0;
+  for (auto i = 0; i < 1000; ++i) {
+    auto const source = trace::randomOnUnitSphere(sampler) * 5.0;
+    auto const target = trace::randomOnUnitSphere(sampler) * 1.5;
+    auto const ray = trace::Ray{ source, target - source };
+
+    auto const collision = plane.Collide(ray);
+    auto const meshCollision = trace::meshCollide(ray, plane.GetMesh().triangles, plane.GetMesh().triangleData);
+    ASSERT_EQ(collision.has_value(), meshCollision.has_value());
+    if (!collision) { continue; }
+    ++hits;
+    EXPECT_NEAR((collision->point - meshCollision->collision.point).Length(), 0.0, 1e-9);
+    EXPECT_NEAR((collision->normal - meshCollision->collision.normal).Length(), 0.0, 1e-9);
+    EXPECT_EQ(collision->frontFace, meshCollision->collision.frontFace);
+  }
+  EXPECT_GT(hits, 100);
+}
+
+TEST(planeSamplingPDF, samplesLandOnThePlane)
+{
+  auto plane = trace::buildPlane(lina::Vec3{ 0.0, 0.0, 3.0 }, 2.0, 2.0, trace::Axis::Z, trace::Orientation::Reverse);
+  auto sampler = trace::IndependentSampler{ 42 };
+  auto const from = lina::Vec3{ 0.5, 0.0, 0.0 };
+  auto pdf = plane.SamplingPDF(from);
+  for (auto i = 0; i < 100; ++i) {
+    auto const direction = pdf.GenerateSample(sampler);
+    EXPECT_TRUE(plane.Collide(trace::Ray{ from, direction }));
+    EXPECT_GT(pdf.Evaluate(direction), 0.0);
+  }
+  EXPECT_DOUBLE_EQ(pdf.Evaluate(lina::Vec3{ 0.0, 0.0, -1.0 }), 0.0);
+  EXPECT_DOUBLE_EQ(pdf.Evaluate(lina::Vec3{ 1.0, 0.0, 0.1 }), 0.0);
+}
+
+TEST(planeSamplingPDF, isUniformInTheSubtendedSolidAngle)
+{
+  auto plane = trace::buildPlane(lina::Vec3{ 0.0, 0.0, 3.0 }, 2.0, 2.0, trace::Axis::Z, trace::Orientation::Reverse);
+  // from the distance d above the center of a 2a * 2b rectangle it is 4 asin(ab / sqrt((a^2 + d^2) * (b^2 + d^2)))
+  auto const solidAngle = 4.0 * std::asin(1.0 / 10.0);
+  auto const centered = plane.SamplingPDF(lina::Vec3{ 0.0, 0.0, 0.0 });
+  EXPECT_NEAR(centered.Evaluate(lina::Vec3{ 0.0, 0.0, 1.0 }), 1.0 / solidAngle, 1e-9);
+  EXPECT_NEAR(centered.Evaluate(lina::Vec3{ 0.9, -0.9, 3.0 }), 1.0 / solidAngle, 1e-9);
+
+  // from an offset point the density integrates to one, and the sampled directions are spread like the directions
+  // hitting the plane
+  auto const from = lina::Vec3{ 1.5, -0.5, 0.5 };
+  auto const pdf = plane.SamplingPDF(from);
+  auto sampler = trace::IndependentSampler{ 42 };
+  auto constexpr samples = 200000;
+  auto densitySum = 0.0;
+  auto hits = 0;
+  auto hitSum = lina::Vec3{};
+  auto sampledSum = lina::Vec3{};
+  for (auto i = 0; i < samples; ++i) {
+    auto const onSphere = lina::unit(trace::randomOnUnitSphere(sampler));
+    auto const density = pdf.Evaluate(onSphere);
+    densitySum += density;
+    if (density > 0.0) {
+      ++hits;
+      hitSum += onSphere;
+    }
+    sampledSum += pdf.GenerateSample(sampler);
+  }
+  EXPECT_NEAR(densitySum / samples * 4.0 * std::numbers::pi, 1.0, 0.03);
+  auto const hitMean = hitSum / hits;
+  auto const sampledMean = sampledSum / samples;
+  for (auto i = std::size_t{ 0 }; i < 3; ++i) { EXPECT_NEAR(sampledMean[i], hitMean[i], 0.01); }
+}
+
+TEST(planeSurfaceArea, isWidthTimesDepth)
+{
+  auto const plane = trace::buildPlane(lina::Vec3{ 0.0, 0.0, 5.0 }, 3.0, 7.0, trace::Axis::Y);
+  EXPECT_NEAR(plane.SurfaceArea(), 21.0, 1e-9);
+}
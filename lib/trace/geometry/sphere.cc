@@ -0,0 +1,159 @@
+#include "lib/trace/geometry/sphere.h"
+
+#include "lib/lina/lina.h"
+#include "lib/lina/vec3.h"
+#include "lib/trace/collision.h"
+#include "lib/trace/geometry/aabb.h"
+#include "lib/trace/geometry/component.h"
+#include "lib/trace/geometry/mesh.h"
+#include "lib/trace/pdf.h"
+#include "lib/trace/ray.h"
+#include "lib/trace/transform.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <format>
+#include <limits>
+#include <numbers>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+namespace trace {
+
+auto sphereCrossings(lina::Vec3 const& center, double radius, lina::Vec3 const& source, lina::Vec3 const& direction)
+  -> std::optional<std::pair<double, double>>
+{
+  // With a unit length direction the quadratic equation simplifies to: t^2 + 2bt + c = 0
+  auto const centerToSource = source - center;
+  auto const b = lina::dot(centerToSource, direction);
+  auto const c = lina::dot(centerToSource, centerToSource) - (radius * radius);
+  auto const discriminant = (b * b) - c;
+  if (discriminant < 0.0) { return std::optional<std::pair<double, double>>{}; }
+
+  auto const root = std::sqrt(discriminant);
+  return std::make_pair(-b - root, -b + root);
+}
+
+Sphere::Sphere()
+  : Component{ Mesh{ lina::Vec3{ 0.0, 0.0, 0.0 }, {}, {}, {}, {} } },// no triangles, the equation describes it
+    radius_{ 1.0 }
+{}
+
+auto Sphere::Collide(Ray const& ray) const -> std::optional<Collision>
+{
+  auto const crossings = sphereCrossings(mesh_.center, radius_, ray.Source(), ray.Direction());
+  if (!crossings) { return std::optional<Collision>{}; }
+
+  // Same as for triangles, only collisions strictly in front of the ray count.
+  auto t = crossings->first;
+  if (t <= 0.0) { t = crossings->second; }
+  if (t <= 0.0) { return std::optional<Collision>{}; }
+
+  auto collision = Collision{};
+  collision.point = ray.Source() + ray.Direction() * t;
+  collision.normal = (collision.point - mesh_.center) / radius_;
+  collision.frontFace = lina::dot(collision.normal, ray.Direction()) < 0.0;
+  return std::optional<Collision>{ collision };
+}
+
+// Collide without the vector operations of lina, each of which would be a call.
+auto Sphere::CollideDistances(std::span<Ray const> rays, std::span<double> distances) const -> void
+{
+  auto const& center = mesh_.center.Components();
+  for (auto i = std::size_t{ 0 }; i < rays.size(); ++i) {
+    distances[i] = std::numeric_limits<double>::infinity();
+    auto const& source = rays[i].Source().Components();
+    auto const& direction = rays[i].Direction().Components();
+    auto centerToSource = std::array<double, 3>{};
+    for (auto axis = std::size_t{ 0 }; axis < 3; ++axis) { centerToSource[axis] = source[axis] - center[axis]; }
+    auto const b = lina::inlineDot(centerToSource, direction);
+    auto const c = lina::inlineDot(centerToSource, centerToSource) - (radius_ * radius_);
+    auto const discriminant = (b * b) - c;
+    if (discriminant < 0.0) { continue; }
+    auto const root = std::sqrt(discriminant);
+    auto t = -b - root;
+    if (t <= 0.0) { t = -b + root; }
+    if (t <= 0.0) { continue; }
+    auto offset = std::array<double, 3>{};
+    for (auto axis = std::size_t{ 0 }; axis < 3; ++axis) {
+      offset[axis] = (source[axis] + direction[axis] * t) - source[axis];
+    }
+    distances[i] = std::sqrt(lina::inlineDot(offset, offset));
+  }
+}
+
+auto Sphere::Transform(std::span<double const, 16> transformationMatrix) -> void
+{
+  // The columns of the upper left 3x3 matrix are the transformed base vectors. The sphere stays a sphere only if they
+  // remain perpendicular to each other and have the same length.
+  auto const base = std::array<lina::Vec3, 3>{
+    lina::Vec3{ transformationMatrix[0], transformationMatrix[4], transformationMatrix[8] },
+    lina::Vec3{ transformationMatrix[1], transformationMatrix[5], transformationMatrix[9] },
+    lina::Vec3{ transformationMatrix[2], transformationMatrix[6], transformationMatrix[10] },
+  };
+  auto const scale = base[0].Length();
+  auto const tolerance = 1e-9 * std::max(scale, 1.0);
+  auto const uniform =
+    std::fabs(base[1].Length() - scale) < tolerance && std::fabs(base[2].Length() - scale) < tolerance;
+  auto const perpendicular = std::fabs(lina::dot(base[0], base[1])) < tolerance
+                             && std::fabs(lina::dot(base[0], base[2])) < tolerance
+                             && std::fabs(lina::dot(base[1], base[2])) < tolerance;
+  if (!uniform || !perpendicular || scale < 0.00001) {
+    throw std::logic_error(
+      std::format("Sphere only supports rotation, translation and uniform scaling. Got scaling: {}, {}, {}",
+        base[0].Length(),
+        base[1].Length(),
+        base[2].Length()));
+  }
+
+  Component::Transform(transformationMatrix);
+  radius_ *= scale;
+}
+
+// Cone sampling from the outside, area sampling from the inside, see SpherePDF.
+auto Sphere::SamplingPDF(lina::Vec3 const& from) const -> PDF
+{
+  return PDF{ SpherePDF{ from, mesh_.center, radius_ } };
+}
+
+auto Sphere::Shape() const -> std::optional<SamplingShape>
+{
+  return std::optional<SamplingShape>{ SphereShape{ mesh_.center, radius_ } };
+}
+
+auto Sphere::SurfaceArea() const -> double { return 4.0 * std::numbers::pi * radius_ * radius_; }
+
+auto Sphere::IsAnalytic() const -> bool { return true; }
+
+auto Sphere::GetBoundingBox() const -> Aabb
+{
+  return Aabb{ mesh_.center[0] - radius_,
+    mesh_.center[0] + radius_,
+    mesh_.center[1] - radius_,
+    mesh_.center[1] + radius_,
+    mesh_.center[2] - radius_,
+    mesh_.center[2] + radius_ };
+}
+
+auto Sphere::Center() const -> lina::Vec3 const& { return mesh_.center; }
+
+auto Sphere::Radius() const -> double { return radius_; }
+
+auto buildSphere(lina::Vec3 center, double diameter) -> Sphere
+{
+  diameter = std::fabs(diameter);
+  if (diameter < 0.00001) {
+    throw std::logic_error(std::format("Diameter must be bigger than 0.00001. Got: {}", diameter));
+  }
+
+  auto sphere = Sphere{};
+  auto radius = diameter / 2.0;
+  sphere.Transform(lina::mul(trace::translate(center), trace::scale(lina::Vec3{ radius, radius, radius })));
+  return sphere;
+}
+
+}// namespace trace
@@ -0,0 +1,67 @@
+#ifndef RAY_BUSTER_LIB_TRACE_GEOMETRY_SPHERE_H_
+#define RAY_BUSTER_LIB_TRACE_GEOMETRY_SPHERE_H_
+
+#include "lib/lina/vec3.h"
+#include "lib/trace/collision.h"
+#include "lib/trace/geometry/aabb.h"
+#include "lib/trace/geometry/component.h"
+#include "lib/trace/pdf.h"
+#include "lib/trace/ray.h"
+
+#include <optional>
+#include <span>
+#include <utility>
+
+namespace trace {
+
+// A sphere described by its equation instead of a mesh. Contrary to the Icosphere a collision costs a single
+// evaluation and the normals are exact, so it looks perfectly round at any size.
+// The price is that it only supports transformations that keep it a sphere: rotation, translation and uniform
+// scaling.
+class Sphere : public Component
+{
+public:
+  Sphere(Sphere const&) = default;
+  Sphere(Sphere&&) = default;
+  auto operator=(Sphere const&) -> Sphere& = default;
+  auto operator=(Sphere&&) -> Sphere& = default;
+  ~Sphere() override = default;
+
+  [[nodiscard]] auto Collide(Ray const& ray) const -> std::optional<Collision> override;
+  auto CollideDistances(std::span<Ray const> rays, std::span<double> distances) const -> void override;
+  // Apply the linear transformation matrix to the object.
+  // Throws if the transformation would distort the sphere.
+  auto Transform(std::span<double const, 16> transformationMatrix) -> void override;
+  [[nodiscard]] auto SamplingPDF(lina::Vec3 const& from) const -> PDF override;
+  [[nodiscard]] auto Shape() const -> std::optional<SamplingShape> override;
+  [[nodiscard]] auto SurfaceArea() const -> double override;
+
+  [[nodiscard]] auto IsAnalytic() const -> bool override;
+  [[nodiscard]] auto GetBoundingBox() const -> Aabb override;
+
+  [[nodiscard]] auto Center() const -> lina::Vec3 const&;
+  [[nodiscard]] auto Radius() const -> double;
+
+  friend auto buildSphere(lina::Vec3 center, double diameter) -> Sphere;
+
+private:
+  // A unit sphere at origo.
+  Sphere();
+
+  double radius_;
+};
+
+// The distances along the ray where it crosses the surface of the sphere, in increasing order.
+// Both may be negative, i.e. behind the ray.
+[[nodiscard]] auto sphereCrossings(lina::Vec3 const& center,
+  double radius,
+  lina::Vec3 const& source,
+  lina::Vec3 const& direction) -> std::optional<std::pair<double, double>>;
+
+// Build a sphere at origo, scale and move it to the target position.
+// The diameter default of 2 follows the same convention as the Icosphere.
+[[nodiscard]] auto buildSphere(lina::Vec3 center = lina::Vec3{ 0.0, 0.0, 0.0 }, double diameter = 2.0) -> Sphere;
+
+}// namespace trace
+
+#endif
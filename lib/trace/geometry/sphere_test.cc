@@ -0,0 +1,152 @@
+#include "lib/lina/vec3.h"
+#include "lib/trace/geometry/sphere.h"
+#include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
+#include "lib/trace/transform.h"
+#include "lib/trace/util.h"
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <numbers>
+#include <stdexcept>
+
+TEST(buildSphere, defaultSphereHasRadiusOfOne)
+{
+  auto sphere = trace::buildSphere();
+  ASSERT_DOUBLE_EQ(sphere.Center()[0], 0.0);
+  ASSERT_DOUBLE_EQ(sphere.Center()[1], 0.0);
+  ASSERT_DOUBLE_EQ(sphere.Center()[2], 0.0);
+  ASSERT_DOUBLE_EQ(sphere.Radius(), 1.0);
+  auto limits = sphere.GetBoundingBox();
+  ASSERT_DOUBLE_EQ(limits.minX, -1.0);
+  ASSERT_DOUBLE_EQ(limits.maxX, 1.0);
+  ASSERT_DOUBLE_EQ(limits.minZ, -1.0);
+  ASSERT_DOUBLE_EQ(limits.maxZ, 1.0);
+}
+
+TEST(buildSphere, sphereWithShiftedCenter)
+{
+  auto sphere = trace::buildSphere(lina::Vec3{ 3.3, 2.0, 1.0 }, 1.0);
+  ASSERT_DOUBLE_EQ(sphere.Center()[0], 3.3);
+  ASSERT_DOUBLE_EQ(sphere.Center()[1], 2.0);
+  ASSERT_DOUBLE_EQ(sphere.Center()[2], 1.0);
+  ASSERT_DOUBLE_EQ(sphere.Radius(), 0.5);
+}
+
+TEST(sphereTransform, uniformScalingAndRotationIsAccepted)
+{
+  auto sphere = trace::buildSphere();
+  sphere.Transform(trace::rotateAlongZ(trace::degreesToRadians(30.0)));
+  sphere.Transform(trace::scale(lina::Vec3{ 3.0, 3.0, 3.0 }));
+  EXPECT_NEAR(sphere.Radius(), 3.0, 1e-12);
+}
+
+TEST(sphereTransform, nonUniformScalingThrows)
+{
+  auto sphere = trace::buildSphere();
+  EXPECT_THROW(sphere.Transform(trace::scale(lina::Vec3{ 1.0, 2.0, 1.0 })), std::logic_error);
+}
+
+TEST(sphereCollide, hitFromOutsideHasExactNormal)
+{
+  auto sphere = trace::buildSphere(lina::Vec3{ 0.0, 0.0, 0.0 }, 2.0);
+  auto collision = sphere.Collide(trace::Ray{ lina::Vec3{ 0.0, -5.0, 0.0 }, lina::Vec3{ 0.0, 1.0, 0.0 } });
+  ASSERT_TRUE(collision);
+  EXPECT_DOUBLE_EQ(collision->point[1], -1.0);
+  EXPECT_DOUBLE_EQ(collision->normal[1], -1.0);
+  EXPECT_TRUE(collision->frontFace);
+
+  auto const direction = lina::unit(lina::Vec3{ 0.1, 1.0, 0.05 });
+  auto oblique = sphere.Collide(trace::Ray{ lina::Vec3{ 0.0, -5.0, 0.0 }, direction });
+  ASSERT_TRUE(oblique);
+  EXPECT_NEAR(oblique->point.Length(), 1.0, 1e-12);
+  EXPECT_NEAR(lina::cross(oblique->normal, oblique->point).Length(), 0.0, 1e-12);
+}
+
+TEST(sphereCollide, hitFromInsideIsBackFace)
+{
+  auto sphere = trace::buildSphere(lina::Vec3{ 1.0, 1.0, 1.0 }, 2.0);
+  auto collision = sphere.Collide(trace::Ray{ lina::Vec3{ 1.0, 1.0, 1.0 }, lina::Vec3{ 0.0, 0.0, 1.0 } });
+  ASSERT_TRUE(collision);
+  EXPECT_DOUBLE_EQ(collision->point[2], 2.0);
+  EXPECT_FALSE(collision->frontFace);
+}
+
+TEST(sphereCollide, missesAndCollisionsBehindAreIgnored)
+{
+  auto sphere = trace::buildSphere();
+  EXPECT_FALSE(sphere.Collide(trace::Ray{ lina::Vec3{ 0.0, -5.0, 1.1 }, lina::Vec3{ 0.0, 1.0, 0.0 } }));
+  EXPECT_FALSE(sphere.Collide(trace::Ray{ lina::Vec3{ 0.0, -5.0, 0.0 }, lina::Vec3{ 0.0, -1.0, 0.0 } }));
+}
+
+TEST(sphereSamplingPDF, samplesPointTowardsTheSphereWithPositiveDensity)
+{
+  auto sphere = trace::buildSphere(lina::Vec3{ 0.0, 10.0, 0.0 }, 2.0);
+  auto sampler = trace::IndependentSampler{ 42 };
+  auto const from = lina::Vec3{ 0.0, 0.0, 0.0 };
+  auto pdf = sphere.SamplingPDF(from);
+  for (auto i = 0; i < 100; ++i) {
+    auto direction = pdf.GenerateSample(sampler);
+    EXPECT_TRUE(sphere.Collide(trace::Ray{ from, direction }));
+    EXPECT_GT(pdf.Evaluate(direction), 0.0);
+  }
+  EXPECT_DOUBLE_EQ(pdf.Evaluate(lina::Vec3{ 0.0, -1.0, 0.0 }), 0.0);
+}
+
+TEST(sphereSamplingPDF, densityIntegratesToOneOverTheSubtendedCone)
+{
+  // Integrate the density over the cone the sphere subtends, which has to be 1.0 for a proper PDF.
+  auto const distance = 4.0;
+  auto const radius = 1.0;
+  auto sphere = trace::buildSphere(lina::Vec3{ 0.0, 0.0, distance }, 2.0 * radius);
+  auto pdf = sphere.SamplingPDF(lina::Vec3{ 0.0, 0.0, 0.0 });
+
+  auto const cosThetaMax = std::sqrt(1.0 - (radius * radius) / (distance * distance));
+  auto const steps = 2000;
+  auto integral = 0.0;
+  for (auto i = 0; i < steps; ++i) {
+    // midpoint rule over cos(theta), the density is rotationally symmetric around the Z axis
+    auto const cosTheta = cosThetaMax + (1.0 - cosThetaMax) * (static_cast<double>(i) + 0.5) / steps;
+    auto const sinTheta = std::sqrt(1.0 - cosTheta * cosTheta);
+    integral +=
+      pdf.Evaluate(lina::Vec3{ sinTheta, 0.0, cosTheta }) * 2.0 * std::numbers::pi * (1.0 - cosThetaMax) / steps;
+  }
+  EXPECT_NEAR(integral, 1.0, 1e-2);
+}
+
+TEST(sphereSamplingPDF, samplesFromTheOutsideAreUniformInTheSubtendedCone)
+{
+  // a small sphere far away, where one minus the cosine of the cone's angle would lose its digits
+  auto const distance = 1000.0;
+  auto const radius = 0.01;
+  auto const center = lina::Vec3{ 0.0, distance, 0.0 };
+  auto const sphere = trace::buildSphere(center, 2.0 * radius);
+  auto sampler = trace::IndependentSampler{ 42 };
+  auto const from = lina::Vec3{ 0.0, 0.0, 0.0 };
+  auto const pdf = sphere.SamplingPDF(from);
+
+  auto const sin2ThetaMax = (radius * radius) / (distance * distance);
+  auto const solidAngle = 2.0 * std::numbers::pi * sin2ThetaMax / (1.0 + std::sqrt(1.0 - sin2ThetaMax));
+  for (auto i = 0; i < 1000; ++i) {
+    auto const direction = pdf.GenerateSample(sampler);
+    EXPECT_TRUE(sphere.Collide(trace::Ray{ from, direction }));
+    EXPECT_NEAR(pdf.Evaluate(direction) * solidAngle, 1.0, 1e-9);
+  }
+  EXPECT_EQ(pdf.Evaluate(lina::Vec3{ 0.0, distance, 2.0 * radius }), 0.0);
+}
+
+TEST(sphereSamplingPDF, samplesFromTheInsideCoverTheWholeSphere)
+{
+  auto const sphere = trace::buildSphere(lina::Vec3{ 0.0, 0.0, 0.0 }, 4.0);
+  auto sampler = trace::IndependentSampler{ 42 };
+  auto const pdf = sphere.SamplingPDF(lina::Vec3{ 0.5, 0.0, 0.0 });
+
+  // a Monte Carlo estimate of the integral over all directions, with uniformly distributed ones
+  auto constexpr samples = 100000;
+  auto integral = 0.0;
+  for (auto i = 0; i < samples; ++i) {
+    EXPECT_GT(pdf.Evaluate(pdf.GenerateSample(sampler)), 0.0);
+    integral += pdf.Evaluate(trace::randomOnUnitSphere(sampler)) * 4.0 * std::numbers::pi / samples;
+  }
+  EXPECT_NEAR(integral, 1.0, 0.01);
+}
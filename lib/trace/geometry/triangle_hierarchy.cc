@@ -0,0 +1,119 @@
+#include "lib/trace/geometry/triangle_hierarchy.h"
+
+#include "lib/trace/geometry/aabb.h"
+#include "lib/trace/geometry/mesh.h"
+#include "lib/trace/geometry/triangle_data.h"
+#include "lib/trace/ray.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace trace {
+
+// Leaves with at most this many triangles aren't split any further.
+constexpr auto triangleLeafSize = std::size_t{ 4 };
+
+// The boxes of the triangles lying in an axis plane are flat, they are padded a little, so the rays hitting the
+// triangle aren't lost to the rounding of the slab test.
+static auto paddedBox(Aabb const& box) -> Aabb
+{
+  auto const padding = 1e-6 * std::max({ 1.0, box.maxX - box.minX, box.maxY - box.minY, box.maxZ - box.minZ });
+  return Aabb{ box.minX - padding,
+    box.maxX + padding,
+    box.minY - padding,
+    box.maxY + padding,
+    box.minZ - padding,
+    box.maxZ + padding };
+}
+
+static auto boxCenter(Aabb const& box) -> std::array<double, 3>
+{
+  return { (box.minX + box.maxX) / 2.0, (box.minY + box.maxY) / 2.0, (box.minZ + box.maxZ) / 2.0 };
+}
+
+// Appends the subtree of the triangles depth first. They are split in half at the median of the centers of their
+// boxes, along the axis where the centers spread the most.
+static auto appendTriangleNodes(std::span<std::size_t> triangles,
+  std::size_t first,
+  std::vector<Aabb> const& boxes,
+  std::vector<TriangleNode>& nodes) -> void
+{
+  auto box = boxes[triangles.front()];
+  for (auto const triangle : triangles) { box = mergeAABB(box, boxes[triangle]); }
+  auto const index = nodes.size();
+  nodes.push_back(TriangleNode{ box, first, triangles.size(), 0 });
+  if (triangles.size() > triangleLeafSize) {
+    auto minCenter = boxCenter(boxes[triangles.front()]);
+    auto maxCenter = minCenter;
+    for (auto const triangle : triangles) {
+      auto const center = boxCenter(boxes[triangle]);
+      for (auto axis = std::size_t{ 0 }; axis < 3; ++axis) {
+        minCenter.at(axis) = std::min(minCenter.at(axis), center.at(axis));
+        maxCenter.at(axis) = std::max(maxCenter.at(axis), center.at(axis));
+      }
+    }
+    auto axis = std::size_t{ 0 };
+    for (auto candidate = std::size_t{ 1 }; candidate < 3; ++candidate) {
+      if (maxCenter.at(candidate) - minCenter.at(candidate) > maxCenter.at(axis) - minCenter.at(axis)) {
+        axis = candidate;
+      }
+    }
+    auto const middle = triangles.size() / 2;
+    std::ranges::nth_element(triangles,
+      triangles.begin() + static_cast<std::ptrdiff_t>(middle),
+      {},
+      [&boxes, axis](std::size_t triangle) -> double { return boxCenter(boxes[triangle]).at(axis); });
+    nodes[index].count = 0;
+    appendTriangleNodes(triangles.first(middle), first, boxes, nodes);
+    appendTriangleNodes(triangles.subspan(middle), first + middle, boxes, nodes);
+  }
+  nodes[index].skip = nodes.size();
+}
+
+auto buildTriangleHierarchy(std::vector<TriangleData> const& trianglesData) -> TriangleHierarchy
+{
+  auto hierarchy = TriangleHierarchy{};
+  if (trianglesData.empty()) { return hierarchy; }
+  auto boxes = std::vector<Aabb>{};
+  boxes.reserve(trianglesData.size());
+  for (auto const& triangleData : trianglesData) { boxes.emplace_back(paddedBox(triangleAabb(triangleData))); }
+  hierarchy.triangles.resize(trianglesData.size());
+  std::iota(hierarchy.triangles.begin(), hierarchy.triangles.end(), std::size_t{ 0 });
+  appendTriangleNodes(hierarchy.triangles, 0, boxes, hierarchy.nodes);
+  return hierarchy;
+}
+
+// The nodes the ray enters beyond the closest collision found so far are skipped. Of two collisions at the same
+// distance the triangle with the lower index is kept, as meshCollide keeps the first one.
+auto hierarchyCollide(Ray const& ray,
+  TriangleHierarchy const& hierarchy,
+  std::vector<TriangleData> const& trianglesData) -> std::optional<MeshCollision>
+{
+  auto closest = std::optional<MeshCollision>{};
+  auto nodeIndex = std::size_t{ 0 };
+  while (nodeIndex < hierarchy.nodes.size()) {
+    auto const& node = hierarchy.nodes[nodeIndex];
+    auto const slab = slabCollide(node.box, ray);
+    if (!slab || (closest && slab->entry > closest->distance)) {
+      nodeIndex = node.skip;
+      continue;
+    }
+    for (auto i = node.first; i < node.first + node.count; ++i) {
+      auto candidate = triangleCollide(ray, trianglesData, hierarchy.triangles[i]);
+      if (candidate
+          && (!closest || candidate->distance < closest->distance
+              || (candidate->distance == closest->distance && candidate->triangleId < closest->triangleId))) {
+        closest = candidate;
+      }
+    }
+    ++nodeIndex;
+  }
+  return closest;
+}
+
+}// namespace trace
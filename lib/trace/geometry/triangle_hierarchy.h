@@ -0,0 +1,66 @@
+#ifndef RAY_BUSTER_LIB_TRACE_GEOMETRY_TRIANGLE_HIERARCHY_H_
+#define RAY_BUSTER_LIB_TRACE_GEOMETRY_TRIANGLE_HIERARCHY_H_
+
+#include "lib/trace/geometry/aabb.h"
+#include "lib/trace/geometry/mesh.h"
+#include "lib/trace/geometry/triangle_data.h"
+#include "lib/trace/ray.h"
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace trace {
+
+// A node of the bounding volume hierarchy over the triangles of a mesh. The nodes are stored depth first, so the first
+// child of an inner node is the node right after it, and skip is the index of the node after its whole subtree. A ray
+// missing the box of a node continues at skip, otherwise at the next node. Leaves refer to the triangles
+// [first, first + count) of TriangleHierarchy::triangles, inner nodes have none.
+struct TriangleNode
+{
+  Aabb box;
+  std::size_t first;
+  std::size_t count;
+  std::size_t skip;
+};
+
+// Lets a ray find the triangles of a mesh it crosses, without checking every one of them. Empty for no triangles.
+struct TriangleHierarchy
+{
+  std::vector<TriangleNode> nodes;
+  // the indices of the triangles, in the order the leaves refer to them
+  std::vector<std::size_t> triangles;
+};
+
+[[nodiscard]] auto buildTriangleHierarchy(std::vector<TriangleData> const& trianglesData) -> TriangleHierarchy;
+
+// The same collision as meshCollide, from the triangles in the boxes the ray enters.
+[[nodiscard]] auto hierarchyCollide(Ray const& ray,
+  TriangleHierarchy const& hierarchy,
+  std::vector<TriangleData> const& trianglesData) -> std::optional<MeshCollision>;
+
+// Calls visit with every collision of the ray with the triangles, in no particular order.
+template<typename Visit>
+auto forEachHierarchyCollision(Ray const& ray,
+  TriangleHierarchy const& hierarchy,
+  std::vector<TriangleData> const& trianglesData,
+  Visit&& visit) -> void
+{
+  auto nodeIndex = std::size_t{ 0 };
+  while (nodeIndex < hierarchy.nodes.size()) {
+    auto const& node = hierarchy.nodes[nodeIndex];
+    if (!slabCollide(node.box, ray)) {
+      nodeIndex = node.skip;
+      continue;
+    }
+    for (auto i = node.first; i < node.first + node.count; ++i) {
+      auto const collision = triangleCollide(ray, trianglesData, hierarchy.triangles[i]);
+      if (collision) { visit(collision.value()); }
+    }
+    ++nodeIndex;
+  }
+}
+
+}// namespace trace
+
+#endif
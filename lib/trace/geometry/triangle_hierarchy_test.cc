@@ -0,0 +1,57 @@
+#include "lib/lina/vec3.h"
+#include "lib/trace/geometry/cuboid.h"
+#include "lib/trace/geometry/icosphere.h"
+#include "lib/trace/geometry/mesh.h"
+#include "lib/trace/geometry/triangle_hierarchy.h"
+#include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
+#include "lib/trace/util.h"
+
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <set>
+
+TEST(buildTriangleHierarchy, leavesReferToEveryTriangleOnce)
+{
+  auto const icosphere = trace::buildIcosphere(lina::Vec3{ 0.0, 0.0, 0.0 }, 2.0, 3);
+  auto const& triangleData = icosphere.GetMesh().triangleData;
+  auto const hierarchy = trace::buildTriangleHierarchy(triangleData);
+  ASSERT_GT(hierarchy.nodes.size(), 1);
+  auto triangles = std::multiset<std::size_t>{};
+  for (auto const& node : hierarchy.nodes) {
+    for (auto i = node.first; i < node.first + node.count; ++i) { triangles.insert(hierarchy.triangles[i]); }
+  }
+  ASSERT_EQ(triangles.size(), triangleData.size());
+  for (auto triangleId = std::size_t{ 0 }; triangleId < triangleData.size(); ++triangleId) {
+    EXPECT_EQ(triangles.count(triangleId), 1);
+  }
+  EXPECT_TRUE(trace::buildTriangleHierarchy({}).nodes.empty());
+}
+
+TEST(hierarchyCollide, sameAsCheckingEveryTriangle)
+{
+  // a sphere and a box, whose triangles lie in the planes of the axes
+  for (auto const& mesh : { trace::buildIcosphere(lina::Vec3{ 0.5, -0.5, 1.0 }, 2.0, 3).GetMesh(),
+         trace::buildCuboid(lina::Vec3{ 0.5, -0.5, 1.0 }, 1.0, 2.0, 3.0).GetMesh() }) {
+    auto const hierarchy = trace::buildTriangleHierarchy(mesh.triangleData);
+    auto sampler = trace::IndependentSampler{ 42 };
+    for (auto i = 0; i < 2000; ++i) {
+      auto const ray = trace::Ray{ trace::randomOnUnitSphere(sampler) * 3.0, trace::randomOnUnitSphere(sampler) };
+      auto const expected = trace::meshCollide(ray, mesh.triangles, mesh.triangleData);
+      auto const collision = trace::hierarchyCollide(ray, hierarchy, mesh.triangleData);
+      ASSERT_EQ(expected.has_value(), collision.has_value());
+      auto crossings = std::set<std::size_t>{};
+      trace::forEachHierarchyCollision(ray, hierarchy, mesh.triangleData, [&crossings](trace::MeshCollision const& c) {
+        crossings.insert(c.triangleId);
+      });
+      auto expectedCrossings = std::set<std::size_t>{};
+      for (auto triangleId = std::size_t{ 0 }; triangleId < mesh.triangleData.size(); ++triangleId) {
+        if (trace::triangleCollide(ray, mesh.triangleData, triangleId)) { expectedCrossings.insert(triangleId); }
+      }
+      EXPECT_EQ(crossings, expectedCrossings);
+      if (!expected) { continue; }
+      EXPECT_EQ(expected->triangleId, collision->triangleId);
+      EXPECT_EQ(expected->distance, collision->distance);
+    }
+  }
+}
@@ -4,10 +4,10 @@
 #include "lib/lina/vec3.h"
 #include "lib/trace/collision.h"
 #include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
 #include "lib/trace/scattering.h"
 
 #include <optional>
-#include <random>
 
 namespace trace {
 
@@ -23,7 +23,7 @@ public:
 
   [[nodiscard]] virtual auto Scatter(Ray const& /*ray*/,
     Collision const& /*collision*/,
-    std::mt19937& /*randomGenerator*/) -> std::optional<Scattering>
+    Sampler& /*sampler*/) const -> std::optional<Scattering>
   {
     return std::optional<Scattering>{};
   };
@@ -32,6 +32,12 @@ public:
   {
     return lina::Vec3{ 0.0, 0.0, 0.0 };
   }
+
+  // The radiance emitted towards the front, black for materials that don't emit light. Used to find the lights of a
+  // scene and to weigh them against each other.
+  [[nodiscard]] virtual auto EmittedRadiance() const -> lina::Vec3 { return lina::Vec3{ 0.0, 0.0, 0.0 }; }
+  // Whether the light is only emitted from the front faces.
+  [[nodiscard]] virtual auto EmitsFrontOnly() const -> bool { return false; }
 };
 
 }// namespace trace
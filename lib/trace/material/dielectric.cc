@@ -4,12 +4,12 @@
 #include "lib/lina/vec3.h"
 #include "lib/trace/collision.h"
 #include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
 #include "lib/trace/scattering.h"
 #include "lib/trace/util.h"
 
 #include <cmath>
 #include <optional>
-#include <random>
 
 namespace trace {
 
@@ -17,7 +17,7 @@ Dielectric::Dielectric(double indexOfRefraction) : indexOfRefraction_{ indexOfRe
 
 // As a rule of thumb, you know that your refraction calculations are correct, when you make dielectric
 // sphere using indexOfRefraction of 1.0, and it becomes imperceptible.
-auto Dielectric::Scatter(Ray const& ray, Collision const& collision, std::mt19937& randomGenerator)
+auto Dielectric::Scatter(Ray const& ray, Collision const& collision, Sampler& sampler) const
   -> std::optional<Scattering>
 {
   // In these calculations we assume that we only ever transition between air and a given material.
@@ -32,7 +32,7 @@ auto Dielectric::Scatter(Ray const& ray, Collision const& collision, std::mt1993
   auto canRefract = refractionRatio * sinTheta <= 1.0;
   auto resultRay = Ray{};
 
-  if (!canRefract || reflectance(cosTheta, indexOfRefraction_) > randomUniformDouble(randomGenerator, 0.0, 1.0)) {
+  if (!canRefract || reflectance(cosTheta, indexOfRefraction_) > randomUniformDouble(sampler, 0.0, 1.0)) {
     // reflect
     auto reflectedDirection = ray.Direction() - 2.0 * lina::dot(ray.Direction(), collision.normal) * collision.normal;
     auto adjustedCollisionPoint = collision.point - collision.normal * 0.00001;
@@ -4,14 +4,14 @@
 #include "lib/trace/collision.h"
 #include "lib/trace/material.h"
 #include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
 #include "lib/trace/scattering.h"
 
 #include <optional>
-#include <random>
 
 namespace trace {
 
-class Dielectric : public Material
+class Dielectric final : public Material
 {
 public:
   // air: ~1.0
@@ -21,7 +21,7 @@ public:
 
   // As a rule of thumb, you know that your refraction calculations are correct, when you make dielectric
   // sphere using indexOfRefraction of 1.0, and it becomes imperceptible.
-  auto Scatter(Ray const& ray, Collision const& collision, std::mt19937& randomGenerator)
+  [[nodiscard]] auto Scatter(Ray const& ray, Collision const& collision, Sampler& sampler) const
     -> std::optional<Scattering> override;
 
 private:
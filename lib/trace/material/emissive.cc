@@ -13,4 +13,8 @@ auto Emissive::Emit(Collision const& collision) const -> lina::Vec3
   return color_;
 }
 
+auto Emissive::EmittedRadiance() const -> lina::Vec3 { return color_; }
+
+auto Emissive::EmitsFrontOnly() const -> bool { return directional_; }
+
 }// namespace trace
\ No newline at end of file
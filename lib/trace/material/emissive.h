@@ -7,12 +7,14 @@
 
 namespace trace {
 
-class Emissive : public Material
+class Emissive final : public Material
 {
 public:
   explicit Emissive(lina::Vec3 color, bool directional = false);
 
   [[nodiscard]] auto Emit(Collision const& collision) const -> lina::Vec3 override;
+  [[nodiscard]] auto EmittedRadiance() const -> lina::Vec3 override;
+  [[nodiscard]] auto EmitsFrontOnly() const -> bool override;
 
 private:
   lina::Vec3 color_;
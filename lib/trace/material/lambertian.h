@@ -5,19 +5,19 @@
 #include "lib/trace/collision.h"
 #include "lib/trace/material.h"
 #include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
 #include "lib/trace/scattering.h"
 
 #include <optional>
-#include <random>
 
 namespace trace {
 
-class Lambertian : public Material
+class Lambertian final : public Material
 {
 public:
   explicit Lambertian(lina::Vec3 albedo);
 
-  auto Scatter(Ray const& ray, Collision const& collision, std::mt19937& randomGenerator)
+  [[nodiscard]] auto Scatter(Ray const& ray, Collision const& collision, Sampler& sampler) const
     -> std::optional<Scattering> override;
 
 private:
@@ -3,12 +3,12 @@
 #include "lib/lina/vec3.h"
 #include "lib/trace/collision.h"
 #include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
 #include "lib/trace/scattering.h"
 #include "lib/trace/util.h"
 
 #include <cstddef>
 #include <optional>
-#include <random>
 
 namespace trace {
 
@@ -16,19 +16,19 @@ Metal::Metal(lina::Vec3 albedo, double fuzz, std::size_t retryCount)
   : albedo_{ albedo }, fuzz_{ fuzz }, retryCount_{ retryCount }
 {}
 
-auto Metal::Scatter(Ray const& ray, Collision const& collision, std::mt19937& randomGenerator)
+auto Metal::Scatter(Ray const& ray, Collision const& collision, Sampler& sampler) const
   -> std::optional<Scattering>
 {
   auto normal = collision.frontFace ? collision.normal : collision.normal * -1.0;
   auto adjustedCollisionPoint = collision.point + normal * 0.00001;
   auto reflectedDirection = ray.Direction() - (2.0 * lina::dot(ray.Direction(), normal) * normal);
 
-  auto fuzzedDirection = reflectedDirection + randomOnUnitSphere(randomGenerator) * fuzz_;
+  auto fuzzedDirection = reflectedDirection + randomOnUnitSphere(sampler) * fuzz_;
   // Should the fuzzedDirection point in a direction [orthogonal to normal, opposite to normal], then we just
   // regenerate the fuzzed direction. This way we can ensure that we always return a valid ray.
   for (auto retryCount = std::size_t{ 0 }; retryCount < retryCount_ && lina::dot(fuzzedDirection, normal) <= 0.0;
        ++retryCount) {
-    fuzzedDirection = reflectedDirection + randomOnUnitSphere(randomGenerator) * fuzz_;
+    fuzzedDirection = reflectedDirection + randomOnUnitSphere(sampler) * fuzz_;
   }
 
   auto scattering = Scattering{};
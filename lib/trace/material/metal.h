@@ -5,15 +5,15 @@
 #include "lib/trace/collision.h"
 #include "lib/trace/material.h"
 #include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
 #include "lib/trace/scattering.h"
 
 #include <cstddef>
 #include <optional>
-#include <random>
 
 namespace trace {
 
-class Metal : public Material
+class Metal final : public Material
 {
 public:
   // Fuzz 0.0 means perfect reflections, while bigger/lower values increase the probability of the reflected ray
@@ -24,7 +24,7 @@ public:
   // very unlikely circumstances.
   explicit Metal(lina::Vec3 albedo, double fuzz = 0.01, std::size_t retryCount = 3);
 
-  auto Scatter(Ray const& ray, Collision const& collision, std::mt19937& randomGenerator)
+  [[nodiscard]] auto Scatter(Ray const& ray, Collision const& collision, Sampler& sampler) const
     -> std::optional<Scattering> override;
 
 private:
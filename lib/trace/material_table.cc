@@ -0,0 +1,54 @@
+#include "material_table.h"
+
+#include "lib/lina/vec3.h"
+#include "lib/trace/collision.h"
+#include "lib/trace/material.h"
+#include "lib/trace/material/dielectric.h"
+#include "lib/trace/material/emissive.h"
+#include "lib/trace/material/lambertian.h"
+#include "lib/trace/material/metal.h"
+#include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
+#include "lib/trace/scattering.h"
+
+#include <cstddef>
+#include <format>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <variant>
+
+namespace trace {
+
+static auto toEntry(Material const* material, std::size_t materialIndex) -> MaterialTable::Entry
+{
+  if (auto const* lambertian = dynamic_cast<Lambertian const*>(material)) { return *lambertian; }
+  if (auto const* metal = dynamic_cast<Metal const*>(material)) { return *metal; }
+  if (auto const* dielectric = dynamic_cast<Dielectric const*>(material)) { return *dielectric; }
+  if (auto const* emissive = dynamic_cast<Emissive const*>(material)) { return *emissive; }
+  throw std::invalid_argument(std::format("Unsupported material at index {}", materialIndex));
+}
+
+MaterialTable::MaterialTable(std::span<Material const* const> materials)
+{
+  materials_.reserve(materials.size());
+  for (auto i = std::size_t{ 0 }; i < materials.size(); ++i) { materials_.emplace_back(toEntry(materials[i], i)); }
+}
+
+auto MaterialTable::Emit(std::size_t materialIndex, Collision const& collision) const -> lina::Vec3
+{
+  return std::visit([&collision](auto const& material) -> lina::Vec3 { return material.Emit(collision); },
+    materials_[materialIndex]);
+}
+
+auto MaterialTable::Scatter(std::size_t materialIndex, Ray const& ray, Collision const& collision, Sampler& sampler)
+  const -> std::optional<Scattering>
+{
+  return std::visit([&ray, &collision, &sampler](auto const& material)
+                      -> std::optional<Scattering> { return material.Scatter(ray, collision, sampler); },
+    materials_[materialIndex]);
+}
+
+auto MaterialTable::Kind(std::size_t materialIndex) const -> std::size_t { return materials_[materialIndex].index(); }
+
+}// namespace trace
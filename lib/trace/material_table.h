@@ -0,0 +1,53 @@
+#ifndef RAY_BUSTER_LIB_TRACE_MATERIAL_TABLE_H_
+#define RAY_BUSTER_LIB_TRACE_MATERIAL_TABLE_H_
+
+#include "lib/lina/vec3.h"
+#include "lib/trace/collision.h"
+#include "lib/trace/material.h"
+#include "lib/trace/material/dielectric.h"
+#include "lib/trace/material/emissive.h"
+#include "lib/trace/material/lambertian.h"
+#include "lib/trace/material/metal.h"
+#include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
+#include "lib/trace/scattering.h"
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <variant>
+#include <vector>
+
+namespace trace {
+
+// Copies of the materials of a scene, stored by value next to each other, for shading.
+// The materials are a closed set of final classes, so the calls through the table are resolved by the index of the
+// variant instead of the virtual function tables, and they can be inlined. The material at index i is a copy of the
+// i-th given material, the same index the collisions report the component they hit by.
+class MaterialTable
+{
+public:
+  using Entry = std::variant<Lambertian, Metal, Dielectric, Emissive>;
+
+  // Throws std::invalid_argument for a material that isn't one of the entries.
+  explicit MaterialTable(std::span<Material const* const> materials);
+  MaterialTable(MaterialTable const&) = default;
+  MaterialTable(MaterialTable&&) = default;
+  auto operator=(MaterialTable const&) -> MaterialTable& = default;
+  auto operator=(MaterialTable&&) -> MaterialTable& = default;
+  ~MaterialTable() = default;
+
+  [[nodiscard]] auto Emit(std::size_t materialIndex, Collision const& collision) const -> lina::Vec3;
+  [[nodiscard]] auto Scatter(std::size_t materialIndex, Ray const& ray, Collision const& collision, Sampler& sampler)
+    const -> std::optional<Scattering>;
+  // The type of the material, the index of its alternative in Entry. Collisions shaded in the order of their kinds
+  // run the same code one after the other.
+  [[nodiscard]] auto Kind(std::size_t materialIndex) const -> std::size_t;
+
+private:
+  std::vector<Entry> materials_;
+};
+
+}// namespace trace
+
+#endif
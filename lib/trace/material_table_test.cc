@@ -0,0 +1,62 @@
+#include "lib/lina/vec3.h"
+#include "lib/trace/collision.h"
+#include "lib/trace/material.h"
+#include "lib/trace/material/dielectric.h"
+#include "lib/trace/material/emissive.h"
+#include "lib/trace/material/lambertian.h"
+#include "lib/trace/material/metal.h"
+#include "lib/trace/material_table.h"
+#include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
+
+#include <array>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <variant>
+
+TEST(MaterialTable, shadesLikeTheMaterials)
+{
+  auto const lambertian = trace::Lambertian{ lina::Vec3{ 0.2, 0.4, 0.6 } };
+  auto const metal = trace::Metal{ lina::Vec3{ 0.9, 0.8, 0.7 }, 0.3 };
+  auto const dielectric = trace::Dielectric{ 1.5 };
+  auto const emissive = trace::Emissive{ lina::Vec3{ 4.0, 3.0, 2.0 }, true };
+  auto const materials = std::array<trace::Material const*, 4>{ &lambertian, &metal, &dielectric, &emissive };
+  auto const table = trace::MaterialTable{ materials };
+
+  auto const ray = trace::Ray{ lina::Vec3{ 0.0, 0.0, 1.0 }, lina::Vec3{ 0.3, 0.1, -1.0 } };
+  for (auto const frontFace : { true, false }) {
+    auto collision = trace::Collision{};
+    collision.point = lina::Vec3{ 0.3, 0.1, 0.0 };
+    collision.normal = lina::Vec3{ 0.0, 0.0, 1.0 };
+    collision.frontFace = frontFace;
+    for (auto i = std::size_t{ 0 }; i < materials.size(); ++i) {
+      EXPECT_EQ(table.Kind(i), i);
+      EXPECT_EQ(table.Emit(i, collision).Components(), materials.at(i)->Emit(collision).Components());
+
+      auto tableSampler = trace::IndependentSampler{ 42 };
+      auto sampler = trace::IndependentSampler{ 42 };
+      auto const fromTable = table.Scatter(i, ray, collision, tableSampler);
+      auto const expected = materials.at(i)->Scatter(ray, collision, sampler);
+      ASSERT_EQ(fromTable.has_value(), expected.has_value());
+      if (!expected) { continue; }
+      EXPECT_EQ(fromTable->attenuation.Components(), expected->attenuation.Components());
+      ASSERT_EQ(fromTable->type.index(), expected->type.index());
+      if (std::holds_alternative<trace::Ray>(expected->type)) {
+        auto const& tableRay = std::get<trace::Ray>(fromTable->type);
+        auto const& expectedRay = std::get<trace::Ray>(expected->type);
+        EXPECT_EQ(tableRay.Source().Components(), expectedRay.Source().Components());
+        EXPECT_EQ(tableRay.Direction().Components(), expectedRay.Direction().Components());
+      } else {
+        EXPECT_EQ(fromTable->origin.Components(), expected->origin.Components());
+      }
+    }
+  }
+}
+
+TEST(MaterialTable, rejectsUnknownMaterials)
+{
+  auto const material = trace::Material{};
+  auto const materials = std::array<trace::Material const*, 1>{ &material };
+  EXPECT_THROW(trace::MaterialTable{ materials }, std::invalid_argument);
+}
@@ -0,0 +1,281 @@
+#include "pdf.h"
+
+#include "lib/lina/lina.h"
+#include "lib/lina/vec3.h"
+#include "lib/trace/geometry/mesh.h"
+#include "lib/trace/geometry/sphere.h"
+#include "lib/trace/geometry/triangle_data.h"
+#include "lib/trace/geometry/triangle_hierarchy.h"
+#include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
+#include "lib/trace/util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+
+namespace trace {
+
+static auto evaluate(std::monostate /*empty*/, lina::Vec3 const& /*direction*/) -> double { return 0.0; }
+
+static auto generateSample(std::monostate /*empty*/, Sampler& /*sampler*/) -> lina::Vec3
+{
+  throw std::logic_error("An empty PDF can't be sampled.");
+}
+
+static auto evaluate(CosinePDF const& pdf, lina::Vec3 const& direction) -> double
+{
+  auto const cosTheta = lina::dot(pdf.normal, lina::unit(direction));
+  return cosTheta < 0.0 ? 0.0 : cosTheta / std::numbers::pi;
+}
+
+static auto generateSample(CosinePDF const& pdf, Sampler& sampler) -> lina::Vec3
+{
+  return Onb{ pdf.normal }.Transform(randomCosineDirection(sampler));
+}
+
+// Converting the area density into solid angle gives distance^2 / (cosine * area), taken where the direction
+// crosses the parallelogram. The crossing is the same as the collision of the Plane, the normal over the area is the
+// normal of the edges' cross product over its squared length.
+static auto evaluate(ParallelogramPDF const& pdf, lina::Vec3 const& direction) -> double
+{
+  auto const& parallelogram = *pdf.parallelogram;
+  auto const unitDirection = lina::unit(direction);
+  auto const denominator = lina::dot(parallelogram.normal, unitDirection);
+  if (denominator == 0.0) { return 0.0; }
+  auto const t = lina::dot(parallelogram.normal, parallelogram.corner - pdf.from) / denominator;
+  if (t <= 0.0) { return 0.0; }
+
+  auto const planeDelta = (pdf.from + unitDirection * t) - parallelogram.corner;
+  auto const alpha = lina::dot(parallelogram.normal, lina::cross(planeDelta, parallelogram.edgeV)) / parallelogram.area;
+  auto const beta = lina::dot(parallelogram.normal, lina::cross(parallelogram.edgeU, planeDelta)) / parallelogram.area;
+  if (0.0 > alpha || alpha > 1.0 || 0.0 > beta || beta > 1.0) { return 0.0; }
+  return (t * t) / (std::fabs(denominator) * parallelogram.area);
+}
+
+static auto generateSample(ParallelogramPDF const& pdf, Sampler& sampler) -> lina::Vec3
+{
+  auto const& parallelogram = *pdf.parallelogram;
+  auto const alpha = randomUniformDouble(sampler, 0.0, 1.0);
+  auto const beta = randomUniformDouble(sampler, 0.0, 1.0);
+  auto const onPlane = parallelogram.corner + (alpha * parallelogram.edgeU) + (beta * parallelogram.edgeV);
+  return lina::unit(onPlane - pdf.from);
+}
+
+// The density is constant over the directions crossing the rectangle. The crossing is checked in the frame, where the
+// rectangle is axis aligned on the z = z0 plane.
+static auto evaluate(SphericalRectanglePDF const& pdf, lina::Vec3 const& direction) -> double
+{
+  auto const dz = lina::dot(direction, pdf.z);
+  if (dz >= 0.0) { return 0.0; }
+  auto const t = pdf.z0 / dz;
+  auto const x = t * lina::dot(direction, pdf.x);
+  auto const y = t * lina::dot(direction, pdf.y);
+  if (pdf.x0 > x || x > pdf.x1 || pdf.y0 > y || y > pdf.y1) { return 0.0; }
+  return 1.0 / pdf.solidAngle;
+}
+
+// The first coordinate picks the x of the point through the solid angle of the part of the rectangle left of it,
+// the second one the y through the sine of the elevation along that x.
+static auto generateSample(SphericalRectanglePDF const& pdf, Sampler& sampler) -> lina::Vec3
+{
+  auto const [u, v] = sampler.Uniform2D();
+  auto const au = u * pdf.solidAngle + pdf.k;
+  auto const fu = (std::cos(au) * pdf.b0 - pdf.b1) / std::sin(au);
+  auto const cu = std::clamp(std::copysign(1.0, fu) / std::sqrt(fu * fu + pdf.b0 * pdf.b0), -1.0, 1.0);
+  auto const xu = std::clamp(-(cu * pdf.z0) / std::sqrt(std::max(0.0, 1.0 - cu * cu)), pdf.x0, pdf.x1);
+
+  auto const d = std::sqrt(xu * xu + pdf.z0 * pdf.z0);
+  auto const h0 = pdf.y0 / std::sqrt(d * d + pdf.y0 * pdf.y0);
+  auto const h1 = pdf.y1 / std::sqrt(d * d + pdf.y1 * pdf.y1);
+  auto const hv = h0 + v * (h1 - h0);
+  auto const yv = hv * hv < 1.0 - 1e-12 ? (hv * d) / std::sqrt(1.0 - hv * hv) : pdf.y1;
+  return lina::unit(xu * pdf.x + std::clamp(yv, pdf.y0, pdf.y1) * pdf.y + pdf.z0 * pdf.z);
+}
+
+// The sine squared and the cosine of the half angle of the cone the sphere subtends from the point, and one minus
+// the cosine, which is the solid angle over 2 pi. Nothing when the point is inside.
+// For small spheres the cosine is close to one, so one minus it is calculated from the sine, without cancellation.
+struct SubtendedCone
+{
+  double sin2ThetaMax;
+  double cosThetaMax;
+  double oneMinusCosThetaMax;
+};
+
+static auto subtendedCone(SpherePDF const& pdf) -> std::optional<SubtendedCone>
+{
+  auto const distanceSquared = lina::dot(pdf.center - pdf.from, pdf.center - pdf.from);
+  auto const radiusSquared = pdf.radius * pdf.radius;
+  if (distanceSquared <= radiusSquared) { return std::optional<SubtendedCone>{}; }
+  auto const sin2ThetaMax = radiusSquared / distanceSquared;
+  auto const cosThetaMax = std::sqrt(1.0 - sin2ThetaMax);
+  return SubtendedCone{ sin2ThetaMax, cosThetaMax, sin2ThetaMax / (1.0 + cosThetaMax) };
+}
+
+// From the outside the directions are uniform within the cone the sphere subtends, so none of them is wasted on the
+// far side, or misses the sphere.
+// From the inside every direction hits the sphere, and a point is picked uniformly on the surface. Converting the area
+// density into solid angle gives distance^2 / (cosine * area).
+static auto evaluate(SpherePDF const& pdf, lina::Vec3 const& direction) -> double
+{
+  auto const unitDirection = lina::unit(direction);
+  auto const cone = subtendedCone(pdf);
+  if (cone) {
+    auto const cosTheta = lina::dot(unitDirection, lina::unit(pdf.center - pdf.from));
+    if (cosTheta < cone->cosThetaMax) { return 0.0; }
+    return 1.0 / (2.0 * std::numbers::pi * cone->oneMinusCosThetaMax);
+  }
+
+  auto const crossings = sphereCrossings(pdf.center, pdf.radius, pdf.from, unitDirection);
+  if (!crossings || crossings->second <= 0.0) { return 0.0; }
+  auto const t = crossings->second;
+  auto const normal = ((pdf.from + unitDirection * t) - pdf.center) / pdf.radius;
+  auto const cosine = std::fabs(lina::dot(unitDirection, normal));
+  if (cosine == 0.0) { return 0.0; }
+  return (t * t) / (cosine * 4.0 * std::numbers::pi * pdf.radius * pdf.radius);
+}
+
+static auto generateSample(SpherePDF const& pdf, Sampler& sampler) -> lina::Vec3
+{
+  auto const cone = subtendedCone(pdf);
+  if (!cone) {
+    auto const onSurface = pdf.center + lina::unit(randomOnUnitSphere(sampler)) * pdf.radius;
+    return lina::unit(onSurface - pdf.from);
+  }
+
+  auto const [u, v] = sampler.Uniform2D();
+  // uniform in the cosine over [cosThetaMax, 1], one minus it is again kept away from the cancellation
+  auto const oneMinusCosTheta = u * cone->oneMinusCosThetaMax;
+  auto const cosTheta = 1.0 - oneMinusCosTheta;
+  auto const sinTheta = std::sqrt(std::max(0.0, oneMinusCosTheta * (2.0 - oneMinusCosTheta)));
+  auto const phi = 2.0 * std::numbers::pi * v;
+  auto const local = lina::Vec3{ sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta };
+  return lina::unit(Onb{ pdf.center - pdf.from }.Transform(local));
+}
+
+// Every triangle the direction crosses could have been sampled, so their densities sum, like for the sphere.
+// Only the triangles in the boxes of the hierarchy the direction enters are checked.
+static auto evaluate(TriangleMeshPDF const& pdf, lina::Vec3 const& direction) -> double
+{
+  auto const ray = Ray{ pdf.from, direction };
+  auto const area = pdf.cumulativeAreas->back();
+  auto density = 0.0;
+  forEachHierarchyCollision(ray, *pdf.hierarchy, *pdf.triangles, [&ray, area, &density](MeshCollision const& crossing) {
+    auto const cosine = std::fabs(lina::dot(ray.Direction(), crossing.collision.normal));
+    if (cosine == 0.0) { return; }
+    density += (crossing.distance * crossing.distance) / (cosine * area);
+  });
+  return density;
+}
+
+static auto generateSample(TriangleMeshPDF const& pdf, Sampler& sampler) -> lina::Vec3
+{
+  auto const& cumulativeAreas = *pdf.cumulativeAreas;
+  auto const picked =
+    std::ranges::upper_bound(cumulativeAreas, randomUniformDouble(sampler, 0.0, cumulativeAreas.back()));
+  auto const triangleId =
+    std::min(static_cast<std::size_t>(picked - cumulativeAreas.begin()), cumulativeAreas.size() - 1);
+  auto const& triangle = (*pdf.triangles)[triangleId];
+  // the square root makes the points uniform, instead of crowding towards Q
+  auto const root = std::sqrt(randomUniformDouble(sampler, 0.0, 1.0));
+  auto const beta = randomUniformDouble(sampler, 0.0, 1.0);
+  auto const onTriangle = triangle.Q + (root * (1.0 - beta) * triangle.u) + (root * beta * triangle.v);
+  return lina::unit(onTriangle - pdf.from);
+}
+
+auto parallelogramShape(lina::Vec3 const& corner, lina::Vec3 const& edgeU, lina::Vec3 const& edgeV)
+  -> ParallelogramShape
+{
+  // the length of the cross product is equal to the size of the parallelogram described by the vectors
+  auto const n = lina::cross(edgeU, edgeV);
+  auto const area = n.Length();
+  auto const sideCosine = lina::dot(edgeU, edgeV) / (edgeU.Length() * edgeV.Length());
+  return ParallelogramShape{ corner, edgeU, edgeV, n / area, area, std::fabs(sideCosine) < 1e-9 };
+}
+
+PDF::PDF(Density density) : density_{ std::move(density) } {}
+
+auto PDF::Evaluate(lina::Vec3 const& direction) const -> double
+{
+  return std::visit([&direction](auto const& density) -> double { return evaluate(density, direction); }, density_);
+}
+
+auto PDF::GenerateSample(Sampler& sampler) const -> lina::Vec3
+{
+  return std::visit(
+    [&sampler](auto const& density) -> lina::Vec3 { return generateSample(density, sampler); }, density_);
+}
+
+// The angle between two unit vectors, without the loss of precision acos has close to 1 and -1.
+static auto angleBetween(lina::Vec3 const& lhs, lina::Vec3 const& rhs) -> double
+{
+  if (lina::dot(lhs, rhs) < 0.0) {
+    return std::numbers::pi - 2.0 * std::asin(std::min(1.0, (lhs + rhs).Length() / 2.0));
+  }
+  return 2.0 * std::asin(std::min(1.0, (rhs - lhs).Length() / 2.0));
+}
+
+auto parallelogramPDF(lina::Vec3 const& from, ParallelogramShape const* parallelogram) -> PDF
+{
+  // below this the sampled directions lose precision, above it the rectangle is seen from right next to it
+  auto constexpr minSolidAngle = 3e-4;
+  auto constexpr maxSolidAngle = 6.22;
+  auto const byArea = PDF{ ParallelogramPDF{ from, parallelogram } };
+  if (!parallelogram->rectangle) { return byArea; }
+
+  auto const width = parallelogram->edgeU.Length();
+  auto const height = parallelogram->edgeV.Length();
+  auto const x = parallelogram->edgeU / width;
+  auto const y = parallelogram->edgeV / height;
+  auto z = parallelogram->normal;
+  auto const toCorner = parallelogram->corner - from;
+  auto z0 = lina::dot(toCorner, z);
+  if (z0 > 0.0) {
+    z = -z;
+    z0 = -z0;
+  }
+  if (z0 == 0.0) { return byArea; }
+  auto const x0 = lina::dot(toCorner, x);
+  auto const y0 = lina::dot(toCorner, y);
+  auto const x1 = x0 + width;
+  auto const y1 = y0 + height;
+
+  // the normals of the planes through the point and the sides, the angles between them are the inner angles
+  auto const v00 = lina::Vec3{ x0, y0, z0 };
+  auto const v01 = lina::Vec3{ x0, y1, z0 };
+  auto const v10 = lina::Vec3{ x1, y0, z0 };
+  auto const v11 = lina::Vec3{ x1, y1, z0 };
+  auto const n0 = lina::unit(lina::cross(v00, v10));
+  auto const n1 = lina::unit(lina::cross(v10, v11));
+  auto const n2 = lina::unit(lina::cross(v11, v01));
+  auto const n3 = lina::unit(lina::cross(v01, v00));
+  auto const g0 = angleBetween(-n0, n1);
+  auto const g1 = angleBetween(-n1, n2);
+  auto const g2 = angleBetween(-n2, n3);
+  auto const g3 = angleBetween(-n3, n0);
+  auto const solidAngle = g0 + g1 + g2 + g3 - 2.0 * std::numbers::pi;
+  if (!(solidAngle > minSolidAngle && solidAngle < maxSolidAngle)) { return byArea; }
+
+  return PDF{ SphericalRectanglePDF{
+    x, y, z, x0, x1, y0, y1, z0, n0[2], n2[2], 2.0 * std::numbers::pi - g2 - g3, solidAngle } };
+}
+
+auto samplingPDF(SamplingShape const& shape, lina::Vec3 const& from) -> PDF
+{
+  if (auto const* parallelogram = std::get_if<ParallelogramShape>(&shape)) {
+    return parallelogramPDF(from, parallelogram);
+  }
+  if (auto const* sphere = std::get_if<SphereShape>(&shape)) {
+    return PDF{ SpherePDF{ from, sphere->center, sphere->radius } };
+  }
+  auto const& mesh = std::get<TriangleMeshShape>(shape);
+  return PDF{ TriangleMeshPDF{ from, mesh.triangles, mesh.hierarchy, mesh.cumulativeAreas } };
+}
+
+}// namespace trace
@@ -2,18 +2,138 @@
 #define RAY_BUSTER_LIB_TRACE_PDF_H_
 
 #include "lib/lina/vec3.h"
+#include "lib/trace/geometry/triangle_data.h"
+#include "lib/trace/geometry/triangle_hierarchy.h"
+#include "lib/trace/sampler.h"
 
-#include <functional>
+#include <variant>
+#include <vector>
 
 namespace trace {
 
-struct PDF
+// The shapes the densities towards the lights sample, precomputed when the scene is built, so sampling and evaluating
+// only read them.
+// A parallelogram: the points corner + alpha * edgeU + beta * edgeV for alpha and beta in [0, 1], the unit normal is
+// along the cross product of the edges. A rectangle has perpendicular edges. Make it with parallelogramShape.
+struct ParallelogramShape
 {
-  std::function<double(lina::Vec3 const&)> Evaluate;
-  std::function<lina::Vec3()> GenerateSample;
-  std::function<lina::Vec3()> AdjustedCollisionPoint;
+  lina::Vec3 corner;
+  lina::Vec3 edgeU;
+  lina::Vec3 edgeV;
+  lina::Vec3 normal;
+  double area;
+  bool rectangle;
 };
 
+struct SphereShape
+{
+  lina::Vec3 center;
+  double radius;
+};
+
+// The triangles, their hierarchy and the sums of their areas up to each of them are the ones of the component, which
+// has to outlive the shape.
+struct TriangleMeshShape
+{
+  std::vector<TriangleData> const* triangles;
+  TriangleHierarchy const* hierarchy;
+  std::vector<double> const* cumulativeAreas;
+};
+
+using SamplingShape = std::variant<ParallelogramShape, SphereShape, TriangleMeshShape>;
+
+[[nodiscard]] auto parallelogramShape(lina::Vec3 const& corner, lina::Vec3 const& edgeU, lina::Vec3 const& edgeV)
+  -> ParallelogramShape;
+
+// Cosine weighted directions on the hemisphere around the normal, the scattering of Lambertian surfaces.
+struct CosinePDF
+{
+  lina::Vec3 normal;
+};
+
+// Directions from a point towards the points of a parallelogram, picked uniformly by area.
+// The parallelogram has to outlive the PDF.
+struct ParallelogramPDF
+{
+  lina::Vec3 from;
+  ParallelogramShape const* parallelogram;
+};
+
+// Directions from a point towards a rectangle, uniform within the solid angle it subtends, following Ureña et al.:
+// An Area-Preserving Parametrization for Spherical Rectangles. Build it with parallelogramPDF.
+// The rectangle is kept in a frame around the point: x and y are along its sides, z points away from it, and
+// [x0, x1] * [y0, y1] is the rectangle on the z = z0 plane. b0, b1 and k are the constants of the parametrization.
+struct SphericalRectanglePDF
+{
+  lina::Vec3 x;
+  lina::Vec3 y;
+  lina::Vec3 z;
+  double x0;
+  double x1;
+  double y0;
+  double y1;
+  double z0;
+  double b0;
+  double b1;
+  double k;
+  double solidAngle;
+};
+
+// Directions from a point towards a sphere. From the outside they are uniform within the cone the sphere subtends,
+// from the inside they are towards uniformly picked points of the surface.
+struct SpherePDF
+{
+  lina::Vec3 from;
+  lina::Vec3 center;
+  double radius;
+};
+
+// Directions from a point towards the points of a triangle mesh, picked uniformly by area: a triangle is picked with
+// the probability of its share of the area, then a point on it. The triangles, their hierarchy and the sums of their
+// areas up to each of them are the ones of the component, which has to outlive the PDF.
+struct TriangleMeshPDF
+{
+  lina::Vec3 from;
+  std::vector<TriangleData> const* triangles;
+  TriangleHierarchy const* hierarchy;
+  std::vector<double> const* cumulativeAreas;
+};
+
+// A probability density over directions. It is a plain value, a closed set of densities, so making one costs
+// no allocation and using one no indirect call. The default constructed PDF is empty, it has zero density
+// everywhere and can't be sampled.
+class PDF
+{
+public:
+  using Density =
+    std::variant<std::monostate, CosinePDF, ParallelogramPDF, SphericalRectanglePDF, SpherePDF, TriangleMeshPDF>;
+
+  PDF() = default;
+  explicit PDF(Density density);
+  PDF(PDF const&) = default;
+  PDF(PDF&&) = default;
+  auto operator=(PDF const&) -> PDF& = default;
+  auto operator=(PDF&&) -> PDF& = default;
+  ~PDF() = default;
+
+  // The density of the direction, which doesn't have to be a unit vector.
+  [[nodiscard]] auto Evaluate(lina::Vec3 const& direction) const -> double;
+  // A unit direction following the density.
+  [[nodiscard]] auto GenerateSample(Sampler& sampler) const -> lina::Vec3;
+
+private:
+  Density density_;
+};
+
+// The density of the directions from a point towards a parallelogram. Rectangles are sampled uniformly in solid angle,
+// so the points right under a large light don't get the high variance of sampling it by area. The solid angle is
+// calculated here once, and the frame is built by value. Other parallelograms, and rectangles with a solid angle too
+// small, or too close to a half sphere, for the parametrization to be precise, are sampled by area, with a PDF that
+// refers to the parallelogram.
+[[nodiscard]] auto parallelogramPDF(lina::Vec3 const& from, ParallelogramShape const* parallelogram) -> PDF;
+// The density of the directions from a point towards the shape, which has to outlive it.
+[[nodiscard]] auto samplingPDF(SamplingShape const& shape, lina::Vec3 const& from) -> PDF;
+
 }// namespace trace
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,37 @@
+#include "lib/lina/vec3.h"
+#include "lib/trace/pdf.h"
+#include "lib/trace/sampler.h"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <numbers>
+#include <stdexcept>
+
+TEST(PDF, emptyHasNoDensityAndCannotBeSampled)
+{
+  auto const pdf = trace::PDF{};
+  auto sampler = trace::IndependentSampler{ 42 };
+  EXPECT_EQ(pdf.Evaluate(lina::Vec3{ 0.0, 0.0, 1.0 }), 0.0);
+  EXPECT_THROW((void)pdf.GenerateSample(sampler), std::logic_error);
+}
+
+TEST(PDF, cosineSamplesTheHemisphereAroundTheNormal)
+{
+  auto const normal = lina::unit(lina::Vec3{ 1.0, -2.0, 0.5 });
+  auto const pdf = trace::PDF{ trace::CosinePDF{ normal } };
+  auto sampler = trace::IndependentSampler{ 42 };
+  auto constexpr samples = 10000;
+  auto cosineSum = 0.0;
+  for (auto i = 0; i < samples; ++i) {
+    auto const direction = pdf.GenerateSample(sampler);
+    EXPECT_NEAR(direction.Length(), 1.0, 1e-9);
+    auto const cosine = lina::dot(direction, normal);
+    EXPECT_GE(cosine, -1e-9);
+    EXPECT_NEAR(pdf.Evaluate(direction), std::max(cosine, 0.0) / std::numbers::pi, 1e-9);
+    cosineSum += cosine;
+  }
+  // the mean cosine of a cosine weighted hemisphere is 2/3
+  EXPECT_NEAR(cosineSum / samples, 2.0 / 3.0, 0.01);
+  EXPECT_EQ(pdf.Evaluate(normal * -1.0), 0.0);
+  EXPECT_DOUBLE_EQ(pdf.Evaluate(normal * 3.0), 1.0 / std::numbers::pi);
+}
@@ -0,0 +1,78 @@
+#include "random.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace trace {
+
+// NOLINTBEGIN(readability-magic-numbers)
+auto philox4x32(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key)
+  -> std::array<std::uint32_t, 4>
+{
+  constexpr auto multiplier0 = std::uint64_t{ 0xD2511F53 };
+  constexpr auto multiplier1 = std::uint64_t{ 0xCD9E8D57 };
+  constexpr auto weyl0 = std::uint32_t{ 0x9E3779B9 };
+  constexpr auto weyl1 = std::uint32_t{ 0xBB67AE85 };
+
+  for (auto round = 0; round < 10; ++round) {
+    auto const product0 = multiplier0 * counter[0];
+    auto const product1 = multiplier1 * counter[2];
+    counter = { static_cast<std::uint32_t>(product1 >> 32U) ^ counter[1] ^ key[0],
+      static_cast<std::uint32_t>(product1),
+      static_cast<std::uint32_t>(product0 >> 32U) ^ counter[3] ^ key[1],
+      static_cast<std::uint32_t>(product0) };
+    key[0] += weyl0;
+    key[1] += weyl1;
+  }
+  return counter;
+}
+
+auto philoxUniforms(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key, std::span<double> output)
+  -> void
+{
+  constexpr auto multiplier0 = std::uint64_t{ 0xD2511F53 };
+  constexpr auto multiplier1 = std::uint64_t{ 0xCD9E8D57 };
+  constexpr auto weyl0 = std::uint32_t{ 0x9E3779B9 };
+  constexpr auto weyl1 = std::uint32_t{ 0xBB67AE85 };
+
+  for (auto offset = std::size_t{ 0 }; offset < output.size(); offset += 2 * philoxLanes) {
+    auto c0 = std::array<std::uint32_t, philoxLanes>{};
+    auto c1 = std::array<std::uint32_t, philoxLanes>{};
+    auto c2 = std::array<std::uint32_t, philoxLanes>{};
+    auto c3 = std::array<std::uint32_t, philoxLanes>{};
+    for (auto lane = std::size_t{ 0 }; lane < philoxLanes; ++lane) {
+      c0[lane] = counter[0];
+      c1[lane] = counter[1];
+      c2[lane] = counter[2];
+      c3[lane] = counter[3] + static_cast<std::uint32_t>((offset / 2) + lane);
+    }
+    auto roundKey = key;
+    for (auto round = 0; round < 10; ++round) {
+      for (auto lane = std::size_t{ 0 }; lane < philoxLanes; ++lane) {
+        auto const product0 = multiplier0 * c0[lane];
+        auto const product1 = multiplier1 * c2[lane];
+        c0[lane] = static_cast<std::uint32_t>(product1 >> 32U) ^ c1[lane] ^ roundKey[0];
+        c1[lane] = static_cast<std::uint32_t>(product1);
+        c2[lane] = static_cast<std::uint32_t>(product0 >> 32U) ^ c3[lane] ^ roundKey[1];
+        c3[lane] = static_cast<std::uint32_t>(product0);
+      }
+      roundKey[0] += weyl0;
+      roundKey[1] += weyl1;
+    }
+    for (auto lane = std::size_t{ 0 }; lane < philoxLanes; ++lane) {
+      output[offset + (2 * lane)] = uniformFromBits((std::uint64_t{ c0[lane] } << 32U) | c1[lane]);
+      output[offset + (2 * lane) + 1] = uniformFromBits((std::uint64_t{ c2[lane] } << 32U) | c3[lane]);
+    }
+  }
+}
+
+auto uniformFromBits(std::uint64_t bits) -> double
+{
+  return std::bit_cast<double>((bits >> 12U) | 0x3FF0000000000000ULL) - 1.0;
+}
+// NOLINTEND(readability-magic-numbers)
+
+}// namespace trace
@@ -0,0 +1,33 @@
+#ifndef RAY_BUSTER_LIB_TRACE_RANDOM_H_
+#define RAY_BUSTER_LIB_TRACE_RANDOM_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace trace {
+
+// Philox4x32-10 from Salmon et al. "Parallel Random Numbers: As Easy as 1, 2, 3" (2011)
+// A counter based generator: the output is a pure function of the counter and the key, so any number of the stream
+// can be produced directly, without generating the ones before it.
+[[nodiscard]] auto philox4x32(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key)
+  -> std::array<std::uint32_t, 4>;
+
+// The number of Philox evaluations philoxUniforms runs side by side.
+constexpr auto philoxLanes = std::size_t{ 4 };
+
+// Fill the output with uniform doubles in [0, 1), two from each Philox output, for the counters
+// { counter[0], counter[1], counter[2], counter[3] + i } with i = 0, 1, ...
+// The output size has to be a multiple of 2 * philoxLanes. The lanes are independent of each other and laid out as
+// structure of arrays, so the compiler can run them in SIMD registers.
+auto philoxUniforms(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key, std::span<double> output)
+  -> void;
+
+// The top 52 bits as the mantissa of a double in [1, 2), minus one. Cheaper than converting the integer to a double
+// and scaling it, at the price of the lowest bit of precision.
+[[nodiscard]] auto uniformFromBits(std::uint64_t bits) -> double;
+
+}// namespace trace
+
+#endif
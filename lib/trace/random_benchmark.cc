@@ -0,0 +1,74 @@
+#include "lib/trace/random.h"
+#include "lib/trace/sampler.h"
+
+#include <array>
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+// What every sampling routine used to do: build a distribution and draw from std::mt19937.
+static void mt19937UniformDistribution(benchmark::State& state)
+{
+  auto generator = std::mt19937{ 42 };
+  for (auto _ : state) {
+    auto distribution = std::uniform_real_distribution(0.0, 1.0);
+    benchmark::DoNotOptimize(distribution(generator));
+  }
+}
+BENCHMARK(mt19937UniformDistribution);
+
+static void philox4x32(benchmark::State& state)
+{
+  auto counter = std::uint32_t{ 0 };
+  for (auto _ : state) { benchmark::DoNotOptimize(trace::philox4x32({ counter++, 0, 0, 0 }, { 42, 54 })); }
+}
+BENCHMARK(philox4x32);
+
+// The same amount of numbers as philoxUniformsBulk, one Philox evaluation at a time, with the same conversion.
+static void philoxUniformsScalar(benchmark::State& state)
+{
+  auto counter = std::uint32_t{ 0 };
+  auto output = std::array<double, 4 * trace::philoxLanes>{};
+  for (auto _ : state) {
+    for (auto i = std::size_t{ 0 }; i < output.size(); i += 2) {
+      auto const bits = trace::philox4x32({ 0, 0, 0, counter++ }, { 42, 54 });
+      output.at(i) = trace::uniformFromBits((std::uint64_t{ bits[0] } << 32U) | bits[1]);
+      output.at(i + 1) = trace::uniformFromBits((std::uint64_t{ bits[2] } << 32U) | bits[3]);
+    }
+    benchmark::DoNotOptimize(output);
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(output.size()));
+}
+BENCHMARK(philoxUniformsScalar);
+
+static void philoxUniformsBulk(benchmark::State& state)
+{
+  auto counter = std::uint32_t{ 0 };
+  auto output = std::array<double, 4 * trace::philoxLanes>{};
+  for (auto _ : state) {
+    trace::philoxUniforms({ 0, 0, 0, counter }, { 42, 54 }, output);
+    counter += static_cast<std::uint32_t>(output.size() / 2);
+    benchmark::DoNotOptimize(output);
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(output.size()));
+}
+BENCHMARK(philoxUniformsBulk);
+
+// A camera ray and a few bounces worth of decisions per path, as the renderer uses the samplers.
+static void samplePaths(benchmark::State& state, trace::SamplerType type)
+{
+  auto sampler = trace::buildSampler(type, 42, 512, 512, 64);
+  auto sample = std::uint32_t{ 0 };
+  for (auto _ : state) {
+    sampler->StartPath(0, sample++);
+    for (auto bounce = 0; bounce < 4; ++bounce) {
+      for (auto dimension = 0; dimension < 4; ++dimension) { benchmark::DoNotOptimize(sampler->Uniform()); }
+      sampler->NextBounce();
+    }
+  }
+}
+BENCHMARK_CAPTURE(samplePaths, independent, trace::SamplerType::Independent);
+BENCHMARK_CAPTURE(samplePaths, sobol, trace::SamplerType::Sobol);
+BENCHMARK_CAPTURE(samplePaths, zsobol, trace::SamplerType::ZSobol);
+BENCHMARK_CAPTURE(samplePaths, cmj, trace::SamplerType::Cmj);
@@ -0,0 +1,39 @@
+#include "lib/trace/random.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <gtest/gtest.h>
+
+// known answers from the Random123 distribution (kat_vectors)
+TEST(philox4x32, knownAnswers)
+{
+  EXPECT_EQ(trace::philox4x32({ 0, 0, 0, 0 }, { 0, 0 }),
+    (std::array<std::uint32_t, 4>{ 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 }));
+  EXPECT_EQ(trace::philox4x32({ 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, { 0xffffffff, 0xffffffff }),
+    (std::array<std::uint32_t, 4>{ 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd }));
+  EXPECT_EQ(trace::philox4x32({ 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 }),
+    (std::array<std::uint32_t, 4>{ 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 }));
+}
+
+TEST(philoxUniforms, matchesTheScalarPhilox)
+{
+  auto constexpr counter = std::array<std::uint32_t, 4>{ 7, 1, 3, 100 };
+  auto constexpr key = std::array<std::uint32_t, 2>{ 42, 54 };
+  auto output = std::array<double, 4 * trace::philoxLanes>{};
+  trace::philoxUniforms(counter, key, output);
+  for (auto i = std::size_t{ 0 }; i < output.size() / 2; ++i) {
+    auto const bits = trace::philox4x32(
+      { counter[0], counter[1], counter[2], counter[3] + static_cast<std::uint32_t>(i) }, key);
+    EXPECT_EQ(output.at(2 * i), trace::uniformFromBits((std::uint64_t{ bits[0] } << 32U) | bits[1]));
+    EXPECT_EQ(output.at((2 * i) + 1), trace::uniformFromBits((std::uint64_t{ bits[2] } << 32U) | bits[3]));
+  }
+}
+
+TEST(uniformFromBits, coversTheUnitInterval)
+{
+  EXPECT_EQ(trace::uniformFromBits(0), 0.0);
+  EXPECT_EQ(trace::uniformFromBits(std::uint64_t{ 1 } << 63U), 0.5);
+  EXPECT_LT(trace::uniformFromBits(~std::uint64_t{ 0 }), 1.0);
+  EXPECT_EQ(trace::uniformFromBits(~std::uint64_t{ 0 }), 1.0 - 0x1.0p-52);
+}
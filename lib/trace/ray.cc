@@ -4,10 +4,16 @@
 
 namespace trace {
 
-Ray::Ray() : source_{ lina::Vec3{ 0.0, 0.0, 0.0 } }, dir_{ lina::Vec3{ 0.0, 1.0, 0.0 } } {}
-Ray::Ray(lina::Vec3 source, lina::Vec3 direction) : source_{ source }, dir_{ lina::unit(direction) } {}
+Ray::Ray()
+  : source_{ lina::Vec3{ 0.0, 0.0, 0.0 } }, dir_{ lina::Vec3{ 0.0, 1.0, 0.0 } },
+    inverseDir_{ 1.0 / dir_[0], 1.0 / dir_[1], 1.0 / dir_[2] }
+{}
+Ray::Ray(lina::Vec3 source, lina::Vec3 direction)
+  : source_{ source }, dir_{ lina::unit(direction) }, inverseDir_{ 1.0 / dir_[0], 1.0 / dir_[1], 1.0 / dir_[2] }
+{}
 
 auto Ray::Source() const -> lina::Vec3 const& { return source_; }
 auto Ray::Direction() const -> lina::Vec3 const& { return dir_; }
+auto Ray::InverseDirection() const -> lina::Vec3 const& { return inverseDir_; }
 
 }// namespace trace
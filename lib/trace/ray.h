@@ -13,10 +13,14 @@ public:
 
   [[nodiscard]] auto Source() const -> lina::Vec3 const&;
   [[nodiscard]] auto Direction() const -> lina::Vec3 const&;
+  // Component wise reciprocal of the direction, precomputed for the slab tests against bounding boxes.
+  // Zero components produce signed infinities, which the slab test handles on its own.
+  [[nodiscard]] auto InverseDirection() const -> lina::Vec3 const&;
 
 private:
   lina::Vec3 source_;
   lina::Vec3 dir_;
+  lina::Vec3 inverseDir_;
 };
 
 }// namespace trace
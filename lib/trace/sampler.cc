@@ -0,0 +1,500 @@
+#include "sampler.h"
+
+#include "lib/trace/random.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+
+namespace trace {
+
+auto Sampler::Uniform2D() -> std::array<double, 2>
+{
+  auto const u = Uniform();
+  auto const v = Uniform();
+  return { u, v };
+}
+
+IndependentSampler::IndependentSampler(std::uint64_t seed)
+  : key_{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32U) }
+{}
+
+// The buffer is only refilled when the numbers are needed, a bounce that ends on the sky never pays for it.
+auto IndependentSampler::StartPath(std::uint64_t pixel, std::uint32_t sample) -> void
+{
+  pixel_ = pixel;
+  sample_ = sample;
+  bounce_ = 0;
+  block_ = 0;
+  next_ = bufferSize;
+}
+
+auto IndependentSampler::NextBounce() -> void
+{
+  ++bounce_;
+  block_ = 0;
+  next_ = bufferSize;
+}
+
+auto IndependentSampler::Position() const -> SamplerPosition
+{
+  return SamplerPosition{ pixel_, sample_, 0, bounce_ };
+}
+
+auto IndependentSampler::Resume(SamplerPosition const& position) -> void
+{
+  pixel_ = position.path;
+  sample_ = position.sample;
+  bounce_ = position.bounce;
+  block_ = 0;
+  next_ = bufferSize;
+}
+
+auto IndependentSampler::Uniform() -> double
+{
+  if (next_ == bufferSize) { refill(); }
+  return buffer_[next_++];
+}
+
+auto IndependentSampler::refill() -> void
+{
+  philoxUniforms({ static_cast<std::uint32_t>(pixel_), static_cast<std::uint32_t>(pixel_ >> 32U), sample_, block_ },
+    { key_[0], key_[1] ^ bounce_ },
+    buffer_);
+  block_ += static_cast<std::uint32_t>(philoxLanes);
+  next_ = 0;
+}
+
+// NOLINTBEGIN(readability-magic-numbers)
+// Integer hash by Chris Wellons (lowbias32), used to derive the scrambling seeds.
+static auto hash(std::uint32_t value) -> std::uint32_t
+{
+  value ^= value >> 16U;
+  value *= 0x7FEB352DU;
+  value ^= value >> 15U;
+  value *= 0x846CA68BU;
+  value ^= value >> 16U;
+  return value;
+}
+
+static auto hashCombine(std::uint32_t seed, std::uint32_t value) -> std::uint32_t
+{
+  return hash(seed ^ (value + 0x9E3779B9U + (seed << 6U) + (seed >> 2U)));
+}
+
+SobolSampler::SobolSampler(std::uint64_t seed)
+  : key_{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32U) }
+{
+  StartPath(0, 0);
+}
+
+auto SobolSampler::StartPath(std::uint64_t pixel, std::uint32_t sample) -> void
+{
+  pixelSeed_ =
+    philox4x32({ static_cast<std::uint32_t>(pixel), static_cast<std::uint32_t>(pixel >> 32U), 0, 0 }, key_)[0];
+  sample_ = sample;
+  bounce_ = 0;
+  bounceSeed_ = hashCombine(pixelSeed_, bounce_);
+  dimension_ = 0;
+}
+
+auto SobolSampler::NextBounce() -> void
+{
+  ++bounce_;
+  bounceSeed_ = hashCombine(pixelSeed_, bounce_);
+  dimension_ = 0;
+}
+
+auto SobolSampler::Position() const -> SamplerPosition
+{
+  return SamplerPosition{ 0, sample_, pixelSeed_, bounce_ };
+}
+
+auto SobolSampler::Resume(SamplerPosition const& position) -> void
+{
+  pixelSeed_ = position.seed;
+  sample_ = position.sample;
+  bounce_ = position.bounce;
+  bounceSeed_ = hashCombine(pixelSeed_, bounce_);
+  dimension_ = 0;
+}
+
+auto SobolSampler::Uniform() -> double
+{
+  auto const component = dimension_ % 4U;
+  // the four dimensions of a group share the shuffled index, so the point is generated once, at the first of them
+  if (component == 0) {
+    auto const shuffledIndex = nestedUniformScramble(sample_, hashCombine(bounceSeed_, dimension_ / 4U));
+    groupPoint_ = sobol4(shuffledIndex);
+  }
+  auto const value = nestedUniformScramble(groupPoint_.at(component), hashCombine(bounceSeed_, ~dimension_));
+  ++dimension_;
+  return static_cast<double>(value) * 0x1.0p-32;
+}
+
+// The direction numbers are generated from the primitive polynomials and initial values of Joe, Kuo "Constructing
+// Sobol sequences with better two-dimensional projections" (2008). The first dimension is the van der Corput sequence.
+static constexpr auto directionNumbers(std::uint32_t degree, std::uint32_t coefficients, std::array<std::uint32_t, 3> m)
+  -> std::array<std::uint32_t, 32>
+{
+  auto directions = std::array<std::uint32_t, 32>{};
+  auto values = std::array<std::uint32_t, 32>{};
+  for (auto k = std::size_t{ 0 }; k < 32; ++k) {
+    if (degree == 0) {
+      values.at(k) = 1;
+    } else if (k < degree) {
+      values.at(k) = m.at(k);
+    } else {
+      values.at(k) = values.at(k - degree) ^ (values.at(k - degree) << degree);
+      for (auto j = std::size_t{ 1 }; j < degree; ++j) {
+        if (((coefficients >> (degree - 1 - j)) & 1U) != 0U) { values.at(k) ^= values.at(k - j) << j; }
+      }
+    }
+    directions.at(k) = values.at(k) << (31U - k);
+  }
+  return directions;
+}
+
+static constexpr auto sobolDirections = std::array<std::array<std::uint32_t, 32>, 4>{
+  directionNumbers(0, 0, { 0, 0, 0 }),
+  directionNumbers(1, 0, { 1, 0, 0 }),
+  directionNumbers(2, 1, { 1, 3, 0 }),
+  directionNumbers(3, 1, { 1, 3, 1 }),
+};
+
+auto sobol(std::uint32_t index, std::size_t dimension) -> std::uint32_t
+{
+  auto const& directions = sobolDirections.at(dimension);
+  auto result = std::uint32_t{ 0 };
+  for (; index != 0U; index &= index - 1U) { result ^= directions.at(std::countr_zero(index)); }
+  return result;
+}
+
+// The points are linear in the bits of the index, so the point of an index is the XOR of the points of its bytes.
+// Tabulating the points of every byte value at all four positions takes 16 KB and turns the up to 32 XORs per
+// dimension into four lookups.
+static constexpr auto sobolByteTable()
+{
+  auto table = std::array<std::array<std::array<std::uint32_t, 4>, 256>, 4>{};
+  for (auto position = std::size_t{ 0 }; position < 4; ++position) {
+    for (auto byte = std::size_t{ 0 }; byte < 256; ++byte) {
+      for (auto bit = std::size_t{ 0 }; bit < 8; ++bit) {
+        if (((byte >> bit) & 1U) == 0U) { continue; }
+        for (auto dimension = std::size_t{ 0 }; dimension < 4; ++dimension) {
+          table.at(position).at(byte).at(dimension) ^= sobolDirections.at(dimension).at((position * 8) + bit);
+        }
+      }
+    }
+  }
+  return table;
+}
+
+static constexpr auto sobolBytes = sobolByteTable();
+
+auto sobol4(std::uint32_t index) -> std::array<std::uint32_t, 4>
+{
+  auto result = std::array<std::uint32_t, 4>{};
+  for (auto position = std::size_t{ 0 }; position < 4; ++position) {
+    auto const& bytePoint = sobolBytes.at(position).at((index >> (position * 8)) & 0xFFU);
+    for (auto dimension = std::size_t{ 0 }; dimension < 4; ++dimension) {
+      result.at(dimension) ^= bytePoint.at(dimension);
+    }
+  }
+  return result;
+}
+
+static auto reverseBits(std::uint32_t value) -> std::uint32_t
+{
+  value = ((value >> 1U) & 0x55555555U) | ((value & 0x55555555U) << 1U);
+  value = ((value >> 2U) & 0x33333333U) | ((value & 0x33333333U) << 2U);
+  value = ((value >> 4U) & 0x0F0F0F0FU) | ((value & 0x0F0F0F0FU) << 4U);
+  value = ((value >> 8U) & 0x00FF00FFU) | ((value & 0x00FF00FFU) << 8U);
+  return (value >> 16U) | (value << 16U);
+}
+
+// Laine, Karras "Stratified Sampling for Stochastic Transparency" (2011), with the constants improved by Burley.
+// Adding the seed and multiplying by even numbers only ever carries towards the higher bits, so after reversing the
+// bits every bit is only affected by the seed and the bits that were above it.
+auto nestedUniformScramble(std::uint32_t value, std::uint32_t seed) -> std::uint32_t
+{
+  auto reversed = reverseBits(value);
+  reversed += seed;
+  reversed ^= reversed * 0x6C50B47CU;
+  reversed ^= reversed * 0xB82F1E52U;
+  reversed ^= reversed * 0xC7AFE638U;
+  reversed ^= reversed * 0x8D22F6E6U;
+  return reverseBits(reversed);
+}
+static auto spreadBits(std::uint32_t value) -> std::uint32_t
+{
+  value &= 0x0000FFFFU;
+  value = (value ^ (value << 8U)) & 0x00FF00FFU;
+  value = (value ^ (value << 4U)) & 0x0F0F0F0FU;
+  value = (value ^ (value << 2U)) & 0x33333333U;
+  value = (value ^ (value << 1U)) & 0x55555555U;
+  return value;
+}
+
+auto encodeMorton2(std::uint32_t x, std::uint32_t y) -> std::uint32_t { return spreadBits(x) | (spreadBits(y) << 1U); }
+
+ZSobolSampler::ZSobolSampler(std::uint64_t seed,
+  std::size_t imageWidth,
+  std::size_t imageHeight,
+  std::size_t samplesPerPixel)
+  : seed_{ hashCombine(hash(static_cast<std::uint32_t>(seed)), static_cast<std::uint32_t>(seed >> 32U)) },
+    imageWidth_{ imageWidth },
+    log2SamplesPerPixel_{ static_cast<std::uint32_t>(std::bit_width(std::max(samplesPerPixel, std::size_t{ 1 }) - 1)) },
+    base4Digits_{
+      static_cast<std::uint32_t>(std::bit_width(std::max({ imageWidth, imageHeight, std::size_t{ 1 } }) - 1))
+      + ((log2SamplesPerPixel_ + 1) / 2) }
+{
+  StartPath(0, 0);
+}
+
+auto ZSobolSampler::StartPath(std::uint64_t pixel, std::uint32_t sample) -> void
+{
+  auto const x = static_cast<std::uint32_t>(pixel % imageWidth_);
+  auto const y = static_cast<std::uint32_t>(pixel / imageWidth_);
+  auto const samplesPerPixelMask = (std::uint32_t{ 1 } << log2SamplesPerPixel_) - 1;
+  mortonIndex_ = (encodeMorton2(x, y) << log2SamplesPerPixel_) | (sample & samplesPerPixelMask);
+  // the samples past samplesPerPixel would spill into the Morton bits of the other pixels, instead every further
+  // block of samplesPerPixel starts a sequence of its own
+  auto const round = sample >> log2SamplesPerPixel_;
+  roundSeed_ = round == 0 ? seed_ : hashCombine(seed_, round);
+  bounce_ = 0;
+  bounceSeed_ = hashCombine(roundSeed_, bounce_);
+  dimension_ = 0;
+}
+
+auto ZSobolSampler::NextBounce() -> void
+{
+  ++bounce_;
+  bounceSeed_ = hashCombine(roundSeed_, bounce_);
+  dimension_ = 0;
+}
+
+auto ZSobolSampler::Position() const -> SamplerPosition
+{
+  return SamplerPosition{ mortonIndex_, 0, roundSeed_, bounce_ };
+}
+
+auto ZSobolSampler::Resume(SamplerPosition const& position) -> void
+{
+  mortonIndex_ = static_cast<std::uint32_t>(position.path);
+  roundSeed_ = position.seed;
+  bounce_ = position.bounce;
+  bounceSeed_ = hashCombine(roundSeed_, bounce_);
+  dimension_ = 0;
+}
+
+auto ZSobolSampler::Uniform() -> double
+{
+  auto const component = dimension_ % 4U;
+  if (component == 0) { groupPoint_ = sobol4(sampleIndex(hashCombine(bounceSeed_, dimension_ / 4U))); }
+  auto const value = nestedUniformScramble(groupPoint_.at(component), hashCombine(bounceSeed_, ~dimension_));
+  ++dimension_;
+  return static_cast<double>(value) * 0x1.0p-32;
+}
+
+// Every base four digit of the Morton index is permuted by one of the 24 permutations of four elements, chosen by
+// the digits above it. With an odd power of two samples per pixel the last digit is binary, that one is flipped.
+auto ZSobolSampler::sampleIndex(std::uint32_t seed) const -> std::uint32_t
+{
+  static constexpr auto permutations = std::array<std::array<std::uint32_t, 4>, 24>{ { { 0, 1, 2, 3 },
+    { 0, 1, 3, 2 },
+    { 0, 2, 1, 3 },
+    { 0, 2, 3, 1 },
+    { 0, 3, 2, 1 },
+    { 0, 3, 1, 2 },
+    { 1, 0, 2, 3 },
+    { 1, 0, 3, 2 },
+    { 1, 2, 0, 3 },
+    { 1, 2, 3, 0 },
+    { 1, 3, 2, 0 },
+    { 1, 3, 0, 2 },
+    { 2, 1, 0, 3 },
+    { 2, 1, 3, 0 },
+    { 2, 0, 1, 3 },
+    { 2, 0, 3, 1 },
+    { 2, 3, 0, 1 },
+    { 2, 3, 1, 0 },
+    { 3, 1, 2, 0 },
+    { 3, 1, 0, 2 },
+    { 3, 2, 1, 0 },
+    { 3, 2, 0, 1 },
+    { 3, 0, 2, 1 },
+    { 3, 0, 1, 2 } } };
+
+  auto const binaryLastDigit = (log2SamplesPerPixel_ & 1U) != 0U;
+  auto const lastDigit = binaryLastDigit ? 1U : 0U;
+  auto index = std::uint32_t{ 0 };
+  for (auto digitIndex = base4Digits_; digitIndex-- > lastDigit;) {
+    auto const shift = (2 * digitIndex) - lastDigit;
+    if (shift >= 32) { continue; }
+    auto const digit = (mortonIndex_ >> shift) & 3U;
+    auto const higherDigits = shift + 2 >= 32 ? 0U : mortonIndex_ >> (shift + 2);
+    auto const permutation = (hash(higherDigits ^ seed) >> 16U) % 24U;
+    index |= permutations.at(permutation).at(digit) << shift;
+  }
+  if (binaryLastDigit) { index |= (mortonIndex_ & 1U) ^ (hash((mortonIndex_ >> 1U) ^ seed) & 1U); }
+  return index;
+}
+// NOLINTBEGIN(hicpp-signed-bitwise)
+auto permute(std::uint32_t index, std::uint32_t length, std::uint32_t seed) -> std::uint32_t
+{
+  auto mask = length - 1;
+  mask |= mask >> 1U;
+  mask |= mask >> 2U;
+  mask |= mask >> 4U;
+  mask |= mask >> 8U;
+  mask |= mask >> 16U;
+  // cycle walking: the hash permutes [0, mask], repeat it until the result falls into [0, length)
+  do {
+    index ^= seed;
+    index *= 0xE170893DU;
+    index ^= seed >> 16U;
+    index ^= (index & mask) >> 4U;
+    index ^= seed >> 8U;
+    index *= 0x0929EB3FU;
+    index ^= seed >> 23U;
+    index ^= (index & mask) >> 1U;
+    index *= 1U | (seed >> 27U);
+    index *= 0x6935FA69U;
+    index ^= (index & mask) >> 11U;
+    index *= 0x74DCB303U;
+    index ^= (index & mask) >> 2U;
+    index *= 0x9E501CC3U;
+    index ^= (index & mask) >> 2U;
+    index *= 0xC860A3DFU;
+    index &= mask;
+    index ^= index >> 5U;
+  } while (index >= length);
+  return (index + seed) % length;
+}
+
+// Kensler's hash to a [0, 1) jitter.
+static auto randomFraction(std::uint32_t index, std::uint32_t seed) -> double
+{
+  index ^= seed;
+  index ^= index >> 17U;
+  index ^= index >> 10U;
+  index *= 0xB36534E5U;
+  index ^= index >> 12U;
+  index ^= index >> 21U;
+  index *= 0x93FC4795U;
+  index ^= 0xDF6E307FU;
+  index ^= index >> 17U;
+  index *= 1U | (seed >> 18U);
+  return static_cast<double>(index) * 0x1.0p-32;
+}
+// NOLINTEND(hicpp-signed-bitwise)
+
+// The samples are placed on an m x n grid of cells, where every cell is split into n x m sub cells. A sample takes
+// one cell, and within it the sub cell given by the column and row of the cells it shares a row and column with, so
+// the samples are stratified on the grid, and on the sub grid in each dimension separately. The rows and columns are
+// shuffled on their own, which keeps the stratification, and everything is jittered within the sub cells.
+auto cmj(std::uint32_t index, std::uint32_t count, std::uint32_t seed) -> std::array<double, 2>
+{
+  auto const m = std::max(static_cast<std::uint32_t>(std::sqrt(static_cast<double>(count))), 1U);
+  auto const n = (count + m - 1) / m;
+  index = permute(index, count, seed * 0x51633E2DU);
+  auto const column = index % m;
+  auto const row = index / m;
+  auto const subColumn = permute(column, m, seed * 0xA511E9B3U);
+  auto const subRow = permute(row, n, seed * 0x63D83595U);
+  auto const jitterX = randomFraction(index, seed * 0xA399D265U);
+  auto const jitterY = randomFraction(index, seed * 0x711AD6A5U);
+  return { (column + ((subRow + jitterX) / n)) / m, (row + ((subColumn + jitterY) / m)) / n };
+}
+
+CmjSampler::CmjSampler(std::uint64_t seed, std::size_t samplesPerPixel)
+  : key_{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32U) },
+    samplesPerPixel_{ static_cast<std::uint32_t>(std::max(samplesPerPixel, std::size_t{ 1 })) }
+{
+  StartPath(0, 0);
+}
+
+auto CmjSampler::StartPath(std::uint64_t pixel, std::uint32_t sample) -> void
+{
+  pixelSeed_ =
+    philox4x32({ static_cast<std::uint32_t>(pixel), static_cast<std::uint32_t>(pixel >> 32U), 0, 0 }, key_)[0];
+  sample_ = sample;
+  bounce_ = 0;
+  bounceSeed_ = hashCombine(hashCombine(pixelSeed_, sample_ / samplesPerPixel_), bounce_);
+  dimension_ = 0;
+}
+
+auto CmjSampler::NextBounce() -> void
+{
+  ++bounce_;
+  bounceSeed_ = hashCombine(hashCombine(pixelSeed_, sample_ / samplesPerPixel_), bounce_);
+  dimension_ = 0;
+}
+
+auto CmjSampler::Position() const -> SamplerPosition
+{
+  return SamplerPosition{ 0, sample_, pixelSeed_, bounce_ };
+}
+
+auto CmjSampler::Resume(SamplerPosition const& position) -> void
+{
+  pixelSeed_ = position.seed;
+  sample_ = position.sample;
+  bounce_ = position.bounce;
+  bounceSeed_ = hashCombine(hashCombine(pixelSeed_, sample_ / samplesPerPixel_), bounce_);
+  dimension_ = 0;
+}
+
+auto CmjSampler::Uniform() -> double
+{
+  auto const seed = hashCombine(bounceSeed_, dimension_);
+  ++dimension_;
+  auto const index = sample_ % samplesPerPixel_;
+  return (permute(index, samplesPerPixel_, seed) + randomFraction(index, seed)) / samplesPerPixel_;
+}
+
+auto CmjSampler::Uniform2D() -> std::array<double, 2>
+{
+  auto const seed = hashCombine(bounceSeed_, dimension_);
+  dimension_ += 2;
+  return cmj(sample_ % samplesPerPixel_, samplesPerPixel_, seed);
+}
+// NOLINTEND(readability-magic-numbers)
+
+auto buildSampler(SamplerType type,
+  std::uint64_t seed,
+  std::size_t imageWidth,
+  std::size_t imageHeight,
+  std::size_t samplesPerPixel) -> std::unique_ptr<Sampler>
+{
+  switch (type) {
+  case SamplerType::Independent:
+    return std::make_unique<IndependentSampler>(seed);
+  case SamplerType::Sobol:
+    return std::make_unique<SobolSampler>(seed);
+  case SamplerType::ZSobol:
+    return std::make_unique<ZSobolSampler>(seed, imageWidth, imageHeight, samplesPerPixel);
+  case SamplerType::Cmj:
+    return std::make_unique<CmjSampler>(seed, samplesPerPixel);
+  }
+  throw std::logic_error("Unhandled sampler type.");
+}
+
+auto samplerTypeFromName(std::string_view name) -> SamplerType
+{
+  if (name == "independent") { return SamplerType::Independent; }
+  if (name == "sobol") { return SamplerType::Sobol; }
+  if (name == "zsobol") { return SamplerType::ZSobol; }
+  if (name == "cmj") { return SamplerType::Cmj; }
+  throw std::invalid_argument(
+    std::format("Unknown sampler: '{}'. Expected one of: independent, sobol, zsobol, cmj", name));
+}
+
+}// namespace trace
@@ -0,0 +1,223 @@
+#ifndef RAY_BUSTER_LIB_TRACE_SAMPLER_H_
+#define RAY_BUSTER_LIB_TRACE_SAMPLER_H_
+
+#include "lib/trace/random.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace trace {
+
+// The start of a bounce of a path, as far as a sampler is concerned. Each sampler stores what it derived from the
+// pixel and the sample in the fields it needs, so continuing the path costs nothing, and the values only mean
+// something to the kind of sampler that took the position.
+struct SamplerPosition
+{
+  std::uint64_t path = 0;
+  std::uint32_t sample = 0;
+  std::uint32_t seed = 0;
+  std::uint32_t bounce = 0;
+};
+
+// Source of the uniform numbers for every sampling decision of a path.
+// A path is identified by its pixel and sample index, and is split into bounces, the first one being the camera ray.
+// Within a bounce every call to Uniform is a new dimension, so the same decision of the same bounce always gets the
+// same dimension, which is what lets the low discrepancy samplers stratify across the samples of a pixel.
+class Sampler
+{
+public:
+  Sampler() = default;
+  Sampler(Sampler const&) = default;
+  Sampler(Sampler&&) = default;
+  auto operator=(Sampler const&) -> Sampler& = default;
+  auto operator=(Sampler&&) -> Sampler& = default;
+  virtual ~Sampler() = default;
+
+  // Switch to the first bounce (the camera ray) of the given sample.
+  virtual auto StartPath(std::uint64_t pixel, std::uint32_t sample) -> void = 0;
+  // Switch to the next bounce of the current sample.
+  virtual auto NextBounce() -> void = 0;
+  // The current bounce of the current sample. Resume switches back to its start, the same as StartPath followed by as
+  // many NextBounce calls, so the paths traced together can take turns on the same sampler.
+  [[nodiscard]] virtual auto Position() const -> SamplerPosition = 0;
+  virtual auto Resume(SamplerPosition const& position) -> void = 0;
+  // The next dimension of the current bounce, uniformly distributed in [0, 1).
+  [[nodiscard]] virtual auto Uniform() -> double = 0;
+  // The next two dimensions, for decisions that use them together as a point of the unit square, so samplers that
+  // stratify the pairs of dimensions jointly can do so. By default it is just two calls to Uniform.
+  [[nodiscard]] virtual auto Uniform2D() -> std::array<double, 2>;
+};
+
+// Independent pseudo random numbers.
+// The numbers of a (pixel, sample, bounce) triple are the Philox outputs for the counters made up of the pixel, the
+// sample and the position of the number, keyed by the render seed and the bounce. So the numbers used by a given
+// sample depend only on where the sample is, and not on which thread traced it, or on how many numbers the other
+// samples used before it.
+// Each sampler belongs to a single thread and keeps a small buffer of numbers, which is refilled in bulk with
+// philoxUniforms once it runs out.
+class IndependentSampler : public Sampler
+{
+public:
+  explicit IndependentSampler(std::uint64_t seed);
+  IndependentSampler(IndependentSampler const&) = default;
+  IndependentSampler(IndependentSampler&&) = default;
+  auto operator=(IndependentSampler const&) -> IndependentSampler& = default;
+  auto operator=(IndependentSampler&&) -> IndependentSampler& = default;
+  ~IndependentSampler() override = default;
+
+  auto StartPath(std::uint64_t pixel, std::uint32_t sample) -> void override;
+  auto NextBounce() -> void override;
+  [[nodiscard]] auto Position() const -> SamplerPosition override;
+  auto Resume(SamplerPosition const& position) -> void override;
+  [[nodiscard]] auto Uniform() -> double override;
+
+private:
+  static constexpr auto bufferSize = 2 * philoxLanes;
+
+  auto refill() -> void;
+
+  std::array<std::uint32_t, 2> key_;
+  std::uint64_t pixel_ = 0;
+  std::uint32_t sample_ = 0;
+  std::uint32_t bounce_ = 0;
+  std::uint32_t block_ = 0;
+  std::size_t next_ = bufferSize;
+  std::array<double, bufferSize> buffer_{};
+};
+
+// Owen scrambled Sobol points, following Burley "Practical Hash-based Owen Scrambling" (2020).
+// The dimensions are taken in groups of four from the first four Sobol dimensions. Every group shuffles the sample
+// index with its own seed, so the groups are decorrelated from each other, while the four dimensions inside a group
+// are stratified jointly. Every pixel uses different scrambling seeds, which turns the structured aliasing of plain
+// Sobol points into noise.
+class SobolSampler : public Sampler
+{
+public:
+  explicit SobolSampler(std::uint64_t seed);
+  SobolSampler(SobolSampler const&) = default;
+  SobolSampler(SobolSampler&&) = default;
+  auto operator=(SobolSampler const&) -> SobolSampler& = default;
+  auto operator=(SobolSampler&&) -> SobolSampler& = default;
+  ~SobolSampler() override = default;
+
+  auto StartPath(std::uint64_t pixel, std::uint32_t sample) -> void override;
+  auto NextBounce() -> void override;
+  [[nodiscard]] auto Position() const -> SamplerPosition override;
+  auto Resume(SamplerPosition const& position) -> void override;
+  [[nodiscard]] auto Uniform() -> double override;
+
+private:
+  std::array<std::uint32_t, 2> key_;
+  std::uint32_t pixelSeed_ = 0;
+  std::uint32_t sample_ = 0;
+  std::uint32_t bounce_ = 0;
+  std::uint32_t bounceSeed_ = 0;
+  std::uint32_t dimension_ = 0;
+  std::array<std::uint32_t, 4> groupPoint_{};
+};
+
+// Owen scrambled Sobol points distributed over the pixels as blue noise, the Z-sampler of Ahmed, Wonka "Screen-Space
+// Blue-Noise Diffusion of Monte Carlo Sampling Error via Hierarchical Ordering of Pixels" (2020), in the form pbrt-v4
+// implements it.
+// The pixels are ordered along a Morton curve and each of them takes the next block of samplesPerPixel points from a
+// single sequence, scrambled the same way everywhere. Neighbouring pixels split the strata of a larger block of the
+// sequence between each other, so their errors tend to cancel out, which moves the error into high frequencies.
+// The base four digits of the Morton index are randomly permuted, to break up the regular structure of the curve.
+// The sample index has 32 bits, so the image area times the samples per pixel (both rounded up to powers of two)
+// should stay below 2^32, beyond that the pixels start sharing samples.
+// Samples past samplesPerPixel, as taken by the progressive renders, start a new, differently scrambled sequence for
+// every further block of samplesPerPixel.
+class ZSobolSampler : public Sampler
+{
+public:
+  ZSobolSampler(std::uint64_t seed, std::size_t imageWidth, std::size_t imageHeight, std::size_t samplesPerPixel);
+  ZSobolSampler(ZSobolSampler const&) = default;
+  ZSobolSampler(ZSobolSampler&&) = default;
+  auto operator=(ZSobolSampler const&) -> ZSobolSampler& = default;
+  auto operator=(ZSobolSampler&&) -> ZSobolSampler& = default;
+  ~ZSobolSampler() override = default;
+
+  auto StartPath(std::uint64_t pixel, std::uint32_t sample) -> void override;
+  auto NextBounce() -> void override;
+  [[nodiscard]] auto Position() const -> SamplerPosition override;
+  auto Resume(SamplerPosition const& position) -> void override;
+  [[nodiscard]] auto Uniform() -> double override;
+
+private:
+  [[nodiscard]] auto sampleIndex(std::uint32_t seed) const -> std::uint32_t;
+
+  std::uint32_t seed_;
+  std::size_t imageWidth_;
+  std::uint32_t log2SamplesPerPixel_;
+  std::uint32_t base4Digits_;
+  std::uint32_t mortonIndex_ = 0;
+  std::uint32_t roundSeed_ = 0;
+  std::uint32_t bounce_ = 0;
+  std::uint32_t bounceSeed_ = 0;
+  std::uint32_t dimension_ = 0;
+  std::array<std::uint32_t, 4> groupPoint_{};
+};
+
+// Correlated multi-jittered sampling from Kensler "Correlated Multi-Jittered Sampling" (2013).
+// Every pair of dimensions requested through Uniform2D is a multi-jittered pattern over the samples of the pixel: the
+// samples are stratified on a grid of about sqrt(samplesPerPixel) x sqrt(samplesPerPixel) cells, and also in each
+// of the two dimensions on their own. Unlike the Sobol points this works for any sample count, not just the powers of
+// two. Single dimensions are stratified jittered samples.
+// Samples past samplesPerPixel start a new, differently permuted pattern.
+class CmjSampler : public Sampler
+{
+public:
+  CmjSampler(std::uint64_t seed, std::size_t samplesPerPixel);
+  CmjSampler(CmjSampler const&) = default;
+  CmjSampler(CmjSampler&&) = default;
+  auto operator=(CmjSampler const&) -> CmjSampler& = default;
+  auto operator=(CmjSampler&&) -> CmjSampler& = default;
+  ~CmjSampler() override = default;
+
+  auto StartPath(std::uint64_t pixel, std::uint32_t sample) -> void override;
+  auto NextBounce() -> void override;
+  [[nodiscard]] auto Position() const -> SamplerPosition override;
+  auto Resume(SamplerPosition const& position) -> void override;
+  [[nodiscard]] auto Uniform() -> double override;
+  [[nodiscard]] auto Uniform2D() -> std::array<double, 2> override;
+
+private:
+  std::array<std::uint32_t, 2> key_;
+  std::uint32_t samplesPerPixel_;
+  std::uint32_t pixelSeed_ = 0;
+  std::uint32_t sample_ = 0;
+  std::uint32_t bounce_ = 0;
+  std::uint32_t bounceSeed_ = 0;
+  std::uint32_t dimension_ = 0;
+};
+
+enum class SamplerType { Independent, Sobol, ZSobol, Cmj };
+
+// The image size and the samples per pixel are only used by the samplers that spread their points over the pixels.
+[[nodiscard]] auto buildSampler(SamplerType type,
+  std::uint64_t seed,
+  std::size_t imageWidth,
+  std::size_t imageHeight,
+  std::size_t samplesPerPixel) -> std::unique_ptr<Sampler>;
+// Throws std::invalid_argument for unknown names.
+[[nodiscard]] auto samplerTypeFromName(std::string_view name) -> SamplerType;
+
+// The value of the index-th Sobol point in the given dimension as a 0.32 fixed point number, for dimension < 4.
+[[nodiscard]] auto sobol(std::uint32_t index, std::size_t dimension) -> std::uint32_t;
+// All four dimensions of the index-th Sobol point at once.
+[[nodiscard]] auto sobol4(std::uint32_t index) -> std::array<std::uint32_t, 4>;
+// Owen scrambling of a 0.32 fixed point number: every bit is flipped depending on the seed and all the bits above it.
+[[nodiscard]] auto nestedUniformScramble(std::uint32_t value, std::uint32_t seed) -> std::uint32_t;
+// Kensler's hash based permutation: the index-th element of a random permutation of [0, length), for index < length.
+[[nodiscard]] auto permute(std::uint32_t index, std::uint32_t length, std::uint32_t seed) -> std::uint32_t;
+// The index-th sample of a correlated multi-jittered pattern of count samples, for index < count.
+[[nodiscard]] auto cmj(std::uint32_t index, std::uint32_t count, std::uint32_t seed) -> std::array<double, 2>;
+// Interleave the bits of the coordinates, x taking the even bits. Both have to fit into 16 bits.
+[[nodiscard]] auto encodeMorton2(std::uint32_t x, std::uint32_t y) -> std::uint32_t;
+
+}// namespace trace
+
+#endif
@@ -0,0 +1,351 @@
+#include "lib/trace/sampler.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Every elementary interval of volume 1/n has to hold exactly one of the n points.
+static auto isZeroTwoNet(std::vector<std::pair<double, double>> const& points) -> bool
+{
+  auto const count = points.size();
+  for (auto xCells = std::size_t{ 1 }; xCells <= count; xCells *= 2) {
+    auto const yCells = count / xCells;
+    auto cells = std::set<std::pair<std::size_t, std::size_t>>{};
+    for (auto const& [x, y] : points) {
+      cells.emplace(static_cast<std::size_t>(x * static_cast<double>(xCells)),
+        static_cast<std::size_t>(y * static_cast<double>(yCells)));
+    }
+    if (cells.size() != count) { return false; }
+  }
+  return true;
+}
+
+TEST(sobol, firstPoints)
+{
+  auto const expectedFirst = std::vector<std::uint32_t>{ 0x00000000, 0x80000000, 0x40000000, 0xC0000000 };
+  auto const expectedSecond = std::vector<std::uint32_t>{ 0x00000000, 0x80000000, 0xC0000000, 0x40000000 };
+  for (auto index = std::uint32_t{ 0 }; index < 4; ++index) {
+    EXPECT_EQ(trace::sobol(index, 0), expectedFirst[index]);
+    EXPECT_EQ(trace::sobol(index, 1), expectedSecond[index]);
+  }
+}
+
+TEST(sobol, allDimensionsAtOnceMatchTheSingleOnes)
+{
+  for (auto const index : { 0U, 1U, 2U, 1000U, 0xFFFFFFFFU }) {
+    auto const point = trace::sobol4(index);
+    for (auto dimension = std::size_t{ 0 }; dimension < 4; ++dimension) {
+      EXPECT_EQ(point.at(dimension), trace::sobol(index, dimension));
+    }
+  }
+}
+
+TEST(sobol, firstTwoDimensionsFormANet)
+{
+  auto points = std::vector<std::pair<double, double>>{};
+  for (auto index = std::uint32_t{ 0 }; index < 256; ++index) {
+    points.emplace_back(trace::sobol(index, 0) * 0x1.0p-32, trace::sobol(index, 1) * 0x1.0p-32);
+  }
+  EXPECT_TRUE(isZeroTwoNet(points));
+}
+
+TEST(nestedUniformScramble, keepsTheStratificationOfTheHigherBits)
+{
+  // values sharing the top bits have to keep sharing (different) top bits
+  for (auto const seed : { 0U, 1U, 0xDEADBEEFU }) {
+    auto firstHalf = std::set<std::uint32_t>{};
+    auto topQuarters = std::set<std::uint32_t>{};
+    for (auto quarter = std::uint32_t{ 0 }; quarter < 4; ++quarter) {
+      auto const scrambled = trace::nestedUniformScramble(quarter << 30U, seed);
+      topQuarters.emplace(scrambled >> 30U);
+      firstHalf.emplace(trace::nestedUniformScramble((quarter & 1U) << 31U, seed) >> 31U);
+    }
+    EXPECT_EQ(topQuarters.size(), 4);
+    EXPECT_EQ(firstHalf.size(), 2);
+  }
+}
+
+TEST(SobolSampler, samplesOfAPixelAreStratifiedInTheFirstTwoDimensions)
+{
+  auto sampler = trace::SobolSampler{ 42 };
+  for (auto const pixel : { 0U, 17U, 123456U }) {
+    for (auto bounce = 0; bounce < 3; ++bounce) {
+      auto points = std::vector<std::pair<double, double>>{};
+      for (auto sample = std::uint32_t{ 0 }; sample < 256; ++sample) {
+        sampler.StartPath(pixel, sample);
+        for (auto i = 0; i < bounce; ++i) { sampler.NextBounce(); }
+        auto const x = sampler.Uniform();
+        auto const y = sampler.Uniform();
+        points.emplace_back(x, y);
+      }
+      EXPECT_TRUE(isZeroTwoNet(points)) << "pixel: " << pixel << " bounce: " << bounce;
+    }
+  }
+}
+
+TEST(SobolSampler, pixelsAreScrambledDifferently)
+{
+  auto sampler = trace::SobolSampler{ 42 };
+  sampler.StartPath(0, 0);
+  auto const first = sampler.Uniform();
+  sampler.StartPath(1, 0);
+  EXPECT_NE(sampler.Uniform(), first);
+}
+
+TEST(SobolSampler, higherDimensionsAreUniform)
+{
+  auto sampler = trace::SobolSampler{ 42 };
+  auto constexpr samples = 4096;
+  for (auto dimension = 0; dimension < 12; ++dimension) {
+    auto sum = 0.0;
+    for (auto sample = std::uint32_t{ 0 }; sample < samples; ++sample) {
+      sampler.StartPath(7, sample);
+      auto value = 0.0;
+      for (auto i = 0; i <= dimension; ++i) { value = sampler.Uniform(); }
+      ASSERT_GE(value, 0.0);
+      ASSERT_LT(value, 1.0);
+      sum += value;
+    }
+    EXPECT_NEAR(sum / samples, 0.5, 0.01) << "dimension: " << dimension;
+  }
+}
+
+TEST(encodeMorton2, interleavesTheBits)
+{
+  EXPECT_EQ(trace::encodeMorton2(0, 0), 0U);
+  EXPECT_EQ(trace::encodeMorton2(1, 0), 1U);
+  EXPECT_EQ(trace::encodeMorton2(0, 1), 2U);
+  EXPECT_EQ(trace::encodeMorton2(3, 3), 15U);
+  EXPECT_EQ(trace::encodeMorton2(0xFFFF, 0), 0x55555555U);
+  EXPECT_EQ(trace::encodeMorton2(0, 0xFFFF), 0xAAAAAAAAU);
+}
+
+TEST(ZSobolSampler, samplesOfAPixelAreStratifiedInTheFirstTwoDimensions)
+{
+  // both an even and an odd power of two samples per pixel
+  for (auto const samplesPerPixel : { 256U, 128U }) {
+    auto sampler = trace::ZSobolSampler{ 42, 64, 48, samplesPerPixel };
+    for (auto const pixel : { 0U, 17U, 3071U }) {
+      auto points = std::vector<std::pair<double, double>>{};
+      for (auto sample = std::uint32_t{ 0 }; sample < samplesPerPixel; ++sample) {
+        sampler.StartPath(pixel, sample);
+        sampler.NextBounce();
+        auto const x = sampler.Uniform();
+        auto const y = sampler.Uniform();
+        points.emplace_back(x, y);
+      }
+      EXPECT_TRUE(isZeroTwoNet(points)) << "pixel: " << pixel << " samples: " << samplesPerPixel;
+    }
+  }
+}
+
+// Estimate the integral of f(u) = u over [0, 1) in every pixel with one sample, and compare the variance of the error
+// of single pixels to the variance of the error averaged over 2x2 blocks of pixels. For independent errors averaging
+// four pixels divides the variance by four, blue noise errors cancel out a lot more.
+static auto blockVarianceRatio(trace::Sampler& sampler, std::size_t imageSize) -> double
+{
+  auto errors = std::vector<double>(imageSize * imageSize);
+  for (auto pixel = std::size_t{ 0 }; pixel < errors.size(); ++pixel) {
+    sampler.StartPath(pixel, 0);
+    errors.at(pixel) = sampler.Uniform() - 0.5;
+  }
+  auto pixelVariance = 0.0;
+  for (auto const error : errors) { pixelVariance += error * error; }
+  pixelVariance /= static_cast<double>(errors.size());
+  auto blockVariance = 0.0;
+  for (auto y = std::size_t{ 0 }; y < imageSize; y += 2) {
+    for (auto x = std::size_t{ 0 }; x < imageSize; x += 2) {
+      auto const blockError = (errors.at((y * imageSize) + x) + errors.at((y * imageSize) + x + 1)
+                                + errors.at(((y + 1) * imageSize) + x) + errors.at(((y + 1) * imageSize) + x + 1))
+                              / 4.0;
+      blockVariance += blockError * blockError;
+    }
+  }
+  blockVariance /= static_cast<double>(errors.size() / 4);
+  return blockVariance / pixelVariance;
+}
+
+TEST(ZSobolSampler, errorOfNeighbouringPixelsCancelsOut)
+{
+  auto constexpr imageSize = std::size_t{ 64 };
+  auto sobol = trace::SobolSampler{ 42 };
+  EXPECT_NEAR(blockVarianceRatio(sobol, imageSize), 0.25, 0.05);
+  auto zSobol = trace::ZSobolSampler{ 42, imageSize, imageSize, 1 };
+  EXPECT_LT(blockVarianceRatio(zSobol, imageSize), 0.1);
+}
+
+// Progressive renders go on past the samples per pixel the sampler was built for.
+TEST(ZSobolSampler, samplesPastTheSamplesPerPixelAreNotSharedWithOtherPixels)
+{
+  auto constexpr imageSize = std::size_t{ 8 };
+  auto constexpr samplesPerPixel = 4U;
+  auto sampler = trace::ZSobolSampler{ 42, imageSize, imageSize, samplesPerPixel };
+  auto points = std::set<std::array<double, 4>>{};
+  for (auto pixel = std::size_t{ 0 }; pixel < imageSize * imageSize; ++pixel) {
+    for (auto sample = std::uint32_t{ 0 }; sample < 16 * samplesPerPixel; ++sample) {
+      sampler.StartPath(pixel, sample);
+      auto point = std::array<double, 4>{};
+      for (auto& coordinate : point) { coordinate = sampler.Uniform(); }
+      points.emplace(point);
+    }
+  }
+  EXPECT_EQ(points.size(), imageSize * imageSize * 16 * samplesPerPixel);
+
+  // and every further block of samples is stratified on its own
+  for (auto const firstSample : { 4U, 60U }) {
+    auto block = std::vector<std::pair<double, double>>{};
+    for (auto sample = firstSample; sample < firstSample + samplesPerPixel; ++sample) {
+      sampler.StartPath(9, sample);
+      auto const x = sampler.Uniform();
+      auto const y = sampler.Uniform();
+      block.emplace_back(x, y);
+    }
+    EXPECT_TRUE(isZeroTwoNet(block)) << "first sample: " << firstSample;
+  }
+}
+
+TEST(permute, isAPermutation)
+{
+  for (auto const length : { 1U, 7U, 64U, 100U }) {
+    auto seen = std::set<std::uint32_t>{};
+    for (auto index = std::uint32_t{ 0 }; index < length; ++index) {
+      seen.emplace(trace::permute(index, length, 1234));
+    }
+    EXPECT_EQ(seen.size(), length);
+    EXPECT_LT(*seen.rbegin(), length);
+  }
+}
+
+// Multi-jittered: one sample in every cell of the grid and in every column and row of the sub grid.
+static auto isMultiJittered(std::vector<std::array<double, 2>> const& points, std::uint32_t m, std::uint32_t n) -> bool
+{
+  auto cells = std::set<std::pair<std::uint32_t, std::uint32_t>>{};
+  auto columns = std::set<std::uint32_t>{};
+  auto rows = std::set<std::uint32_t>{};
+  for (auto const& [x, y] : points) {
+    cells.emplace(static_cast<std::uint32_t>(x * m), static_cast<std::uint32_t>(y * n));
+    columns.emplace(static_cast<std::uint32_t>(x * m * n));
+    rows.emplace(static_cast<std::uint32_t>(y * m * n));
+  }
+  return cells.size() == points.size() && columns.size() == points.size() && rows.size() == points.size();
+}
+
+TEST(CmjSampler, pairsOfDimensionsAreMultiJittered)
+{
+  auto sampler = trace::CmjSampler{ 42, 100 };
+  for (auto const pixel : { 0U, 99U }) {
+    auto pixelPoints = std::vector<std::array<double, 2>>{};
+    auto lensPoints = std::vector<std::array<double, 2>>{};
+    for (auto sample = std::uint32_t{ 0 }; sample < 100; ++sample) {
+      sampler.StartPath(pixel, sample);
+      pixelPoints.emplace_back(sampler.Uniform2D());
+      lensPoints.emplace_back(sampler.Uniform2D());
+    }
+    EXPECT_TRUE(isMultiJittered(pixelPoints, 10, 10));
+    EXPECT_TRUE(isMultiJittered(lensPoints, 10, 10));
+    EXPECT_NE(pixelPoints, lensPoints);
+  }
+}
+
+TEST(CmjSampler, sampleCountsThatAreNotSquares)
+{
+  auto sampler = trace::CmjSampler{ 42, 12 };
+  auto points = std::vector<std::array<double, 2>>{};
+  for (auto sample = std::uint32_t{ 0 }; sample < 12; ++sample) {
+    sampler.StartPath(5, sample);
+    points.emplace_back(sampler.Uniform2D());
+  }
+  EXPECT_TRUE(isMultiJittered(points, 3, 4));
+}
+
+TEST(CmjSampler, singleDimensionsAreStratified)
+{
+  auto sampler = trace::CmjSampler{ 42, 50 };
+  auto strata = std::set<std::uint32_t>{};
+  for (auto sample = std::uint32_t{ 0 }; sample < 50; ++sample) {
+    sampler.StartPath(5, sample);
+    sampler.NextBounce();
+    static_cast<void>(sampler.Uniform2D());
+    strata.emplace(static_cast<std::uint32_t>(sampler.Uniform() * 50));
+  }
+  EXPECT_EQ(strata.size(), 50);
+}
+
+TEST(IndependentSampler, pathsCanBeRegeneratedInAnyOrder)
+{
+  auto sampler = trace::IndependentSampler{ 7 };
+  sampler.StartPath(12, 3);
+  auto const cameraValue = sampler.Uniform();
+  sampler.NextBounce();
+  auto const bounceValue = sampler.Uniform();
+
+  // a different sampler with the same seed, that already went through other paths
+  auto other = trace::IndependentSampler{ 7 };
+  other.StartPath(11, 0);
+  for (auto i = 0; i < 100; ++i) { static_cast<void>(other.Uniform()); }
+  other.StartPath(12, 3);
+  other.NextBounce();
+  EXPECT_EQ(other.Uniform(), bounceValue);
+  other.StartPath(12, 3);
+  EXPECT_EQ(other.Uniform(), cameraValue);
+}
+
+TEST(IndependentSampler, everyKeyHasItsOwnStream)
+{
+  auto sampler = trace::IndependentSampler{ 7 };
+  sampler.StartPath(12, 3);
+  auto const reference = sampler.Uniform();
+
+  sampler.StartPath(13, 3);
+  EXPECT_NE(sampler.Uniform(), reference);
+  sampler.StartPath(12, 4);
+  EXPECT_NE(sampler.Uniform(), reference);
+  sampler.StartPath(12, 3);
+  sampler.NextBounce();
+  EXPECT_NE(sampler.Uniform(), reference);
+  auto otherSeed = trace::IndependentSampler{ 8 };
+  otherSeed.StartPath(12, 3);
+  EXPECT_NE(otherSeed.Uniform(), reference);
+}
+
+TEST(Sampler, resumingAPositionContinuesThePath)
+{
+  for (auto const type : { trace::SamplerType::Independent,
+         trace::SamplerType::Sobol,
+         trace::SamplerType::ZSobol,
+         trace::SamplerType::Cmj }) {
+    auto sampler = trace::buildSampler(type, 7, 16, 16, 64);
+    sampler->StartPath(37, 70);
+    sampler->NextBounce();
+    sampler->NextBounce();
+    auto const position = sampler->Position();
+    auto expected = std::vector<double>{};
+    for (auto i = 0; i < 10; ++i) { expected.push_back(sampler->Uniform()); }
+    sampler->NextBounce();
+    expected.push_back(sampler->Uniform());
+
+    // other paths used the sampler in between
+    sampler->StartPath(38, 1);
+    static_cast<void>(sampler->Uniform());
+    sampler->Resume(position);
+    auto resumed = std::vector<double>{};
+    for (auto i = 0; i < 10; ++i) { resumed.push_back(sampler->Uniform()); }
+    sampler->NextBounce();
+    resumed.push_back(sampler->Uniform());
+    EXPECT_EQ(resumed, expected) << static_cast<int>(type);
+  }
+}
+
+TEST(samplerTypeFromName, knownAndUnknownNames)
+{
+  EXPECT_EQ(trace::samplerTypeFromName("sobol"), trace::SamplerType::Sobol);
+  EXPECT_EQ(trace::samplerTypeFromName("independent"), trace::SamplerType::Independent);
+  EXPECT_EQ(trace::samplerTypeFromName("zsobol"), trace::SamplerType::ZSobol);
+  EXPECT_EQ(trace::samplerTypeFromName("cmj"), trace::SamplerType::Cmj);
+  EXPECT_THROW(static_cast<void>(trace::samplerTypeFromName("halton")), std::invalid_argument);
+}
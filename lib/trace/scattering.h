@@ -13,8 +13,10 @@ struct Scattering
 {
   lina::Vec3 attenuation;
   // In case of metals and dielectrics where the output ray has a near analytic solution, we skip the PDF sampling,
-  // while for other materials PDF functions associated with the material instance will be provided.
+  // while for other materials the PDF to sample the direction from will be provided.
   std::variant<Ray, PDF> type;
+  // Where the rays sampled from the PDF start, the collision point moved off the surface.
+  lina::Vec3 origin;
 };
 
 }// namespace trace
@@ -1,79 +1,91 @@
 #include "util.h"
 
+#include "lib/lina/fast_math.h"
 #include "lib/lina/vec3.h"
+#include "lib/trace/sampler.h"
 
+#include <algorithm>
 #include <cmath>
 #include <numbers>
-#include <random>
 
 namespace trace {
 
-auto randomUniformDouble(std::mt19937& generator, double min, double max) -> double
+auto randomUniformDouble(Sampler& sampler, double min, double max) -> double
 {
-  auto distribution = std::uniform_real_distribution(min, max);
-  return distribution(generator);
+  return min + ((max - min) * sampler.Uniform());
 }
 
-auto randomUniformVec3(std::mt19937& generator, double min, double max) -> lina::Vec3
+auto randomUniformVec3(Sampler& sampler, double min, double max) -> lina::Vec3
 {
-  auto distribution = std::uniform_real_distribution(min, max);
-  return lina::Vec3{ distribution(generator), distribution(generator), distribution(generator) };
+  auto x = randomUniformDouble(sampler, min, max);
+  auto y = randomUniformDouble(sampler, min, max);
+  auto z = randomUniformDouble(sampler, min, max);
+  return lina::Vec3{ x, y, z };
 }
 
 // source: https://karthikkaranth.me/blog/generating-random-points-in-a-sphere/
 // source2: Weisstein, Eric W. "Sphere Point Picking." From MathWorld--A Wolfram Web Resource.
 // https://mathworld.wolfram.com/SpherePointPicking.html
-auto randomOnUnitSphere(std::mt19937& generator) -> lina::Vec3
+// phi is only needed through its sine and cosine, and cos(acos(x)) = x, so there is no need to calculate it.
+auto randomOnUnitSphere(Sampler& sampler) -> lina::Vec3
 {
-  auto u = randomUniformDouble(generator, 0.0, 1.0);
-  auto v = randomUniformDouble(generator, 0.0, 1.0);
-  auto theta = u * 2.0 * std::numbers::pi;
-  auto phi = std::acos(2.0 * v - 1.0);
-  auto r = std::cbrt(randomUniformDouble(generator, 0.0, 1.0));
-  auto sin_theta = std::sin(theta);
-  auto cos_theta = std::cos(theta);
-  auto sin_phi = std::sin(phi);
-  auto cos_phi = std::cos(phi);
-  auto x = r * sin_phi * cos_theta;
-  auto y = r * sin_phi * sin_theta;
+  auto const [u, v] = sampler.Uniform2D();
+  auto const theta = lina::fastSinCos(u * 2.0 * std::numbers::pi);
+  auto cos_phi = 2.0 * v - 1.0;
+  auto sin_phi = std::sqrt(std::max(0.0, 1.0 - cos_phi * cos_phi));
+  auto r = lina::fastCbrt(randomUniformDouble(sampler, 0.0, 1.0));
+  auto x = r * sin_phi * theta.cos;
+  auto y = r * sin_phi * theta.sin;
   auto z = r * cos_phi;
   return lina::Vec3{ x, y, z };
 }
 
 // Given a normal vector it will generate random vectors on a hemisphere whose axis aligns with the
 // given normal.
-auto randomOnUnitHemisphere(std::mt19937& generator, lina::Vec3 const& normal) -> lina::Vec3
+auto randomOnUnitHemisphere(Sampler& sampler, lina::Vec3 const& normal) -> lina::Vec3
 {
   auto onHemisphere = lina::Vec3{};
   auto dotProduct = 0.0;
   // For those rare cases, when the stars align and our random vector just happens
   // to be completely parallel with the normal. In those cases, we just reroll.
   do {
-    onHemisphere = randomOnUnitSphere(generator);
+    onHemisphere = randomOnUnitSphere(sampler);
     dotProduct = lina::dot(onHemisphere, normal);
   } while (dotProduct == 0.0);
   if (dotProduct < 0.0) { return -onHemisphere; }
   return onHemisphere;
 }
 
-auto randomCosineDirection(std::mt19937& generator) -> lina::Vec3
+// Malley's method: uniform points on the unit disk projected up onto the hemisphere are cosine distributed.
+auto randomCosineDirection(Sampler& sampler) -> lina::Vec3
 {
-  auto r1 = randomUniformDouble(generator, 0.0, 1.0);
-  auto r2 = randomUniformDouble(generator, 0.0, 1.0);
-  auto phi = 2.0 * std::numbers::pi * r1;
-  auto x = std::cos(phi) * std::sqrt(r2);
-  auto y = std::sin(phi) * std::sqrt(r2);
-  auto z = std::sqrt(1.0 - r2);
-  return lina::Vec3{ x, y, z };
+  auto const [r1, r2] = sampler.Uniform2D();
+  auto onDisk = mapSquareToDisk(r1, r2);
+  auto z = std::sqrt(std::max(0.0, 1.0 - onDisk[0] * onDisk[0] - onDisk[1] * onDisk[1]));
+  return lina::Vec3{ onDisk[0], onDisk[1], z };
+}
+
+auto randomOnUnitDisk(Sampler& sampler) -> lina::Vec3
+{
+  auto const [u, v] = sampler.Uniform2D();
+  return mapSquareToDisk(u, v);
 }
 
-// source: https://mathworld.wolfram.com/DiskPointPicking.html
-auto randomOnUnitDisk(std::mt19937& generator) -> lina::Vec3
+// Shirley, Chiu "A Low Distortion Map Between Disk and Square" (1997)
+// The square is split into four triangles along its diagonals, and each triangle is mapped onto a quarter of the
+// disk. The angles stay within [-pi/4, pi/4] of the axes, the range where the sine and cosine are the cheapest.
+auto mapSquareToDisk(double u, double v) -> lina::Vec3
 {
-  auto r = randomUniformDouble(generator, 0.0, 1.0);
-  auto theta = randomUniformDouble(generator, 0.0, 2.0 * std::numbers::pi);
-  auto sqrtR = std::sqrt(r);
-  return lina::Vec3{ sqrtR * std::cos(theta), sqrtR * std::sin(theta), 0.0 };
+  auto a = 2.0 * u - 1.0;
+  auto b = 2.0 * v - 1.0;
+  if (a == 0.0 && b == 0.0) { return lina::Vec3{ 0.0, 0.0, 0.0 }; }
+  if (std::fabs(a) > std::fabs(b)) {
+    auto const phi = lina::fastSinCos((std::numbers::pi / 4.0) * (b / a));
+    return lina::Vec3{ a * phi.cos, a * phi.sin, 0.0 };
+  }
+  // the angle is measured from the Y axis, so the sine and cosine swap
+  auto const phi = lina::fastSinCos((std::numbers::pi / 4.0) * (a / b));
+  return lina::Vec3{ b * phi.sin, b * phi.cos, 0.0 };
 }
 
 auto degreesToRadians(double degrees) -> double { return degrees * (std::numbers::pi / 180.0); }
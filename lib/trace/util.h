@@ -2,19 +2,22 @@
 #define RAY_BUSTER_LIB_TRACE_UTIL_H_
 
 #include "lib/lina/vec3.h"
-
-#include <random>
+#include "lib/trace/sampler.h"
 
 namespace trace {
 
-[[nodiscard]] auto randomUniformDouble(std::mt19937& generator, double min = 0.0, double max = 1.0) -> double;
-[[nodiscard]] auto randomUniformVec3(std::mt19937& generator, double min = 0.0, double max = 1.0) -> lina::Vec3;
-[[nodiscard]] auto randomOnUnitSphere(std::mt19937& generator) -> lina::Vec3;
-[[nodiscard]] auto randomOnUnitHemisphere(std::mt19937& generator, lina::Vec3 const& normal) -> lina::Vec3;
-[[nodiscard]] auto randomCosineDirection(std::mt19937& generator) -> lina::Vec3;
+[[nodiscard]] auto randomUniformDouble(Sampler& sampler, double min = 0.0, double max = 1.0) -> double;
+[[nodiscard]] auto randomUniformVec3(Sampler& sampler, double min = 0.0, double max = 1.0) -> lina::Vec3;
+[[nodiscard]] auto randomOnUnitSphere(Sampler& sampler) -> lina::Vec3;
+[[nodiscard]] auto randomOnUnitHemisphere(Sampler& sampler, lina::Vec3 const& normal) -> lina::Vec3;
+[[nodiscard]] auto randomCosineDirection(Sampler& sampler) -> lina::Vec3;
 
 // The first two components of the returned vector hold the result.
-[[nodiscard]] auto randomOnUnitDisk(std::mt19937& generator) -> lina::Vec3;
+[[nodiscard]] auto randomOnUnitDisk(Sampler& sampler) -> lina::Vec3;
+// Map a point of the [0, 1) x [0, 1) square onto the unit disk, uniformly and without tearing apart neighbouring
+// points, so any stratification of the square carries over to the disk.
+// The first two components of the returned vector hold the result.
+[[nodiscard]] auto mapSquareToDisk(double u, double v) -> lina::Vec3;
 
 [[nodiscard]] auto degreesToRadians(double degrees) -> double;
 
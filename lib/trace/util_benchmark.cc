@@ -0,0 +1,25 @@
+#include "lib/trace/sampler.h"
+#include "lib/trace/util.h"
+
+#include <benchmark/benchmark.h>
+
+static void randomOnUnitSphere(benchmark::State& state)
+{
+  auto sampler = trace::IndependentSampler{ 42 };
+  for (auto _ : state) { benchmark::DoNotOptimize(trace::randomOnUnitSphere(sampler)); }
+}
+BENCHMARK(randomOnUnitSphere);
+
+static void randomCosineDirection(benchmark::State& state)
+{
+  auto sampler = trace::IndependentSampler{ 42 };
+  for (auto _ : state) { benchmark::DoNotOptimize(trace::randomCosineDirection(sampler)); }
+}
+BENCHMARK(randomCosineDirection);
+
+static void randomOnUnitDisk(benchmark::State& state)
+{
+  auto sampler = trace::IndependentSampler{ 42 };
+  for (auto _ : state) { benchmark::DoNotOptimize(trace::randomOnUnitDisk(sampler)); }
+}
+BENCHMARK(randomOnUnitDisk);
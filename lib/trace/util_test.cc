@@ -0,0 +1,81 @@
+#include "lib/lina/vec3.h"
+#include "lib/trace/sampler.h"
+#include "lib/trace/util.h"
+
+#include <array>
+#include <cmath>
+#include <gtest/gtest.h>
+
+TEST(mapSquareToDisk, cornersAndEdgesMapOntoTheCircle)
+{
+  auto const points = std::array<std::array<double, 2>, 8>{
+    { { 0.0, 0.0 }, { 1.0, 0.0 }, { 0.0, 1.0 }, { 1.0, 1.0 }, { 0.5, 0.0 }, { 0.0, 0.5 }, { 1.0, 0.3 }, { 0.7, 1.0 } }
+  };
+  for (auto const& [u, v] : points) {
+    auto const onDisk = trace::mapSquareToDisk(u, v);
+    EXPECT_NEAR(std::hypot(onDisk[0], onDisk[1]), 1.0, 1e-12);
+  }
+  auto const center = trace::mapSquareToDisk(0.5, 0.5);
+  EXPECT_DOUBLE_EQ(center[0], 0.0);
+  EXPECT_DOUBLE_EQ(center[1], 0.0);
+}
+
+TEST(mapSquareToDisk, keepsTheAreas)
+{
+  // Equal areas of the square have to end up as equal areas on the disk. Count a grid of points falling into rings
+  // with the same area.
+  auto constexpr rings = 4;
+  auto counts = std::array<int, rings>{};
+  auto constexpr steps = 400;
+  for (auto i = 0; i < steps; ++i) {
+    for (auto j = 0; j < steps; ++j) {
+      auto const onDisk =
+        trace::mapSquareToDisk((static_cast<double>(i) + 0.5) / steps, (static_cast<double>(j) + 0.5) / steps);
+      auto const radiusSquared = onDisk[0] * onDisk[0] + onDisk[1] * onDisk[1];
+      ASSERT_LE(radiusSquared, 1.0);
+      counts.at(static_cast<std::size_t>(radiusSquared * rings)) += 1;
+    }
+  }
+  for (auto const count : counts) { EXPECT_NEAR(count, steps * steps / rings, steps * steps / rings * 0.02); }
+}
+
+TEST(randomCosineDirection, isCosineDistributed)
+{
+  // For a cosine distribution on the hemisphere E[cos(theta)] = 2/3 and E[cos(theta)^2] = 1/2.
+  auto sampler = trace::IndependentSampler{ 42 };
+  auto constexpr samples = 200000;
+  auto sum = 0.0;
+  auto sumSquared = 0.0;
+  for (auto i = 0; i < samples; ++i) {
+    auto const direction = trace::randomCosineDirection(sampler);
+    ASSERT_NEAR(direction.Length(), 1.0, 1e-9);
+    ASSERT_GE(direction[2], 0.0);
+    sum += direction[2];
+    sumSquared += direction[2] * direction[2];
+  }
+  EXPECT_NEAR(sum / samples, 2.0 / 3.0, 0.005);
+  EXPECT_NEAR(sumSquared / samples, 0.5, 0.005);
+}
+
+TEST(randomOnUnitSphere, isUniformInTheUnitBall)
+{
+  // For uniform points in the unit ball E[r^3] = 1/2 and every coordinate averages to 0 with E[x^2] = 1/5.
+  auto sampler = trace::IndependentSampler{ 42 };
+  auto constexpr samples = 200000;
+  auto sumCubed = 0.0;
+  auto sum = lina::Vec3{ 0.0, 0.0, 0.0 };
+  auto sumSquared = lina::Vec3{ 0.0, 0.0, 0.0 };
+  for (auto i = 0; i < samples; ++i) {
+    auto const point = trace::randomOnUnitSphere(sampler);
+    auto const length = point.Length();
+    ASSERT_LE(length, 1.0 + 1e-12);
+    sumCubed += length * length * length;
+    sum += point;
+    sumSquared += point * point;
+  }
+  EXPECT_NEAR(sumCubed / samples, 0.5, 0.005);
+  for (auto axis = 0; axis < 3; ++axis) {
+    EXPECT_NEAR(sum[axis] / samples, 0.0, 0.005);
+    EXPECT_NEAR(sumSquared[axis] / samples, 0.2, 0.005);
+  }
+}
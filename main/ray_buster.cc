@@ -1,7 +1,9 @@
+#include "lib/trace/sampler.h"
 #include "main/render/pixel_partition.h"
 #include "main/scenes/scene.h"
 #include "main/scenes/scene_settings.h"
 
+#include <chrono>
 #include <cstring>
 #include <exception>
 #include <format>
@@ -53,6 +55,39 @@ auto help() -> std::string
          "\t-a <value>\t\t- defocus angle. An angle for simulating camera focusing artifacts. A 0.0 disables the "
          "features.\n"
          "\t-m <value>\t\t- focus distance. The distance the camera is focusing at.\n\n"
+         "Rendering options, that are independent of the scenes:\n"
+         "\t--sampler <value>\t- the sampler generating the random decisions of the paths. 'sobol' (default) uses "
+         "Owen scrambled Sobol points, which converge faster, 'independent' uses independent pseudo random numbers. "
+         "'zsobol' spreads the Sobol points over the pixels so the remaining noise is blue noise, which looks "
+         "converged sooner at low sample counts. 'cmj' uses correlated multi-jittered patterns, which stratify the "
+         "pixel and lens positions well for any sample count, not just the powers of two.\n"
+         "\t--integrator <value>\t- the light transport algorithm. 'mis' (default) samples a light at every diffuse "
+         "bounce with a shadow ray, picking the lights of the scene in proportion to their power, and combines it with "
+         "the light the scattered rays find, weighted by the power heuristic. 'nee' only uses the light samples, "
+         "'path' follows the scattered rays, sampling the main light of the scene half of the time.\n"
+         "\t--engine <value>\t- how the paths are traced. 'depth-first' (default) traces them one after the other, "
+         "'wavefront' a few thousand at once, one stage at a time. Both give the same image, the wavefront engine "
+         "only works with the 'nee' and 'mis' integrators.\n"
+         "\t--seed <value>\t\t- the seed of the random numbers. Renders with the same seed and settings are "
+         "bit-identical, whatever the number of threads. Without it a random seed is used, which is printed at the "
+         "start.\n"
+         "\t--threads <value>\t- the number of rendering threads. Defaults to the number of hardware threads.\n"
+         "\t--adaptive-threshold <value>\t- enables adaptive sampling. Each pixel stops taking samples once the "
+         "estimated error of its displayed color falls below the threshold, which has to be above zero. 0.01 is "
+         "about 2.5 levels out of 255.\n"
+         "\t--min-spp <value>\t- the least samples a pixel takes in adaptive mode. Defaults to 64, as stopping too "
+         "early favours the pixels that have not found their rare bright paths yet, which darkens the image.\n"
+         "\t--max-spp <value>\t- the most samples a pixel takes in adaptive or time limited mode. In adaptive mode it "
+         "defaults to the '-s' sample count, raising it moves the samples saved on the converged pixels to the noisy "
+         "ones. Both '--min-spp' and '--max-spp' are between 1 and 4294967295, and the minimum can't be above the "
+         "maximum.\n"
+         "\t--time-limit <seconds>\t- progressive rendering. Instead of the '-s' sample count, passes are made over "
+         "the whole image, adding samples to every pixel, until the time runs out. It has to be above zero. "
+         "'--max-spp' still caps the samples, and with '--adaptive-threshold' the converged pixels are skipped.\n"
+         "\t--target-error <value>\t- progressive rendering, until the relative error of the image, estimated from "
+         "two half buffers of the samples, falls below the target, which has to be above zero. Needs '--time-limit', "
+         "'--max-spp' or both, whichever is reached first stops the render, as the target alone might never be "
+         "reached.\n\n"
          "Example usage:\n"
          "./ray_buster --scene cornell-box\n"
          "If the default configuration should be changed the easiest way is to list it with:\n"
@@ -88,6 +123,7 @@ auto main(int argc, char* argv[]) -> int
     auto degreesVerticalFOV = std::optional<double>{};
     auto defocusAngle = std::optional<double>{};
     auto focusDistance = std::optional<double>{};
+    auto renderOptions = render::RenderOptions{};
 
     auto const resolutionRegex = std::regex{ R"((\d+)x(\d+))" };
 
@@ -95,12 +131,22 @@ auto main(int argc, char* argv[]) -> int
       auto optionIndex = 0;
       // option, optarg and getopt_long for some reason is not seen by the linter
       // NOLINTBEGIN(misc-include-cleaner)
-      static auto const longOptions = std::array<struct option const, 4>({ { "scene", required_argument, nullptr, 0 },
+      static auto const longOptions = std::array<struct option const, 14>({ { "scene", required_argument, nullptr, 0 },
         { "list", no_argument, nullptr, 0 },
         { "help", no_argument, nullptr, 0 },
+        { "sampler", required_argument, nullptr, 0 },
+        { "integrator", required_argument, nullptr, 0 },
+        { "engine", required_argument, nullptr, 0 },
+        { "seed", required_argument, nullptr, 0 },
+        { "threads", required_argument, nullptr, 0 },
+        { "adaptive-threshold", required_argument, nullptr, 0 },
+        { "min-spp", required_argument, nullptr, 0 },
+        { "max-spp", required_argument, nullptr, 0 },
+        { "time-limit", required_argument, nullptr, 0 },
+        { "target-error", required_argument, nullptr, 0 },
         { nullptr, no_argument, nullptr, 0 } });
 
-      auto charCode = getopt_long(argc, argv, "hr:s:d:o:f:a:m", longOptions.data(), &optionIndex);
+      auto charCode = getopt_long(argc, argv, "hr:s:d:o:f:a:m:", longOptions.data(), &optionIndex);
 
       if (charCode == -1) { break; };
       switch (charCode) {
@@ -116,6 +162,86 @@ auto main(int argc, char* argv[]) -> int
         if (std::strncmp(longOptions.at(optionIndex).name, "scene", sizeof("scene")) == 0) {
           selectedScene = std::string(optarg);
         }
+        if (std::strncmp(longOptions.at(optionIndex).name, "sampler", sizeof("sampler")) == 0) {
+          try {
+            renderOptions.sampler = trace::samplerTypeFromName(optarg);
+          } catch (std::exception const& e) {
+            std::cerr << std::format("Failed to parse '--sampler' argument. Reason: {}", e.what()) << '\n';
+            return 1;
+          }
+        }
+        if (std::strncmp(longOptions.at(optionIndex).name, "integrator", sizeof("integrator")) == 0) {
+          try {
+            renderOptions.integrator = render::integratorFromName(optarg);
+          } catch (std::exception const& e) {
+            std::cerr << std::format("Failed to parse '--integrator' argument. Reason: {}", e.what()) << '\n';
+            return 1;
+          }
+        }
+        if (std::strncmp(longOptions.at(optionIndex).name, "engine", sizeof("engine")) == 0) {
+          try {
+            renderOptions.engine = render::engineFromName(optarg);
+          } catch (std::exception const& e) {
+            std::cerr << std::format("Failed to parse '--engine' argument. Reason: {}", e.what()) << '\n';
+            return 1;
+          }
+        }
+        if (std::strncmp(longOptions.at(optionIndex).name, "seed", sizeof("seed")) == 0) {
+          try {
+            renderOptions.seed = render::seedFromText(std::string{ optarg });
+          } catch (std::exception const& e) {
+            std::cerr << std::format("Failed to parse '--seed' argument. Reason: {}", e.what()) << '\n';
+            return 1;
+          }
+        }
+        if (std::strncmp(longOptions.at(optionIndex).name, "threads", sizeof("threads")) == 0) {
+          try {
+            renderOptions.threadCount = render::threadCountFromText(std::string{ optarg });
+          } catch (std::exception const& e) {
+            std::cerr << std::format("Failed to parse '--threads' argument. Reason: {}", e.what()) << '\n';
+            return 1;
+          }
+        }
+        if (std::strncmp(longOptions.at(optionIndex).name, "adaptive-threshold", sizeof("adaptive-threshold")) == 0) {
+          try {
+            renderOptions.adaptiveThreshold = render::positiveNumberFromText(std::string{ optarg });
+          } catch (std::exception const& e) {
+            std::cerr << std::format("Failed to parse '--adaptive-threshold' argument. Reason: {}", e.what()) << '\n';
+            return 1;
+          }
+        }
+        if (std::strncmp(longOptions.at(optionIndex).name, "min-spp", sizeof("min-spp")) == 0) {
+          try {
+            renderOptions.minSampleCount = render::sampleCountFromText(std::string{ optarg });
+          } catch (std::exception const& e) {
+            std::cerr << std::format("Failed to parse '--min-spp' argument. Reason: {}", e.what()) << '\n';
+            return 1;
+          }
+        }
+        if (std::strncmp(longOptions.at(optionIndex).name, "max-spp", sizeof("max-spp")) == 0) {
+          try {
+            renderOptions.maxSampleCount = render::sampleCountFromText(std::string{ optarg });
+          } catch (std::exception const& e) {
+            std::cerr << std::format("Failed to parse '--max-spp' argument. Reason: {}", e.what()) << '\n';
+            return 1;
+          }
+        }
+        if (std::strncmp(longOptions.at(optionIndex).name, "time-limit", sizeof("time-limit")) == 0) {
+          try {
+            renderOptions.timeLimit = render::timeLimitFromText(std::string{ optarg });
+          } catch (std::exception const& e) {
+            std::cerr << std::format("Failed to parse '--time-limit' argument. Reason: {}", e.what()) << '\n';
+            return 1;
+          }
+        }
+        if (std::strncmp(longOptions.at(optionIndex).name, "target-error", sizeof("target-error")) == 0) {
+          try {
+            renderOptions.targetError = render::positiveNumberFromText(std::string{ optarg });
+          } catch (std::exception const& e) {
+            std::cerr << std::format("Failed to parse '--target-error' argument. Reason: {}", e.what()) << '\n';
+            return 1;
+          }
+        }
         break;
       }
       case 'h': {
@@ -203,6 +329,21 @@ auto main(int argc, char* argv[]) -> int
       // NOLINTEND(misc-include-cleaner)
     }
 
+    if (renderOptions.minSampleCount && renderOptions.maxSampleCount
+        && renderOptions.minSampleCount.value() > renderOptions.maxSampleCount.value()) {
+      std::cerr << std::format("'--min-spp' {} is above '--max-spp' {}",
+        renderOptions.minSampleCount.value(),
+        renderOptions.maxSampleCount.value())
+                << '\n';
+      return 1;
+    }
+
+    if (renderOptions.targetError && !renderOptions.timeLimit && !renderOptions.maxSampleCount) {
+      std::cerr << "'--target-error' needs '--time-limit' or '--max-spp' as well, the target alone might never be "
+                   "reached\n";
+      return 1;
+    }
+
     auto const configs = scene::configurations();
     auto selected = configs.find(selectedScene);
     if (selected == configs.end()) {
@@ -229,7 +370,7 @@ auto main(int argc, char* argv[]) -> int
       std::cerr << std::format("Failed to open file: '{}'", consolidatedSettings.outputFile);
       return 1;
     }
-    render::linearPartition(selected->second.sceneLoader(consolidatedSettings), renderResult);
+    render::linearPartition(selected->second.sceneLoader(consolidatedSettings), renderOptions, renderResult);
   } catch (std::exception const& e) {
     std::cerr << std::format("Unhandled exception:\n{}", e.what()) << '\n';
     return 1;
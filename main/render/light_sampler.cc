@@ -0,0 +1,265 @@
+#include "main/render/light_sampler.h"
+
+#include "lib/lina/vec3.h"
+#include "lib/trace/geometry/aabb.h"
+#include "lib/trace/pdf.h"
+#include "main/scenes/scene.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <numbers>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace render {
+
+// The trails of the leaves have a bit for every level of the tree.
+constexpr auto maxTreeDepth = std::size_t{ 64 };
+// The largest double below one, the uniform numbers passed down the tree are kept below it.
+constexpr auto oneMinusEpsilon = 0x1.fffffffffffffp-1;
+
+static auto boxCenter(trace::Aabb const& box) -> lina::Vec3
+{
+  return lina::Vec3{ (box.minX + box.maxX) / 2.0, (box.minY + box.maxY) / 2.0, (box.minZ + box.maxZ) / 2.0 };
+}
+
+static auto safeSqrt(double value) -> double { return std::sqrt(std::max(value, 0.0)); }
+
+// The cosine of max(0, a - b) for the angles a and b given by their sines and cosines.
+static auto cosSubClamped(double sinA, double cosA, double sinB, double cosB) -> double
+{
+  if (cosA > cosB) { return 1.0; }
+  return (cosA * cosB) + (sinA * sinB);
+}
+
+// The sine of max(0, a - b) for the angles a and b given by their sines and cosines.
+static auto sinSubClamped(double sinA, double cosA, double sinB, double cosB) -> double
+{
+  if (cosA > cosB) { return 0.0; }
+  return (sinA * cosB) - (cosA * sinB);
+}
+
+// Rodrigues' rotation formula, the axis is a unit vector.
+static auto rotate(lina::Vec3 const& vector, lina::Vec3 const& axis, double radians) -> lina::Vec3
+{
+  auto const cosine = std::cos(radians);
+  return (vector * cosine) + (lina::cross(axis, vector) * std::sin(radians))
+         + (axis * (lina::dot(axis, vector) * (1.0 - cosine)));
+}
+
+// The smallest cone containing both cones, given by their axes and the cosines of their spread angles.
+static auto coneUnion(lina::Vec3 const& axisA, double cosSpreadA, lina::Vec3 const& axisB, double cosSpreadB)
+  -> std::pair<lina::Vec3, double>
+{
+  auto const wholeSphere = std::make_pair(lina::Vec3{ 0.0, 0.0, 1.0 }, -1.0);
+  auto const spreadA = std::acos(std::clamp(cosSpreadA, -1.0, 1.0));
+  auto const spreadB = std::acos(std::clamp(cosSpreadB, -1.0, 1.0));
+  auto const between = std::acos(std::clamp(lina::dot(axisA, axisB), -1.0, 1.0));
+  if (std::min(between + spreadB, std::numbers::pi) <= spreadA) { return std::make_pair(axisA, cosSpreadA); }
+  if (std::min(between + spreadA, std::numbers::pi) <= spreadB) { return std::make_pair(axisB, cosSpreadB); }
+
+  auto const spread = (spreadA + between + spreadB) / 2.0;
+  if (spread >= std::numbers::pi) { return wholeSphere; }
+  // the axis of a is turned towards the axis of b, until the new cone touches the far side of both
+  auto const rotationAxis = lina::cross(axisA, axisB);
+  if (rotationAxis.Length() == 0.0) { return wholeSphere; }
+  return std::make_pair(rotate(axisA, lina::unit(rotationAxis), spread - spreadA), std::cos(spread));
+}
+
+// The estimate of pbrt-v4's LightBounds::Importance: the power over the squared distance, times an upper bound of the
+// cosine at which any of the lights could emit towards the point, and of the cosine at which the light could arrive
+// at the surface. The angles are bounded by the angle the bounding sphere of the box covers from the point.
+auto lightImportance(trace::Aabb const& bounds,
+  lina::Vec3 const& axis,
+  double cosNormalSpread,
+  double power,
+  lina::Vec3 const& point,
+  lina::Vec3 const& normal) -> double
+{
+  auto const center = boxCenter(bounds);
+  auto const radius = lina::Vec3{ bounds.maxX - bounds.minX, bounds.maxY - bounds.minY, bounds.maxZ - bounds.minZ }
+                        .Length()
+                      / 2.0;
+  auto const toPoint = point - center;
+  auto const distance = toPoint.Length();
+  // inside the bounding sphere the lights could be in any direction, and as close as can be
+  if (distance <= radius) { return power / std::max(radius * radius, 1e-12); }
+
+  auto const distanceSquared = distance * distance;
+  auto const sinBoundsSquared = (radius * radius) / distanceSquared;
+  auto const cosBounds = safeSqrt(1.0 - sinBoundsSquared);
+  auto const sinBounds = std::sqrt(sinBoundsSquared);
+
+  // the angle between the axis and the direction of the point, less the spread of the normals and of the bounds
+  auto const cosToPoint = lina::dot(axis, toPoint / distance);
+  auto const sinToPoint = safeSqrt(1.0 - (cosToPoint * cosToPoint));
+  auto const sinNormalSpread = safeSqrt(1.0 - (cosNormalSpread * cosNormalSpread));
+  auto const cosOutsideNormals = cosSubClamped(sinToPoint, cosToPoint, sinNormalSpread, cosNormalSpread);
+  auto const sinOutsideNormals = sinSubClamped(sinToPoint, cosToPoint, sinNormalSpread, cosNormalSpread);
+  auto const cosEmission = cosSubClamped(sinOutsideNormals, cosOutsideNormals, sinBounds, cosBounds);
+  // no light is emitted beyond the hemisphere around the normal
+  if (cosEmission <= 0.0) { return 0.0; }
+
+  // the angle of the light arriving at the surface, less the spread of the bounds
+  auto const cosIncident = std::fabs(lina::dot(toPoint / distance, normal));
+  auto const sinIncident = safeSqrt(1.0 - (cosIncident * cosIncident));
+  auto const cosArrival = cosSubClamped(sinIncident, cosIncident, sinBounds, cosBounds);
+
+  return std::max(power * cosEmission * cosArrival / distanceSquared, 0.0);
+}
+
+LightSampler::LightSampler(std::vector<scene::Element> const& sceneElements) : lightIndices_(sceneElements.size())
+{
+  auto leaves = std::vector<Node>{};
+  for (auto i = std::size_t{ 0 }; i < sceneElements.size(); ++i) {
+    auto const& [component, material] = sceneElements[i];
+    auto const radiance = material->EmittedRadiance();
+    auto const power = (radiance[0] + radiance[1] + radiance[2]) / 3.0 * component->SurfaceArea();
+    auto shape = component->Shape();
+    if (power <= 0.0 || !shape) { continue; }
+    auto const lightIndex = lights_.size();
+    lights_.emplace_back(Light{ std::move(shape).value(), power, i, 0 });
+    lightIndices_[i] = lightIndex;
+    // a flat light emitting from its front only has a single normal, any other could face anywhere
+    auto const frontNormal = component->FrontNormal();
+    if (material->EmitsFrontOnly() && frontNormal) {
+      leaves.emplace_back(Node{ component->GetBoundingBox(), frontNormal.value(), 1.0, power, lightIndex, true });
+    } else {
+      leaves.emplace_back(
+        Node{ component->GetBoundingBox(), lina::Vec3{ 0.0, 0.0, 1.0 }, -1.0, power, lightIndex, true });
+    }
+  }
+  if (leaves.empty()) { return; }
+  nodes_.reserve((2 * leaves.size()) - 1);
+  build(leaves, 0, 0);
+}
+
+// The leaves are split in half along the longest axis of the box of their centers, so the depth of the tree is
+// logarithmic in the number of lights.
+auto LightSampler::build(std::span<Node> leaves, std::uint64_t trail, std::size_t depth) -> void
+{
+  if (depth >= maxTreeDepth) { throw std::logic_error(std::format("Light tree too deep: {}", depth)); }
+  if (leaves.size() == 1) {
+    nodes_.emplace_back(leaves[0]);
+    lights_[leaves[0].index].trail = trail;
+    return;
+  }
+
+  auto const pointBox = [](lina::Vec3 const& point) -> trace::Aabb {
+    return trace::Aabb{ point[0], point[0], point[1], point[1], point[2], point[2] };
+  };
+  auto centers = pointBox(boxCenter(leaves[0].bounds));
+  for (auto const& leaf : leaves) { centers = mergeAABB(centers, pointBox(boxCenter(leaf.bounds))); }
+  auto const extents =
+    std::array<double, 3>{ centers.maxX - centers.minX, centers.maxY - centers.minY, centers.maxZ - centers.minZ };
+  auto const axis = static_cast<std::size_t>(std::distance(extents.begin(), std::ranges::max_element(extents)));
+  auto const middle = leaves.size() / 2;
+  std::ranges::nth_element(leaves,
+    leaves.begin() + static_cast<std::ptrdiff_t>(middle),
+    {},
+    [axis](Node const& leaf) -> double { return boxCenter(leaf.bounds)[axis]; });
+
+  auto const nodeIndex = nodes_.size();
+  nodes_.emplace_back();
+  build(leaves.first(middle), trail, depth + 1);
+  auto const secondChild = nodes_.size();
+  build(leaves.subspan(middle), trail | (std::uint64_t{ 1 } << depth), depth + 1);
+
+  auto const& first = nodes_[nodeIndex + 1];
+  auto const& second = nodes_[secondChild];
+  auto const [coneAxis, cosNormalSpread] =
+    coneUnion(first.axis, first.cosNormalSpread, second.axis, second.cosNormalSpread);
+  nodes_[nodeIndex] = Node{ mergeAABB(first.bounds, second.bounds),
+    coneAxis,
+    cosNormalSpread,
+    first.power + second.power,
+    secondChild,
+    false };
+}
+
+auto LightSampler::branchProbabilities(std::size_t nodeIndex, lina::Vec3 const& point, lina::Vec3 const& normal) const
+  -> std::pair<double, double>
+{
+  auto const& first = nodes_[nodeIndex + 1];
+  auto const& second = nodes_[nodes_[nodeIndex].index];
+  auto const firstImportance =
+    lightImportance(first.bounds, first.axis, first.cosNormalSpread, first.power, point, normal);
+  auto const secondImportance =
+    lightImportance(second.bounds, second.axis, second.cosNormalSpread, second.power, point, normal);
+  auto const total = firstImportance + secondImportance;
+  if (total == 0.0) { return std::make_pair(0.0, 0.0); }
+  return std::make_pair(firstImportance / total, secondImportance / total);
+}
+
+// The uniform number is reused at every level: whichever branch it falls into, it is rescaled to [0, 1) within it.
+auto LightSampler::Pick(lina::Vec3 const& point, lina::Vec3 const& normal, double uniform) const
+  -> std::optional<LightChoice>
+{
+  if (nodes_.empty()) { return std::optional<LightChoice>{}; }
+  auto const& root = nodes_[0];
+  // with a single light there is no choice to make, but it may still be unable to reach the point
+  if (root.leaf && lightImportance(root.bounds, root.axis, root.cosNormalSpread, root.power, point, normal) == 0.0) {
+    return std::optional<LightChoice>{};
+  }
+
+  auto probability = 1.0;
+  auto nodeIndex = std::size_t{ 0 };
+  while (!nodes_[nodeIndex].leaf) {
+    auto const [firstProbability, secondProbability] = branchProbabilities(nodeIndex, point, normal);
+    if (firstProbability == 0.0 && secondProbability == 0.0) { return std::optional<LightChoice>{}; }
+    if (uniform < firstProbability) {
+      uniform = std::min(uniform / firstProbability, oneMinusEpsilon);
+      probability *= firstProbability;
+      nodeIndex = nodeIndex + 1;
+    } else {
+      uniform = std::min((uniform - firstProbability) / secondProbability, oneMinusEpsilon);
+      probability *= secondProbability;
+      nodeIndex = nodes_[nodeIndex].index;
+    }
+  }
+  return LightChoice{ lights_[nodes_[nodeIndex].index].elementIndex, probability };
+}
+
+auto LightSampler::Probability(lina::Vec3 const& point, lina::Vec3 const& normal, std::size_t elementIndex) const
+  -> double
+{
+  auto const& lightIndex = lightIndices_[elementIndex];
+  if (!lightIndex) { return 0.0; }
+  auto const trail = lights_[lightIndex.value()].trail;
+  auto const& root = nodes_[0];
+  if (root.leaf) {
+    return lightImportance(root.bounds, root.axis, root.cosNormalSpread, root.power, point, normal) == 0.0 ? 0.0 : 1.0;
+  }
+
+  auto probability = 1.0;
+  auto nodeIndex = std::size_t{ 0 };
+  for (auto depth = std::size_t{ 0 }; !nodes_[nodeIndex].leaf; ++depth) {
+    auto const [firstProbability, secondProbability] = branchProbabilities(nodeIndex, point, normal);
+    if (((trail >> depth) & 1U) == 0U) {
+      probability *= firstProbability;
+      nodeIndex = nodeIndex + 1;
+    } else {
+      probability *= secondProbability;
+      nodeIndex = nodes_[nodeIndex].index;
+    }
+    if (probability == 0.0) { return 0.0; }
+  }
+  return probability;
+}
+
+auto LightSampler::SamplingPDF(std::size_t elementIndex, lina::Vec3 const& from) const -> trace::PDF
+{
+  auto const& lightIndex = lightIndices_[elementIndex];
+  if (!lightIndex) { return trace::PDF{}; }
+  return trace::samplingPDF(lights_[lightIndex.value()].shape, from);
+}
+
+}// namespace render
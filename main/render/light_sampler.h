@@ -0,0 +1,103 @@
+#ifndef RAY_BUSTER_MAIN_RENDER_LIGHT_SAMPLER_H_
+#define RAY_BUSTER_MAIN_RENDER_LIGHT_SAMPLER_H_
+
+#include "lib/lina/vec3.h"
+#include "lib/trace/geometry/aabb.h"
+#include "lib/trace/pdf.h"
+#include "main/scenes/scene.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace render {
+
+// A light picked for a shading point, with the probability of picking it.
+struct LightChoice
+{
+  std::size_t elementIndex;
+  double probability;
+};
+
+// The lights of a scene are the elements with an emitting material and a component that can be sampled.
+// They are kept in a bounding volume hierarchy, the light tree of Conty Estevez, Kulla "Importance Sampling of Many
+// Lights with Adaptive Tree Splitting" (2018), in the form pbrt-v4 implements it. Every node bounds the positions of
+// its lights with a box, the directions of their surface normals with a cone, and sums up their power, the average
+// of the emitted radiance times the surface area. From these bounds an estimate of how much the lights of a node
+// could contribute to a shading point is calculated, and the tree is walked down from the root, taking either child
+// with a probability following its estimate. Lights far away, dim, or facing away get few of the shadow rays, and
+// picking a light, or calculating the probability of picking it, takes time logarithmic in the number of lights.
+// The shapes and powers of the lights are copied into records next to each other when the sampler is built, and the
+// densities of the light samples are made from those, without going through the components.
+class LightSampler
+{
+public:
+  explicit LightSampler(std::vector<scene::Element> const& sceneElements);
+  LightSampler(LightSampler const&) = default;
+  LightSampler(LightSampler&&) = default;
+  auto operator=(LightSampler const&) -> LightSampler& = default;
+  auto operator=(LightSampler&&) -> LightSampler& = default;
+  ~LightSampler() = default;
+
+  // Pick a light for a shading point with the given surface normal, with a uniform number in [0, 1).
+  // Nothing is picked when the scene has no lights, or when none of them can reach the point.
+  [[nodiscard]] auto Pick(lina::Vec3 const& point, lina::Vec3 const& normal, double uniform) const
+    -> std::optional<LightChoice>;
+  // The probability of Pick choosing the element for the shading point, zero for the elements that are not lights.
+  [[nodiscard]] auto Probability(lina::Vec3 const& point, lina::Vec3 const& normal, std::size_t elementIndex) const
+    -> double;
+  // The density of the directions from the point towards the element, empty for the elements that are not lights.
+  // It may refer to the sampler, so it must not outlive it.
+  [[nodiscard]] auto SamplingPDF(std::size_t elementIndex, lina::Vec3 const& from) const -> trace::PDF;
+
+private:
+  struct Light
+  {
+    trace::SamplingShape shape;
+    double power;
+    std::size_t elementIndex;
+    // the branches taken from the root to the leaf of the light: bit i is set if the second child was taken at
+    // depth i
+    std::uint64_t trail;
+  };
+
+  struct Node
+  {
+    trace::Aabb bounds;
+    // The surface normals of the lights are within the angle of the axis, whose cosine is cosNormalSpread.
+    // Every point of the surfaces emits into the hemisphere around its normal.
+    lina::Vec3 axis;
+    double cosNormalSpread;
+    double power;
+    // a leaf stores the index of its light, an inner node the index of its second child, the first child follows the
+    // node itself
+    std::size_t index;
+    bool leaf;
+  };
+
+  // Builds the subtree of the given leaves, the bits of trail are the branches taken to reach it.
+  auto build(std::span<Node> leaves, std::uint64_t trail, std::size_t depth) -> void;
+  // The probabilities of taking the first and the second child of an inner node.
+  [[nodiscard]] auto branchProbabilities(std::size_t nodeIndex, lina::Vec3 const& point, lina::Vec3 const& normal)
+    const -> std::pair<double, double>;
+
+  std::vector<Node> nodes_;
+  std::vector<Light> lights_;
+  // For every element that is a light, the index of its record in lights_.
+  std::vector<std::optional<std::size_t>> lightIndices_;
+};
+
+// The estimated contribution of lights within the bounds of a node to a shading point, see LightSampler.
+[[nodiscard]] auto lightImportance(trace::Aabb const& bounds,
+  lina::Vec3 const& axis,
+  double cosNormalSpread,
+  double power,
+  lina::Vec3 const& point,
+  lina::Vec3 const& normal) -> double;
+
+}// namespace render
+
+#endif
@@ -0,0 +1,149 @@
+#include "lib/lina/vec3.h"
+#include "lib/trace/geometry/icosphere.h"
+#include "lib/trace/geometry/plane.h"
+#include "lib/trace/geometry/sphere.h"
+#include "lib/trace/material/emissive.h"
+#include "lib/trace/material/lambertian.h"
+#include "lib/trace/sampler.h"
+#include "main/render/light_sampler.h"
+#include "main/scenes/scene.h"
+
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// A row of equal spheres along the x axis, all of them reach the points above the row.
+auto buildLightRow(std::size_t count) -> std::vector<scene::Element>
+{
+  auto sceneElements = std::vector<scene::Element>{};
+  for (auto i = std::size_t{ 0 }; i < count; ++i) {
+    sceneElements.emplace_back(
+      std::make_unique<trace::Sphere>(trace::buildSphere(lina::Vec3{ static_cast<double>(i), 0.0, 0.0 }, 0.5)),
+      std::make_unique<trace::Emissive>(lina::Vec3{ 1.0, 1.0, 1.0 }));
+  }
+  return sceneElements;
+}
+
+TEST(LightSampler, picksMatchTheProbabilities)
+{
+  auto const sceneElements = buildLightRow(37);
+  auto const lights = render::LightSampler{ sceneElements };
+  auto const point = lina::Vec3{ 5.0, 0.0, 3.0 };
+  auto const normal = lina::Vec3{ 0.0, 0.0, -1.0 };
+
+  auto total = 0.0;
+  for (auto i = std::size_t{ 0 }; i < sceneElements.size(); ++i) { total += lights.Probability(point, normal, i); }
+  EXPECT_NEAR(total, 1.0, 1e-12);
+
+  auto counts = std::vector<double>(sceneElements.size());
+  auto constexpr picks = 100000;
+  for (auto i = 0; i < picks; ++i) {
+    auto const choice = lights.Pick(point, normal, (static_cast<double>(i) + 0.5) / picks);
+    ASSERT_TRUE(choice.has_value());
+    EXPECT_DOUBLE_EQ(choice->probability, lights.Probability(point, normal, choice->elementIndex));
+    counts.at(choice->elementIndex) += 1.0;
+  }
+  for (auto i = std::size_t{ 0 }; i < sceneElements.size(); ++i) {
+    EXPECT_NEAR(counts[i] / picks, lights.Probability(point, normal, i), 1e-4);
+  }
+}
+
+TEST(LightSampler, prefersTheCloseAndPowerfulLights)
+{
+  auto const sceneElements = buildLightRow(16);
+  auto const lights = render::LightSampler{ sceneElements };
+  auto const point = lina::Vec3{ 2.0, 0.0, 2.0 };
+  auto const normal = lina::Vec3{ 0.0, 0.0, -1.0 };
+  EXPECT_GT(lights.Probability(point, normal, 2), lights.Probability(point, normal, 15));
+
+  auto bright = buildLightRow(2);
+  bright[1].material = std::make_unique<trace::Emissive>(lina::Vec3{ 10.0, 10.0, 10.0 });
+  auto const brightLights = render::LightSampler{ bright };
+  auto const between = lina::Vec3{ 0.5, 0.0, 4.0 };
+  EXPECT_GT(brightLights.Probability(between, normal, 1), 0.8);
+}
+
+TEST(LightSampler, ignoresTheLightsFacingAway)
+{
+  auto sceneElements = std::vector<scene::Element>{};
+  // facing up and down, only emitting from the front
+  sceneElements.emplace_back(std::make_unique<trace::Plane>(trace::buildPlane(lina::Vec3{ 0.0, 0.0, 0.0 }, 1.0, 1.0)),
+    std::make_unique<trace::Emissive>(lina::Vec3{ 1.0, 1.0, 1.0 }, true));
+  sceneElements.emplace_back(std::make_unique<trace::Plane>(trace::buildPlane(
+                               lina::Vec3{ 3.0, 0.0, 0.0 }, 1.0, 1.0, trace::Axis::Z, trace::Orientation::Reverse)),
+    std::make_unique<trace::Emissive>(lina::Vec3{ 1.0, 1.0, 1.0 }, true));
+  auto const lights = render::LightSampler{ sceneElements };
+
+  auto const above = lina::Vec3{ 1.5, 0.0, 5.0 };
+  auto const normal = lina::Vec3{ 0.0, 0.0, 1.0 };
+  EXPECT_EQ(lights.Probability(above, normal, 0), 1.0);
+  EXPECT_EQ(lights.Probability(above, normal, 1), 0.0);
+  auto const below = lina::Vec3{ 1.5, 0.0, -5.0 };
+  EXPECT_EQ(lights.Probability(below, normal, 0), 0.0);
+  EXPECT_EQ(lights.Probability(below, normal, 1), 1.0);
+  for (auto const uniform : { 0.0, 0.3, 0.7, 0.99 }) {
+    auto const choice = lights.Pick(above, normal, uniform);
+    ASSERT_TRUE(choice.has_value());
+    EXPECT_EQ(choice->elementIndex, 0);
+  }
+
+  // a single light behind the point is never picked
+  auto single = std::vector<scene::Element>{};
+  single.emplace_back(std::move(sceneElements[0]));
+  auto const singleLight = render::LightSampler{ single };
+  EXPECT_FALSE(singleLight.Pick(below, normal, 0.5).has_value());
+  EXPECT_EQ(singleLight.Probability(below, normal, 0), 0.0);
+  EXPECT_EQ(singleLight.Probability(above, normal, 0), 1.0);
+}
+
+TEST(LightSampler, skipsTheElementsThatDoNotEmit)
+{
+  auto sceneElements = std::vector<scene::Element>{};
+  sceneElements.emplace_back(std::make_unique<trace::Icosphere>(trace::buildIcosphere()),
+    std::make_unique<trace::Emissive>(lina::Vec3{ 3.0, 3.0, 3.0 }));
+  sceneElements.emplace_back(std::make_unique<trace::Plane>(trace::buildPlane(lina::Vec3{ 0.0, 0.0, 0.0 }, 2.0, 2.0)),
+    std::make_unique<trace::Lambertian>(lina::Vec3{ 0.5, 0.5, 0.5 }));
+  auto const lights = render::LightSampler{ sceneElements };
+  auto const point = lina::Vec3{ 0.0, 0.0, 5.0 };
+  auto const normal = lina::Vec3{ 0.0, 0.0, -1.0 };
+  auto const choice = lights.Pick(point, normal, 0.5);
+  ASSERT_TRUE(choice.has_value());
+  EXPECT_EQ(choice->elementIndex, 0);
+  EXPECT_EQ(lights.Probability(point, normal, 0), 1.0);
+  EXPECT_EQ(lights.Probability(point, normal, 1), 0.0);
+
+  auto dark = std::vector<scene::Element>{};
+  dark.emplace_back(std::move(sceneElements[1]));
+  auto const noLights = render::LightSampler{ dark };
+  EXPECT_FALSE(noLights.Pick(point, normal, 0.5).has_value());
+}
+
+TEST(LightSampler, samplesTheLightsLikeTheirComponents)
+{
+  auto sceneElements = std::vector<scene::Element>{};
+  sceneElements.emplace_back(std::make_unique<trace::Plane>(trace::buildPlane(
+                               lina::Vec3{ 0.0, 0.0, 3.0 }, 2.0, 1.0, trace::Axis::Z, trace::Orientation::Reverse)),
+    std::make_unique<trace::Emissive>(lina::Vec3{ 1.0, 1.0, 1.0 }, true));
+  sceneElements.emplace_back(std::make_unique<trace::Plane>(trace::buildPlane(lina::Vec3{ 0.0, 0.0, 0.0 }, 9.0, 9.0)),
+    std::make_unique<trace::Lambertian>(lina::Vec3{ 0.5, 0.5, 0.5 }));
+  sceneElements.emplace_back(std::make_unique<trace::Sphere>(trace::buildSphere(lina::Vec3{ 2.0, 1.0, 2.0 }, 0.5)),
+    std::make_unique<trace::Emissive>(lina::Vec3{ 2.0, 2.0, 2.0 }));
+  auto const lights = render::LightSampler{ sceneElements };
+  auto const from = lina::Vec3{ 0.5, -0.5, 0.0 };
+
+  EXPECT_EQ(lights.SamplingPDF(1, from).Evaluate(lina::Vec3{ 0.0, 0.0, 1.0 }), 0.0);
+  for (auto const elementIndex : { std::size_t{ 0 }, std::size_t{ 2 } }) {
+    auto const pdf = lights.SamplingPDF(elementIndex, from);
+    auto const componentPDF = sceneElements[elementIndex].component->SamplingPDF(from);
+    auto sampler = trace::IndependentSampler{ 42 };
+    auto componentSampler = trace::IndependentSampler{ 42 };
+    for (auto i = 0; i < 100; ++i) {
+      auto const direction = pdf.GenerateSample(sampler);
+      EXPECT_EQ(direction.Components(), componentPDF.GenerateSample(componentSampler).Components());
+      EXPECT_GT(pdf.Evaluate(direction), 0.0);
+      EXPECT_EQ(pdf.Evaluate(direction), componentPDF.Evaluate(direction));
+    }
+  }
+}
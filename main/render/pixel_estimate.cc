@@ -0,0 +1,73 @@
+#include "main/render/pixel_estimate.h"
+
+#include "lib/lina/vec3.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+
+namespace render {
+
+auto PixelEstimate::Add(lina::Vec3 const& sample) -> void
+{
+  if (sampleCount_ % 2 == 0) {
+    evenSum_ += sample;
+  } else {
+    oddSum_ += sample;
+  }
+  ++sampleCount_;
+  auto const deviation = sample - mean_;
+  mean_ += deviation / static_cast<double>(sampleCount_);
+  squaredDeviations_ += deviation * (sample - mean_);
+}
+
+auto PixelEstimate::SampleCount() const -> std::size_t { return sampleCount_; }
+
+auto PixelEstimate::Mean() const -> lina::Vec3 { return mean_; }
+
+auto PixelEstimate::Variance() const -> lina::Vec3
+{
+  if (sampleCount_ < 2) { return lina::Vec3{ 0.0, 0.0, 0.0 }; }
+  return squaredDeviations_ / static_cast<double>(sampleCount_ - 1);
+}
+
+auto PixelEstimate::DisplayError() const -> double
+{
+  // the output is sqrt(mean), whose error is about the error of the mean times the derivative 1 / (2 sqrt(mean))
+  constexpr auto smallestMean = 1e-4;
+  auto const variance = Variance();
+  auto error = 0.0;
+  for (auto channel = std::size_t{ 0 }; channel < 3; ++channel) {
+    auto const standardError = std::sqrt(variance[channel] / static_cast<double>(sampleCount_));
+    error = std::max(error, standardError / (2.0 * std::sqrt(std::max(mean_[channel], smallestMean))));
+  }
+  return error;
+}
+
+auto PixelEstimate::HalfDifference() const -> lina::Vec3
+{
+  if (sampleCount_ < 2) { return lina::Vec3{ 0.0, 0.0, 0.0 }; }
+  auto const oddCount = sampleCount_ / 2;
+  auto const evenCount = sampleCount_ - oddCount;
+  return (evenSum_ / static_cast<double>(evenCount)) - (oddSum_ / static_cast<double>(oddCount));
+}
+
+auto estimateRelativeError(std::span<PixelEstimate const> estimates) -> double
+{
+  constexpr auto smallestValue = 0.1;
+  if (estimates.empty()) { return 0.0; }
+  auto squaredErrorSum = 0.0;
+  for (auto const& estimate : estimates) {
+    auto const mean = estimate.Mean();
+    auto const difference = estimate.HalfDifference();
+    for (auto channel = std::size_t{ 0 }; channel < 3; ++channel) {
+      // half of the difference of the halves is the error of the mean
+      auto const relativeError = 0.5 * difference[channel] / std::max(mean[channel], smallestValue);
+      squaredErrorSum += relativeError * relativeError;
+    }
+  }
+  return std::sqrt(squaredErrorSum / static_cast<double>(3 * estimates.size()));
+}
+
+}// namespace render
@@ -0,0 +1,54 @@
+#ifndef RAY_BUSTER_MAIN_RENDER_PIXEL_ESTIMATE_H_
+#define RAY_BUSTER_MAIN_RENDER_PIXEL_ESTIMATE_H_
+
+#include "lib/lina/vec3.h"
+
+#include <cstddef>
+#include <span>
+
+namespace render {
+
+// The running mean and variance of the samples of a pixel, with Welford's algorithm.
+// The samples are also split into two half buffers, one with the even and one with the odd samples, whose difference
+// estimates the error of the pixel without a reference image.
+class PixelEstimate
+{
+public:
+  PixelEstimate() = default;
+  PixelEstimate(PixelEstimate const&) = default;
+  PixelEstimate(PixelEstimate&&) = default;
+  auto operator=(PixelEstimate const&) -> PixelEstimate& = default;
+  auto operator=(PixelEstimate&&) -> PixelEstimate& = default;
+  ~PixelEstimate() = default;
+
+  auto Add(lina::Vec3 const& sample) -> void;
+
+  [[nodiscard]] auto SampleCount() const -> std::size_t;
+  // The color of the pixel, black before the first sample.
+  [[nodiscard]] auto Mean() const -> lina::Vec3;
+  // The unbiased sample variance of each channel, zero before the second sample.
+  [[nodiscard]] auto Variance() const -> lina::Vec3;
+  // The standard error of the mean, carried through the gamma correction of the output, so it is measured in the
+  // units the image is displayed in. The worst of the three channels.
+  // Dark pixels would have an arbitrarily large error this way, so the mean is not taken smaller than 1e-4.
+  [[nodiscard]] auto DisplayError() const -> double;
+  // The mean of the even samples minus the mean of the odd ones, zero before the second sample.
+  // Both halves have the same expected value and half the samples each, so this is about twice the error of the mean.
+  [[nodiscard]] auto HalfDifference() const -> lina::Vec3;
+
+private:
+  lina::Vec3 mean_{ 0.0, 0.0, 0.0 };
+  lina::Vec3 squaredDeviations_{ 0.0, 0.0, 0.0 };
+  lina::Vec3 evenSum_{ 0.0, 0.0, 0.0 };
+  lina::Vec3 oddSum_{ 0.0, 0.0, 0.0 };
+  std::size_t sampleCount_ = 0;
+};
+
+// The relative root mean square error of the whole image, estimated from the half buffers of its pixels.
+// The error of every channel is divided by its value, which is not taken smaller than 0.1, so the dark regions count
+// with their absolute error instead of blowing up.
+[[nodiscard]] auto estimateRelativeError(std::span<PixelEstimate const> estimates) -> double;
+
+}// namespace render
+
+#endif
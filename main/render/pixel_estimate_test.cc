@@ -0,0 +1,71 @@
+#include "lib/lina/vec3.h"
+#include "main/render/pixel_estimate.h"
+
+#include <array>
+#include <cmath>
+#include <gtest/gtest.h>
+
+TEST(PixelEstimate, emptyEstimateIsBlack)
+{
+  auto const estimate = render::PixelEstimate{};
+  EXPECT_EQ(estimate.SampleCount(), 0);
+  EXPECT_EQ(estimate.Mean()[0], 0.0);
+  EXPECT_EQ(estimate.Variance()[0], 0.0);
+  EXPECT_EQ(estimate.DisplayError(), 0.0);
+}
+
+TEST(PixelEstimate, matchesTheTwoPassStatistics)
+{
+  auto const samples = std::array<lina::Vec3, 5>{
+    { { 0.1, 2.0, 0.0 }, { 0.4, 1.0, 0.0 }, { 0.2, 4.0, 0.0 }, { 0.9, 3.0, 0.0 }, { 0.3, 5.0, 0.0 } }
+  };
+  auto estimate = render::PixelEstimate{};
+  for (auto const& sample : samples) { estimate.Add(sample); }
+
+  EXPECT_EQ(estimate.SampleCount(), samples.size());
+  EXPECT_NEAR(estimate.Mean()[0], 0.38, 1e-12);
+  EXPECT_NEAR(estimate.Mean()[1], 3.0, 1e-12);
+  EXPECT_NEAR(estimate.Variance()[0], 0.097, 1e-12);
+  EXPECT_NEAR(estimate.Variance()[1], 2.5, 1e-12);
+  EXPECT_EQ(estimate.Variance()[2], 0.0);
+}
+
+TEST(PixelEstimate, displayErrorFollowsTheGammaCorrection)
+{
+  auto estimate = render::PixelEstimate{};
+  // mean 0.25 and variance 0.01 in every channel
+  for (auto const value : { 0.15, 0.35, 0.15, 0.35 }) { estimate.Add(lina::Vec3{ value, value, value }); }
+  auto const standardError = std::sqrt(0.04 / 3.0 / 4.0);
+  EXPECT_NEAR(estimate.DisplayError(), standardError / (2.0 * 0.5), 1e-12);
+
+  // a constant pixel has converged right away
+  auto constant = render::PixelEstimate{};
+  for (auto i = 0; i < 4; ++i) { constant.Add(lina::Vec3{ 0.0, 0.0, 0.0 }); }
+  EXPECT_EQ(constant.DisplayError(), 0.0);
+}
+
+TEST(PixelEstimate, halfDifferenceComparesTheEvenAndOddSamples)
+{
+  auto estimate = render::PixelEstimate{};
+  estimate.Add(lina::Vec3{ 1.0, 0.0, 0.0 });
+  EXPECT_EQ(estimate.HalfDifference()[0], 0.0);
+  estimate.Add(lina::Vec3{ 3.0, 0.0, 0.0 });
+  estimate.Add(lina::Vec3{ 2.0, 0.0, 0.0 });
+  // even samples 1 and 2, odd sample 3
+  EXPECT_DOUBLE_EQ(estimate.HalfDifference()[0], 1.5 - 3.0);
+  EXPECT_DOUBLE_EQ(estimate.Mean()[0], 2.0);
+}
+
+TEST(estimateRelativeError, scalesTheHalfDifferencesByTheValues)
+{
+  auto estimates = std::array<render::PixelEstimate, 2>{};
+  // mean 1 and half difference 0.2 in every channel
+  estimates[0].Add(lina::Vec3{ 1.1, 1.1, 1.1 });
+  estimates[0].Add(lina::Vec3{ 0.9, 0.9, 0.9 });
+  // a converged pixel
+  estimates[1].Add(lina::Vec3{ 0.5, 0.5, 0.5 });
+  estimates[1].Add(lina::Vec3{ 0.5, 0.5, 0.5 });
+  // the error of the mean is half of the half difference, so 0.1 relative error in half of the pixels
+  EXPECT_NEAR(render::estimateRelativeError(estimates), std::sqrt(0.01 / 2.0), 1e-12);
+  EXPECT_EQ(render::estimateRelativeError({}), 0.0);
+}
@@ -4,28 +4,42 @@
 #include "lib/lina/vec3.h"
 #include "lib/trace/camera.h"
 #include "lib/trace/collision.h"
+#include "lib/trace/geometry/aabb.h"
 #include "lib/trace/geometry/component.h"
 #include "lib/trace/geometry/mesh.h"
 #include "lib/trace/material.h"
+#include "lib/trace/material_table.h"
 #include "lib/trace/pdf.h"
 #include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
 #include "lib/trace/util.h"
+#include "main/render/light_sampler.h"
+#include "main/render/pixel_estimate.h"
 #include "main/render/voxel_space.h"
+#include "main/render/voxel_walk.h"
+#include "main/render/wavefront.h"
 #include "main/scenes/scene.h"
 
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
+#include <exception>
 #include <format>
 #include <functional>
 #include <future>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <ostream>
 #include <random>
+#include <span>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 #include <thread>
 #include <utility>
 #include <variant>
@@ -65,192 +79,653 @@ auto closestCollision(trace::Ray const& ray, std::vector<scene::Element> const&
   return std::make_pair(closestCollision, elementIndex);
 }
 
-// NOLINTBEGIN(readability-function-cognitive-complexity)
-// Partial source for the algorithm: http://www.cse.yorku.ca/~amana/research/grid.pdf
-// Based on the ideas from: https://www.youtube.com/watch?v=NbSee-XM7WA
+// Whether the ray has to check the node, entering its box no farther than the limit. A hierarchy of a single leaf
+// is checked without its box, nearly every ray enters the box of the whole scene, and its objects test the rays
+// as fast as the box would.
+static auto entersNode(std::vector<render::AnalyticNode> const& nodes,
+  std::size_t nodeIndex,
+  trace::Ray const& ray,
+  double limit) -> bool
+{
+  if (nodes.size() == 1) { return true; }
+  auto const slab = trace::slabCollide(nodes[nodeIndex].box, ray);
+  return slab && slab->entry <= limit;
+}
+
+// The hierarchy is split in half at every level, so this is enough for any number of components.
+constexpr auto maxAnalyticDepth = std::size_t{ 64 };
+
+// Analytic components are not in the voxel space, but in a hierarchy of their own. Of the two children of a node
+// the one the ray enters first is visited first, so the closest collision is usually found early, and the subtrees
+// farther away than it are skipped.
+auto closestAnalyticCollision(trace::Ray const& ray,
+  std::vector<scene::Element> const& sceneElements,
+  render::VoxelSpace const& voxelSpace) -> std::pair<std::optional<trace::Collision>, std::size_t>
+{
+  auto closestCollision = std::optional<trace::Collision>{};
+  auto elementIndex = std::size_t{ 0 };
+  auto closestDistance = std::numeric_limits<double>::infinity();
+  auto const& nodes = voxelSpace.AnalyticNodes();
+  if (nodes.empty() || !entersNode(nodes, 0, ray, closestDistance)) {
+    return std::make_pair(closestCollision, elementIndex);
+  }
+
+  auto const objects = std::span{ voxelSpace.AnalyticNodeObjects() };
+  auto const checkLeaf = [&](render::AnalyticNode const& leaf) -> void {
+    for (auto const id : objects.subspan(leaf.first, leaf.count)) {
+      auto const collision = sceneElements[id].component->Collide(ray);
+      if (!collision) { continue; }
+      auto const distance = (collision->point - ray.Source()).Length();
+      if (distance < closestDistance) {
+        closestCollision = collision;
+        elementIndex = id;
+        closestDistance = distance;
+      }
+    }
+  };
+  if (nodes.size() == 1) {
+    checkLeaf(nodes.front());
+    return std::make_pair(closestCollision, elementIndex);
+  }
+
+  // the nodes to visit, with the distance the ray enters their box at
+  auto pending = std::array<std::pair<std::size_t, double>, maxAnalyticDepth>{};
+  pending[0] = std::make_pair(std::size_t{ 0 }, 0.0);
+  auto pendingCount = std::size_t{ 1 };
+  while (pendingCount > 0) {
+    auto const [nodeIndex, entry] = pending[--pendingCount];
+    if (entry > closestDistance) { continue; }
+    auto const& node = nodes[nodeIndex];
+    if (node.count == 0) {
+      auto const nearIndex = nodeIndex + 1;
+      auto const farIndex = nodes[nearIndex].skip;
+      auto near = trace::slabCollide(nodes[nearIndex].box, ray);
+      auto far = trace::slabCollide(nodes[farIndex].box, ray);
+      auto nearChild = std::make_pair(nearIndex, near ? near->entry : 0.0);
+      auto farChild = std::make_pair(farIndex, far ? far->entry : 0.0);
+      if (near && far && far->entry < near->entry) {
+        std::swap(near, far);
+        std::swap(nearChild, farChild);
+      }
+      if (far) { pending[pendingCount++] = farChild; }
+      if (near) { pending[pendingCount++] = nearChild; }
+    } else {
+      checkLeaf(node);
+    }
+  }
+  return std::make_pair(closestCollision, elementIndex);
+}
+
 auto closestCollisionWithDDA(trace::Ray ray,
   std::vector<scene::Element> const& sceneElements,
   render::VoxelSpace const& voxelSpace) -> std::pair<std::optional<trace::Collision>, std::size_t>
 {
-  auto dx = ray.Direction().Components()[0];
-  auto dy = ray.Direction().Components()[1];
-  auto dz = ray.Direction().Components()[2];
-  auto Td = voxelSpace.Dimension();
-
-  // Calculate scaling factor for each dimension
-  auto Sx = std::sqrt(1.0 + std::pow(dy / dx, 2.0) + std::pow(dz / dx, 2.0));
-  auto Sy = std::sqrt(1.0 + std::pow(dx / dy, 2.0) + std::pow(dz / dy, 2.0));
-  auto Sz = std::sqrt(1.0 + std::pow(dx / dz, 2.0) + std::pow(dy / dz, 2.0));
-  // Calculate step delta for each dimension
-  auto SDx = Sx * Td;
-  auto SDy = Sy * Td;
-  auto SDz = Sz * Td;
-
-  // Find starting position's voxel
-  auto const& boundingBox = voxelSpace.BoundingBox();
-  auto const collision = boundingBox.Collide(ray);
-  if (!collision) { std::make_pair(std::optional<trace::Collision>{}, std::size_t{ 0 }); }
-  // hit the voxel space from the outside => push the ray into it
-  if (collision->frontFace) { ray = trace::Ray{ collision->point - collision->normal * 0.00001, ray.Direction() }; }
-  auto voxelId = vec3ToVoxelId(ray.Source().Components(), Td);
-  // 'A' vector is the distance from the voxels starting corner
-  auto A = ray.Source()
-           - lina::Vec3{ static_cast<double>(voxelId[0]) * Td,
-               static_cast<double>(voxelId[1]) * Td,
-               static_cast<double>(voxelId[2]) * Td };
-
-  // Initialize step direction and initial travel distances on each dimension.
-  auto stepX = int64_t{ 1 };
-  auto stepY = int64_t{ 1 };
-  auto stepZ = int64_t{ 1 };
-  auto Tx = (Td - A[0]) * Sx;
-  auto Ty = (Td - A[1]) * Sy;
-  auto Tz = (Td - A[2]) * Sz;
-  if (dx < 0.0) {
-    stepX = int64_t{ -1 };
-    Tx = A[0] * Sx;
-  }
-  if (dy < 0.0) {
-    stepY = int64_t{ -1 };
-    Ty = A[1] * Sy;
-  }
-  if (dz < 0.0) {
-    stepZ = int64_t{ -1 };
-    Tz = A[2] * Sz;
-  }
-
-  auto closestTriangleCollision = std::optional<trace::MeshCollision>{};
-  auto objectId = std::size_t{ 0 };
-
-  auto const& voxelIdAabb = voxelSpace.IdAabb();
-  while (voxelIdAabb.minVoxelIdX <= voxelId[0] && voxelId[0] <= voxelIdAabb.maxVoxelIdX
-         && voxelIdAabb.minVoxelIdY <= voxelId[1] && voxelId[1] <= voxelIdAabb.maxVoxelIdY
-         && voxelIdAabb.minVoxelIdZ <= voxelId[2] && voxelId[2] <= voxelIdAabb.maxVoxelIdZ) {
-    // maxT represents the maximum distance our ray could travel given the current
-    // voxel and its trajectory
-    const auto maxT = std::min({ Tx, Ty, Tz });
+  auto const analyticCollision = closestAnalyticCollision(ray, sceneElements, voxelSpace);
+  return closestTriangleCollisionWithDDA(ray, sceneElements, voxelSpace, analyticCollision);
+}
 
-    auto triangleCandidates = voxelSpace.trianglesInVoxelById(voxelId);
+auto closestTriangleCollisionWithDDA(trace::Ray ray,
+  std::vector<scene::Element> const& sceneElements,
+  render::VoxelSpace const& voxelSpace,
+  std::pair<std::optional<trace::Collision>, std::size_t> const& closestSoFar)
+  -> std::pair<std::optional<trace::Collision>, std::size_t>
+{
+  auto walk = VoxelWalk{ ray, voxelSpace, closestSoFar };
+  while (walk.Walking()) {
+    auto triangleCandidates = voxelSpace.trianglesInVoxelById(walk.VoxelId());
     if (triangleCandidates) {
       for (auto const& id : *(triangleCandidates.value())) {
-        auto triangleCollision =
-          trace::triangleCollide(ray, sceneElements[id.object].component->GetMesh().triangleData, id.triangle);
-        if (triangleCollision) {
-          // A collision only matters if it is in the currently checked voxel!
-          // auto collisionVoxelId = vec3ToVoxelId(triangleCollision->collision.point.Components(), Td);
-          // Unfortunately, due to floating point issues we may get a voxelId which is not the current one
-          // even though we should hit the triangle right now.
-          // The solution is to keep track of the maxT distance we could see given the current voxel for a collision.
-          // If the distance is smaller then this maxT (+ a small epsilon as always), we can be sure we have hit
-          // the object.
-          if (triangleCollision->distance <= maxT + 0.00001) {
-            if (!closestTriangleCollision || closestTriangleCollision->distance > triangleCollision->distance) {
-              std::swap(closestTriangleCollision, triangleCollision);
-              objectId = id.object;
-            }
+        auto const& triangleData = sceneElements[id.object].component->GetMesh().triangleData;
+        walk.Consider(trace::triangleCollide(walk.Ray(), triangleData, id.triangle), id.object);
+      }
+    }
+    walk.Step();
+  }
+  return walk.Result();
+}
+
+// whatever a shadow ray is aimed at is at the distance itself, so it must not count as being in the way
+static auto occlusionLimit(double distance) -> double { return distance * (1.0 - 1e-6); }
+
+static auto trianglesOcclude(trace::Ray const& ray,
+  double limit,
+  std::vector<scene::Element> const& sceneElements,
+  render::VoxelSpace const& voxelSpace) -> bool
+{
+  if (voxelSpace.VoxelTriangles().empty()) { return false; }
+  // The walk only considers the triangles closer than a made up collision at the limit. Its index can't be the index
+  // of any element, so the result tells whether a triangle was found.
+  auto const noElement = std::numeric_limits<std::size_t>::max();
+  auto const atLimit = std::make_pair(
+    std::optional<trace::Collision>{ trace::Collision{ ray.Source() + (ray.Direction() * limit), ray.Direction() } },
+    noElement);
+  return closestTriangleCollisionWithDDA(ray, sceneElements, voxelSpace, atLimit).second != noElement;
+}
+
+auto isOccluded(trace::Ray const& ray,
+  double distance,
+  std::vector<scene::Element> const& sceneElements,
+  render::VoxelSpace const& voxelSpace) -> bool
+{
+  auto const limit = occlusionLimit(distance);
+  auto const& nodes = voxelSpace.AnalyticNodes();
+  auto const objects = std::span{ voxelSpace.AnalyticNodeObjects() };
+  auto nodeIndex = std::size_t{ 0 };
+  while (nodeIndex < nodes.size()) {
+    auto const& node = nodes[nodeIndex];
+    if (!entersNode(nodes, nodeIndex, ray, limit)) {
+      nodeIndex = node.skip;
+      continue;
+    }
+    for (auto const id : objects.subspan(node.first, node.count)) {
+      auto const collision = sceneElements[id].component->Collide(ray);
+      if (collision && (collision->point - ray.Source()).Length() < limit) { return true; }
+    }
+    ++nodeIndex;
+  }
+  return trianglesOcclude(ray, limit, sceneElements, voxelSpace);
+}
+
+// The index of no element, for the rays of a batch without a collision.
+constexpr auto noElement = std::numeric_limits<std::size_t>::max();
+
+// The closest analytic component of every ray of the batch closer than its bound, the bounds and the elements of the
+// buffers are set up by the caller. The bound of a ray is lowered to the distance of every closer collision, and its
+// element is set to the component's index. The objects of a node are checked in the same order as by the other
+// traversals, with the same comparison, so the same collision wins.
+static auto closestAnalyticInBatch(std::span<trace::Ray const> rays,
+  std::vector<scene::Element> const& sceneElements,
+  render::VoxelSpace const& voxelSpace,
+  RayBatchBuffers& buffers) -> void
+{
+  auto const& nodes = voxelSpace.AnalyticNodes();
+  auto const objects = std::span{ voxelSpace.AnalyticNodeObjects() };
+  auto nodeIndex = std::size_t{ 0 };
+  while (nodeIndex < nodes.size()) {
+    auto const& node = nodes[nodeIndex];
+    buffers.entering.clear();
+    for (auto i = std::size_t{ 0 }; i < rays.size(); ++i) {
+      if (entersNode(nodes, nodeIndex, rays[i], buffers.bounds[i])) { buffers.entering.emplace_back(i); }
+    }
+    if (buffers.entering.empty()) {
+      nodeIndex = node.skip;
+      continue;
+    }
+    if (node.count > 0) {
+      // the rays only have to be gathered when some of them miss the node
+      auto nodeRays = rays;
+      if (buffers.entering.size() < rays.size()) {
+        buffers.enteringRays.clear();
+        for (auto const i : buffers.entering) { buffers.enteringRays.emplace_back(rays[i]); }
+        nodeRays = buffers.enteringRays;
+      }
+      buffers.distances.resize(nodeRays.size());
+      for (auto const id : objects.subspan(node.first, node.count)) {
+        sceneElements[id].component->CollideDistances(nodeRays, buffers.distances);
+        for (auto k = std::size_t{ 0 }; k < buffers.entering.size(); ++k) {
+          auto const i = buffers.entering[k];
+          if (buffers.distances[k] < buffers.bounds[i]) {
+            buffers.bounds[i] = buffers.distances[k];
+            buffers.elements[i] = id;
           }
         }
       }
+    }
+    ++nodeIndex;
+  }
+}
 
-      if (closestTriangleCollision) { return std::make_pair(closestTriangleCollision->collision, objectId); }
+auto closestBatchCollisions(std::span<trace::Ray const> rays,
+  std::vector<scene::Element> const& sceneElements,
+  render::VoxelSpace const& voxelSpace,
+  RayBatchBuffers& buffers,
+  std::span<std::pair<std::optional<trace::Collision>, std::size_t>> collisions) -> void
+{
+  if (collisions.size() != rays.size()) {
+    throw std::logic_error(std::format("Invalid batch: {} rays, {} collisions", rays.size(), collisions.size()));
+  }
+  buffers.bounds.assign(rays.size(), std::numeric_limits<double>::infinity());
+  buffers.elements.assign(rays.size(), noElement);
+  closestAnalyticInBatch(rays, sceneElements, voxelSpace, buffers);
+  for (auto i = std::size_t{ 0 }; i < rays.size(); ++i) {
+    auto const elementIndex = buffers.elements[i];
+    collisions[i] = elementIndex == noElement
+                      ? std::make_pair(std::optional<trace::Collision>{}, std::size_t{ 0 })
+                      : std::make_pair(sceneElements[elementIndex].component->Collide(rays[i]), elementIndex);
+    if (!voxelSpace.VoxelTriangles().empty()) {
+      collisions[i] = closestTriangleCollisionWithDDA(rays[i], sceneElements, voxelSpace, collisions[i]);
     }
+  }
+}
+
+auto occludedShadowRays(std::span<ShadowRay const> shadowRays,
+  std::vector<scene::Element> const& sceneElements,
+  render::VoxelSpace const& voxelSpace,
+  RayBatchBuffers& buffers,
+  std::vector<bool>& occluded) -> void
+{
+  buffers.rays.clear();
+  buffers.bounds.clear();
+  for (auto const& shadowRay : shadowRays) {
+    buffers.rays.emplace_back(shadowRay.ray);
+    buffers.bounds.emplace_back(occlusionLimit(shadowRay.distance));
+  }
+  buffers.elements.assign(shadowRays.size(), noElement);
+  closestAnalyticInBatch(buffers.rays, sceneElements, voxelSpace, buffers);
+  occluded.resize(shadowRays.size());
+  for (auto i = std::size_t{ 0 }; i < shadowRays.size(); ++i) {
+    occluded[i] = buffers.elements[i] != noElement
+                  || trianglesOcclude(shadowRays[i].ray, buffers.bounds[i], sceneElements, voxelSpace);
+  }
+}
 
-    if (Tx < Ty) {
-      if (Tx < Tz) {
-        voxelId[0] += stepX;
-        Tx += SDx;
-        continue;
+// The components are iterated in the outer loop, so each of them is fetched once for the whole packet, and the
+// collisions with the same component are calculated back to back.
+// The same goes for the triangles. Every ray walks through the voxel space on its own, but the rays being in the
+// same voxel are checked together, triangle by triangle. As long as the rays are coherent, this means a single
+// lookup and a single pass over the triangles of each voxel for the whole packet. When they drift apart, the
+// voxels are checked for fewer and fewer rays at once, down to one at a time.
+auto closestPacketCollisions(std::span<trace::Ray const> rays,
+  std::vector<scene::Element> const& sceneElements,
+  render::VoxelSpace const& voxelSpace,
+  std::span<std::pair<std::optional<trace::Collision>, std::size_t>> collisions) -> void
+{
+  if (rays.size() > packetSize || collisions.size() != rays.size()) {
+    throw std::logic_error(std::format("Invalid packet size: {} rays, {} collisions", rays.size(), collisions.size()));
+  }
+  auto closestDistances = std::array<double, packetSize>{};
+  std::ranges::fill(closestDistances, std::numeric_limits<double>::infinity());
+  std::ranges::fill(collisions, std::make_pair(std::optional<trace::Collision>{}, std::size_t{ 0 }));
+
+  // A node is entered if any of the rays enters its box, then its objects are checked for those rays only.
+  auto const& nodes = voxelSpace.AnalyticNodes();
+  auto const objects = std::span{ voxelSpace.AnalyticNodeObjects() };
+  auto entering = std::array<std::size_t, packetSize>{};
+  auto nodeIndex = std::size_t{ 0 };
+  while (nodeIndex < nodes.size()) {
+    auto const& node = nodes[nodeIndex];
+    auto enteringCount = std::size_t{ 0 };
+    for (auto i = std::size_t{ 0 }; i < rays.size(); ++i) {
+      if (entersNode(nodes, nodeIndex, rays[i], closestDistances[i])) { entering[enteringCount++] = i; }
+    }
+    if (enteringCount == 0) {
+      nodeIndex = node.skip;
+      continue;
+    }
+    for (auto const id : objects.subspan(node.first, node.count)) {
+      auto const& component = *sceneElements[id].component;
+      for (auto k = std::size_t{ 0 }; k < enteringCount; ++k) {
+        auto const i = entering[k];
+        auto const collision = component.Collide(rays[i]);
+        if (!collision) { continue; }
+        auto const distance = (collision->point - rays[i].Source()).Length();
+        if (distance < closestDistances[i]) {
+          collisions[i] = std::make_pair(collision, id);
+          closestDistances[i] = distance;
+        }
       }
-    } else {
-      if (Ty < Tz) {
-        voxelId[1] += stepY;
-        Ty += SDy;
-        continue;
+    }
+    ++nodeIndex;
+  }
+  if (voxelSpace.VoxelTriangles().empty()) { return; }
+
+  // The walks live on the stack, the packet traversal is in the hot loop and shouldn't allocate.
+  auto walkStorage = std::array<std::optional<VoxelWalk>, packetSize>{};
+  auto const walks = std::span{ walkStorage }.first(rays.size());
+  for (auto i = std::size_t{ 0 }; i < rays.size(); ++i) { walks[i].emplace(rays[i], voxelSpace, collisions[i]); }
+
+  auto sameVoxel = std::array<std::size_t, packetSize>{};
+  while (true) {
+    auto const leader =
+      std::ranges::find_if(walks, [](std::optional<VoxelWalk> const& walk) -> bool { return walk->Walking(); });
+    if (leader == walks.end()) { break; }
+    auto const voxelId = (*leader)->VoxelId();
+
+    auto sameVoxelCount = std::size_t{ 0 };
+    for (auto i = std::size_t{ 0 }; i < walks.size(); ++i) {
+      if (walks[i]->Walking() && walks[i]->VoxelId() == voxelId) { sameVoxel[sameVoxelCount++] = i; }
+    }
+
+    auto triangleCandidates = voxelSpace.trianglesInVoxelById(voxelId);
+    if (triangleCandidates) {
+      for (auto const& id : *(triangleCandidates.value())) {
+        auto const& triangleData = sceneElements[id.object].component->GetMesh().triangleData;
+        for (auto k = std::size_t{ 0 }; k < sameVoxelCount; ++k) {
+          auto& walk = *walks[sameVoxel[k]];
+          walk.Consider(trace::triangleCollide(walk.Ray(), triangleData, id.triangle), id.object);
+        }
       }
     }
-    voxelId[2] += stepZ;
-    Tz += SDz;
+    for (auto k = std::size_t{ 0 }; k < sameVoxelCount; ++k) { walks[sameVoxel[k]]->Step(); }
   }
 
-  if (closestTriangleCollision) { return std::make_pair(closestTriangleCollision->collision, objectId); }
-  return std::make_pair(std::optional<trace::Collision>{}, std::size_t{ 0 });
+  for (auto i = std::size_t{ 0 }; i < rays.size(); ++i) { collisions[i] = walks[i]->Result(); }
 }
-// NOLINTEND(readability-function-cognitive-complexity)
 
 auto rayColor(trace::Ray const& ray,
   std::vector<scene::Element> const& sceneElements,
+  trace::MaterialTable const& materials,
   render::VoxelSpace const& voxelSpace,
   int masterLightIndex,
-  std::mt19937& randomGenerator,
+  trace::Sampler& sampler,
   std::size_t depth,
   bool useSkybox) -> lina::Vec3
 {
   if (depth == 0) { return lina::Vec3{ 0.0, 0.0, 0.0 }; }
 
-  auto [collision, elementIndex] = closestCollisionWithDDA(ray, sceneElements, voxelSpace);
-  // auto [collision, elementIndex] = closestCollision(ray, sceneElements);
+  auto const closest = closestCollisionWithDDA(ray, sceneElements, voxelSpace);
+  // auto const closest = closestCollision(ray, sceneElements);
+  return collisionColor(
+    ray, closest, sceneElements, materials, voxelSpace, masterLightIndex, sampler, depth, useSkybox, true);
+}
 
-  if (collision) {
-    auto const& material = sceneElements[elementIndex].material;
-    auto const emission = material->Emit(collision.value());
-    auto scattering = material->Scatter(ray, collision.value(), randomGenerator);
-    if (!scattering) { return emission; }
+// The paths are followed in a loop, carrying the product of the attenuations and sampling weights so far as the
+// throughput. With the roulette, after rouletteDepth bounces a path survives each bounce with a probability following
+// its throughput, and the survivors are scaled up to make up for the ones ended, which keeps the estimate unbiased.
+// The roulette comes before the scattering: a direction sampled towards the light gets a small weight, which the
+// emission found at its end makes up for, so deciding after the weight would end exactly the paths about to reach it.
+constexpr auto maxSurvivalProbability = 0.95;
 
-    auto scatterColor = lina::Vec3{};
+auto collisionColor(trace::Ray const& ray,
+  std::pair<std::optional<trace::Collision>, std::size_t> const& closest,
+  std::vector<scene::Element> const& sceneElements,
+  trace::MaterialTable const& materials,
+  render::VoxelSpace const& voxelSpace,
+  int masterLightIndex,
+  trace::Sampler& sampler,
+  std::size_t depth,
+  bool useSkybox,
+  bool russianRoulette) -> lina::Vec3
+{
+  auto color = lina::Vec3{ 0.0, 0.0, 0.0 };
+  auto throughput = lina::Vec3{ 1.0, 1.0, 1.0 };
+  auto currentRay = ray;
+  auto currentClosest = closest;
+  for (auto bounce = std::size_t{ 0 }; bounce < depth; ++bounce) {
+    if (bounce > 0) { currentClosest = closestCollisionWithDDA(currentRay, sceneElements, voxelSpace); }
+    auto const& [collision, elementIndex] = currentClosest;
+    if (!collision) {
+      if (useSkybox) {
+        auto a = 0.5 * (currentRay.Direction()[2] + 1.0);
+        color += throughput * ((1.0 - a) * lina::Vec3{ 1.0, 1.0, 1.0 } + a * lina::Vec3{ 0.5, 0.7, 1.0 });
+      }
+      break;
+    }
+
+    sampler.NextBounce();
+    color += throughput * materials.Emit(elementIndex, collision.value());
+    // whatever would be scattered from here could not be traced any further
+    if (bounce + 1 == depth) { break; }
+    if (russianRoulette && bounce >= rouletteDepth) {
+      auto const survivalProbability =
+        std::min(std::max({ throughput[0], throughput[1], throughput[2] }), maxSurvivalProbability);
+      if (trace::randomUniformDouble(sampler, 0.0, 1.0) >= survivalProbability) { break; }
+      throughput /= survivalProbability;
+    }
+    auto scattering = materials.Scatter(elementIndex, currentRay, collision.value(), sampler);
+    if (!scattering) { break; }
+
+    auto weight = scattering.value().attenuation;
     if (std::holds_alternative<trace::Ray>(scattering.value().type)) {
-      auto scatteredRay = std::get<trace::Ray>(scattering.value().type);
-      scatterColor =
-        scattering.value().attenuation
-        * rayColor(scatteredRay, sceneElements, voxelSpace, masterLightIndex, randomGenerator, depth - 1, useSkybox);
+      currentRay = std::get<trace::Ray>(scattering.value().type);
     } else if (std::holds_alternative<trace::PDF>(scattering.value().type)) {
       // combined
       if (masterLightIndex > -1 && masterLightIndex < static_cast<int>(sceneElements.size())) {
-        auto lightPDF =
-          sceneElements[masterLightIndex].component->SamplingPDF(randomGenerator, collision.value().point);
-        auto materialPDF = std::get<trace::PDF>(scattering.value().type);
+        auto const lightPDF = sceneElements[masterLightIndex].component->SamplingPDF(collision.value().point);
+        auto const& materialPDF = std::get<trace::PDF>(scattering.value().type);
         auto sampleDirection = lina::Vec3{};
-        if (trace::randomUniformDouble(randomGenerator, 0.0, 1.0) < 0.5) {
-          sampleDirection = lightPDF.GenerateSample();
+        if (trace::randomUniformDouble(sampler, 0.0, 1.0) < 0.5) {
+          sampleDirection = lightPDF.GenerateSample(sampler);
         } else {
-          sampleDirection = materialPDF.GenerateSample();
+          sampleDirection = materialPDF.GenerateSample(sampler);
         }
 
-        auto scatteredRay = trace::Ray{ materialPDF.AdjustedCollisionPoint(), sampleDirection };
+        currentRay = trace::Ray{ scattering.value().origin, sampleDirection };
 
         auto samplingPDFValue =
-          (0.5 * lightPDF.Evaluate(scatteredRay.Direction())) + (0.5 * materialPDF.Evaluate(scatteredRay.Direction()));
-
-        auto scatteringPDFValue = materialPDF.Evaluate(scatteredRay.Direction());
+          (0.5 * lightPDF.Evaluate(currentRay.Direction())) + (0.5 * materialPDF.Evaluate(currentRay.Direction()));
+        if (samplingPDFValue <= 0.0) { break; }
 
-        auto incomingColor =
-          rayColor(scatteredRay, sceneElements, voxelSpace, masterLightIndex, randomGenerator, depth - 1, useSkybox);
-        scatterColor = (scattering.value().attenuation * scatteringPDFValue * incomingColor) / samplingPDFValue;
+        auto scatteringPDFValue = materialPDF.Evaluate(currentRay.Direction());
+        weight = (weight * scatteringPDFValue) / samplingPDFValue;
       } else {
-        // normal sampling
-        auto materialPDF = std::get<trace::PDF>(scattering.value().type);
-        auto scatteredRay = trace::Ray{ materialPDF.AdjustedCollisionPoint(), materialPDF.GenerateSample() };
-
-        auto scatteringPDFValue = materialPDF.Evaluate(scatteredRay.Direction());
-        auto pdfValue = scatteringPDFValue;
-
-        scatterColor =
-          (scattering.value().attenuation * scatteringPDFValue
-            * rayColor(
-              scatteredRay, sceneElements, voxelSpace, masterLightIndex, randomGenerator, depth - 1, useSkybox))
-          / pdfValue;
+        // normal sampling, the scattering PDF and the sampling PDF cancel out
+        auto const& materialPDF = std::get<trace::PDF>(scattering.value().type);
+        currentRay = trace::Ray{ scattering.value().origin, materialPDF.GenerateSample(sampler) };
       }
     } else {
       throw std::logic_error("Unhandled scattering type.");
     }
+    throughput = throughput * weight;
+  }
+  return color;
+}
+
+auto powerHeuristic(double sampledPDFValue, double otherPDFValue) -> double
+{
+  auto const sampled = sampledPDFValue * sampledPDFValue;
+  auto const other = otherPDFValue * otherPDFValue;
+  if (sampled + other == 0.0) { return 0.0; }
+  return sampled / (sampled + other);
+}
 
-    return emission + scatterColor;
+// The light sample is taken from the light's sampling PDF, made from its record in the light sampler, so its weight
+// is the scattering PDF over the light's PDF and the probability of picking the light. The shadow ray goes towards
+// the light, the emission is taken where it hits the light, and only counts if nothing else is closer.
+// The emission the scattered rays find on a light after a diffuse bounce could have been found by the light sample
+// too. Without MIS it is dropped, with MIS both are kept, each weighted by the power heuristic of the density of its
+// own strategy against the other one's. Emission is counted in full for the camera rays, after specular bounces,
+// which have no PDF to sample lights with, and on the emitters the light sampler doesn't know about.
+auto shadeCollision(PathState& path,
+  std::pair<std::optional<trace::Collision>, std::size_t> const& closest,
+  std::vector<scene::Element> const& sceneElements,
+  trace::MaterialTable const& materials,
+  LightSampler const& lightSampler,
+  trace::Sampler& sampler,
+  std::size_t depth,
+  bool useSkybox,
+  bool multipleImportanceSampling,
+  bool russianRoulette) -> std::optional<ShadowRay>
+{
+  auto shadowRay = std::optional<ShadowRay>{};
+  auto const& [collision, elementIndex] = closest;
+  if (!collision) {
+    if (useSkybox) {
+      auto a = 0.5 * (path.ray.Direction()[2] + 1.0);
+      path.color += path.throughput * ((1.0 - a) * lina::Vec3{ 1.0, 1.0, 1.0 } + a * lina::Vec3{ 0.5, 0.7, 1.0 });
+    }
+    path.active = false;
+    return shadowRay;
+  }
+
+  sampler.NextBounce();
+  auto const lightProbability =
+    path.lightSampled ? lightSampler.Probability(path.previousPoint, path.previousNormal, elementIndex) : 0.0;
+  if (lightProbability == 0.0) {
+    path.color += path.throughput * materials.Emit(elementIndex, collision.value());
+  } else if (multipleImportanceSampling) {
+    auto const lightPDFValue =
+      lightProbability * lightSampler.SamplingPDF(elementIndex, path.previousPoint).Evaluate(path.ray.Direction());
+    path.color += path.throughput * materials.Emit(elementIndex, collision.value())
+                  * powerHeuristic(path.scatteringPDFValue, lightPDFValue);
+  }
+  path.active = false;
+  if (path.bounce + 1 >= depth) { return shadowRay; }
+  if (russianRoulette && path.bounce >= rouletteDepth) {
+    auto const survivalProbability =
+      std::min(std::max({ path.throughput[0], path.throughput[1], path.throughput[2] }), maxSurvivalProbability);
+    if (trace::randomUniformDouble(sampler, 0.0, 1.0) >= survivalProbability) { return shadowRay; }
+    path.throughput /= survivalProbability;
   }
+  auto scattering = materials.Scatter(elementIndex, path.ray, collision.value(), sampler);
+  if (!scattering) { return shadowRay; }
 
-  if (useSkybox) {
-    auto a = 0.5 * (ray.Direction()[2] + 1.0);
-    return (1.0 - a) * lina::Vec3{ 1.0, 1.0, 1.0 } + a * lina::Vec3{ 0.5, 0.7, 1.0 };
+  auto const& attenuation = scattering.value().attenuation;
+  if (std::holds_alternative<trace::Ray>(scattering.value().type)) {
+    path.ray = std::get<trace::Ray>(scattering.value().type);
+    path.lightSampled = false;
+  } else if (std::holds_alternative<trace::PDF>(scattering.value().type)) {
+    auto const& materialPDF = std::get<trace::PDF>(scattering.value().type);
+    auto const& source = scattering.value().origin;
+    auto const choice = lightSampler.Pick(
+      collision.value().point, collision.value().normal, trace::randomUniformDouble(sampler, 0.0, 1.0));
+    if (choice) {
+      auto const& light = sceneElements[choice->elementIndex];
+      auto const lightPDF = lightSampler.SamplingPDF(choice->elementIndex, collision.value().point);
+      auto const towardsLight = trace::Ray{ source, lightPDF.GenerateSample(sampler) };
+      auto const lightPDFValue = lightPDF.Evaluate(towardsLight.Direction());
+      auto const lightCollision = light.component->Collide(towardsLight);
+      if (lightPDFValue > 0.0 && lightCollision) {
+        auto const lightSamplePDFValue = lightPDFValue * choice->probability;
+        auto const shadowScatteringPDFValue = materialPDF.Evaluate(towardsLight.Direction());
+        auto const misWeight =
+          multipleImportanceSampling ? powerHeuristic(lightSamplePDFValue, shadowScatteringPDFValue) : 1.0;
+        shadowRay = ShadowRay{ towardsLight,
+          (lightCollision->point - towardsLight.Source()).Length(),
+          path.throughput * attenuation * materials.Emit(choice->elementIndex, lightCollision.value())
+            * (misWeight * shadowScatteringPDFValue / lightSamplePDFValue) };
+      }
+    }
+    // the scattering PDF and the sampling PDF cancel out
+    path.ray = trace::Ray{ source, materialPDF.GenerateSample(sampler) };
+    path.lightSampled = choice.has_value();
+    path.previousPoint = collision.value().point;
+    path.previousNormal = collision.value().normal;
+    if (path.lightSampled && multipleImportanceSampling) {
+      path.scatteringPDFValue = materialPDF.Evaluate(path.ray.Direction());
+    }
+  } else {
+    throw std::logic_error("Unhandled scattering type.");
   }
-  return lina::Vec3{ 0.0, 0.0, 0.0 };
+  path.throughput = path.throughput * attenuation;
+  path.active = true;
+  ++path.bounce;
+  return shadowRay;
+}
+
+auto lightSamplingColor(trace::Ray const& ray,
+  std::pair<std::optional<trace::Collision>, std::size_t> const& closest,
+  std::vector<scene::Element> const& sceneElements,
+  trace::MaterialTable const& materials,
+  render::VoxelSpace const& voxelSpace,
+  LightSampler const& lightSampler,
+  trace::Sampler& sampler,
+  std::size_t depth,
+  bool useSkybox,
+  bool multipleImportanceSampling,
+  bool russianRoulette) -> lina::Vec3
+{
+  auto path = PathState{ ray };
+  auto currentClosest = closest;
+  while (path.active) {
+    if (path.bounce > 0) { currentClosest = closestCollisionWithDDA(path.ray, sceneElements, voxelSpace); }
+    auto const shadowRay = shadeCollision(path,
+      currentClosest,
+      sceneElements,
+      materials,
+      lightSampler,
+      sampler,
+      depth,
+      useSkybox,
+      multipleImportanceSampling,
+      russianRoulette);
+    if (shadowRay && !isOccluded(shadowRay->ray, shadowRay->distance, sceneElements, voxelSpace)) {
+      path.color += shadowRay->contribution;
+    }
+  }
+  return path.color;
+}
+
+auto integratorFromName(std::string_view name) -> Integrator
+{
+  if (name == "path") { return Integrator::Path; }
+  if (name == "nee") { return Integrator::Nee; }
+  if (name == "mis") { return Integrator::Mis; }
+  throw std::invalid_argument(std::format("Unknown integrator: '{}'. Expected one of: path, nee, mis", name));
+}
+
+// Parsed as a signed number, std::stoull would silently wrap the negative ones around.
+auto threadCountFromText(std::string const& text) -> std::size_t
+{
+  auto parsedLength = std::size_t{ 0 };
+  auto threadCount = 0LL;
+  try {
+    threadCount = std::stoll(text, &parsedLength);
+  } catch (std::exception const&) {
+    throw std::invalid_argument(std::format("Not a number of threads: '{}'", text));
+  }
+  if (parsedLength != text.size()) { throw std::invalid_argument(std::format("Not a number of threads: '{}'", text)); }
+  if (threadCount < 1 || static_cast<unsigned long long>(threadCount) > maxThreadCount) {
+    throw std::invalid_argument(
+      std::format("The number of threads has to be between 1 and {}. Got: {}", maxThreadCount, threadCount));
+  }
+  return static_cast<std::size_t>(threadCount);
+}
+
+// Only digits are accepted, std::stoull would skip leading whitespace, wrap the negative numbers around and ignore
+// whatever follows the number.
+auto seedFromText(std::string const& text) -> std::uint64_t
+{
+  if (text.empty() || !std::ranges::all_of(text, [](char c) -> bool { return c >= '0' && c <= '9'; })) {
+    throw std::invalid_argument(std::format("Not a seed: '{}'", text));
+  }
+  try {
+    return static_cast<std::uint64_t>(std::stoull(text));
+  } catch (std::out_of_range const&) {
+    throw std::invalid_argument(std::format("The seed has to be at most {}. Got: {}",
+      std::numeric_limits<std::uint64_t>::max(), text));
+  }
+}
+
+auto sampleCountFromText(std::string const& text) -> std::size_t
+{
+  if (text.empty() || !std::ranges::all_of(text, [](char c) -> bool { return c >= '0' && c <= '9'; })) {
+    throw std::invalid_argument(std::format("Not a number of samples: '{}'", text));
+  }
+  auto sampleCount = 0ULL;
+  try {
+    sampleCount = std::stoull(text);
+  } catch (std::out_of_range const&) {
+    sampleCount = std::numeric_limits<unsigned long long>::max();
+  }
+  if (sampleCount < 1 || sampleCount > sampleCountLimit) {
+    throw std::invalid_argument(
+      std::format("The number of samples has to be between 1 and {}. Got: {}", sampleCountLimit, text));
+  }
+  return static_cast<std::size_t>(sampleCount);
+}
+
+auto positiveNumberFromText(std::string const& text) -> double
+{
+  auto parsedLength = std::size_t{ 0 };
+  auto number = 0.0;
+  try {
+    number = std::stod(text, &parsedLength);
+  } catch (std::exception const&) {
+    throw std::invalid_argument(std::format("Not a number: '{}'", text));
+  }
+  if (parsedLength != text.size()) { throw std::invalid_argument(std::format("Not a number: '{}'", text)); }
+  if (!std::isfinite(number) || number <= 0.0) {
+    throw std::invalid_argument(std::format("The number has to be finite and above zero. Got: {}", text));
+  }
+  return number;
+}
+
+// Converting a longer duration into the integer ticks of the steady clock would overflow.
+auto timeLimitFromText(std::string const& text) -> std::chrono::duration<double>
+{
+  auto const timeLimit = std::chrono::duration<double>{ positiveNumberFromText(text) };
+  if (timeLimit >= std::chrono::duration<double>{ std::chrono::steady_clock::duration::max() }) {
+    throw std::invalid_argument(std::format("The time limit is too long. Got: {} seconds", text));
+  }
+  return timeLimit;
+}
+
+auto engineFromName(std::string_view name) -> Engine
+{
+  if (name == "depth-first") { return Engine::DepthFirst; }
+  if (name == "wavefront") { return Engine::Wavefront; }
+  throw std::invalid_argument(std::format("Unknown engine: '{}'. Expected one of: depth-first, wavefront", name));
 }
 
 // applying gamma correction to the colors
@@ -267,98 +742,323 @@ auto writeColor(lina::Vec3 const& color, std::ostream& outputStream) -> void
                << static_cast<int>(255.9999 * blue) << '\n';
 }
 
-auto linearPartition(scene::Composition sceneComposition, std::ostream& outputStream) -> void
+auto linearPartition(scene::Composition sceneComposition, RenderOptions const& options, std::ostream& outputStream)
+  -> void
 {
+  if (options.engine == Engine::Wavefront && options.integrator == Integrator::Path) {
+    throw std::invalid_argument("The wavefront engine only works with the 'nee' and 'mis' integrators");
+  }
   auto [camera, sampleCount, rayDepth, sceneElements, masterLightIndex, useSkybox] = std::move(sceneComposition);
-  auto meshes = std::vector<trace::Mesh>{};
-  for (auto const& sceneElement : sceneElements) { meshes.emplace_back(sceneElement.component->GetMesh()); }
-  auto voxelSpace = render::VoxelSpace{ meshes };
+  auto components = std::vector<trace::Component const*>{};
+  for (auto const& sceneElement : sceneElements) { components.emplace_back(sceneElement.component.get()); }
+  auto voxelSpace = render::VoxelSpace{ components };
+  auto sceneMaterials = std::vector<trace::Material const*>{};
+  for (auto const& sceneElement : sceneElements) { sceneMaterials.emplace_back(sceneElement.material.get()); }
+  auto const materials = trace::MaterialTable{ sceneMaterials };
+  auto const lightSampler = LightSampler{ sceneElements };
   auto imageWidth = camera.ImageWidth();
   auto imageHeight = camera.ImageHeight();
 
   auto const hardwareThreads = std::size_t{ std::thread::hardware_concurrency() };
   // if we can't get the actual number of available hardware threads then we just default to four
-  auto const numberOfThreads = (hardwareThreads == std::size_t{ 0 } ? std::size_t{ 4 } : hardwareThreads);
+  auto numberOfThreads = (hardwareThreads == std::size_t{ 0 } ? std::size_t{ 4 } : hardwareThreads);
+  if (options.threadCount > 0) { numberOfThreads = options.threadCount; }
 
   std::cerr << "Number of threads used: " << numberOfThreads << '\n';
 
+  // every sample draws its random numbers from a stream derived from this seed and its own position, so the threads
+  // can share it
+  auto seed = std::uint64_t{ 0 };
+  if (options.seed) {
+    seed = options.seed.value();
+  } else {
+    auto randomDevice = std::random_device{};
+    seed = (std::uint64_t{ randomDevice() } << 32U) | randomDevice();
+  }
+  // printed so that any render can be repeated exactly with --seed
+  std::cerr << "Seed used: " << seed << '\n';
+
+  auto const adaptive = options.adaptiveThreshold.has_value();
+  auto const progressive = options.timeLimit.has_value() || options.targetError.has_value();
+  // The most samples a pixel takes. A progressive render goes on until it is stopped by the time limit or the target
+  // error, unless capped explicitly.
+  auto maxSampleCount = sampleCount;
+  if (progressive) {
+    maxSampleCount = options.maxSampleCount.value_or(sampleCountLimit);
+  } else if (adaptive) {
+    maxSampleCount = options.maxSampleCount.value_or(sampleCount);
+  }
+  if (maxSampleCount < 1 || maxSampleCount > sampleCountLimit) {
+    throw std::invalid_argument(std::format(
+      "The most samples of a pixel have to be between 1 and {}. Got: {}", sampleCountLimit, maxSampleCount));
+  }
+  if (adaptive) {
+    auto const adaptiveThreshold = options.adaptiveThreshold.value();
+    if (!std::isfinite(adaptiveThreshold) || adaptiveThreshold <= 0.0) {
+      throw std::invalid_argument(
+        std::format("The adaptive threshold has to be finite and above zero. Got: {}", adaptiveThreshold));
+    }
+    if (options.minSampleCount
+        && (options.minSampleCount.value() < 1 || options.minSampleCount.value() > maxSampleCount)) {
+      throw std::invalid_argument(
+        std::format("The least samples of a pixel have to be between 1 and the most, {}. Got: {}",
+          maxSampleCount,
+          options.minSampleCount.value()));
+    }
+  }
+  if (options.targetError) {
+    auto const targetError = options.targetError.value();
+    if (!std::isfinite(targetError) || targetError <= 0.0) {
+      throw std::invalid_argument(
+        std::format("The target error has to be finite and above zero. Got: {}", targetError));
+    }
+    if (!options.timeLimit && !options.maxSampleCount) {
+      throw std::invalid_argument("A target error needs a time limit or a maximum sample count as well");
+    }
+  }
+  auto const minSampleCount =
+    adaptive ? std::min(options.minSampleCount.value_or(defaultMinSampleCount), maxSampleCount) : maxSampleCount;
+  auto const threshold = options.adaptiveThreshold.value_or(0.0);
+  // the samplers that spread their points over the pixels need to know about how many samples to expect
+  auto const expectedSampleCount = options.maxSampleCount.value_or(sampleCount);
+
+  auto const startTime = std::chrono::steady_clock::now();
+  auto const timeLimit = options.timeLimit.value_or(std::chrono::duration<double>{ 0.0 });
+  // longer limits would overflow the ticks of the clock, first of the limit, then of the deadline
+  if (options.timeLimit
+      && !(timeLimit.count() > 0.0
+           && timeLimit < std::chrono::duration<double>{ std::chrono::steady_clock::duration::max() }
+           && std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeLimit)
+                < std::chrono::steady_clock::time_point::max() - startTime)) {
+    throw std::invalid_argument(
+      std::format("The time limit has to be above zero and fit the steady clock. Got: {} seconds", timeLimit.count()));
+  }
+  auto const deadline = startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeLimit);
+
+  // every thread only touches its own pixels
+  auto estimates = std::vector<PixelEstimate>(imageWidth * imageHeight);
+
+  // Takes samples until each pixel of the chunk has sampleLimit of them, and returns the number of samples taken.
   // reportProgress should only be true for one thread at a time
   // capture sceneElements and samplingRays as const refs, because there should be no circumstance where they need
   // to be changed during rendering (and we don't want to copy them)
-  auto renderChunk =
-    [imageWidth,
-      numberOfThreads,
-      camera = std::cref(camera),
-      sampleCount,
-      rayDepth,
-      sceneElements = std::cref(sceneElements),
-      voxelSpace = std::cref(voxelSpace),
-      masterLightIndex,
-      useSkybox](std::size_t startIndex, std::size_t endIndex, bool reportProgress = false) -> std::vector<lina::Vec3> {
-    auto maxElementCount = ceil2(endIndex, numberOfThreads);
-    auto pixelColors = std::vector<lina::Vec3>();
-    pixelColors.reserve(maxElementCount);
+  auto renderChunk = [imageWidth,
+                       numberOfThreads,
+                       camera = std::cref(camera),
+                       minSampleCount,
+                       expectedSampleCount,
+                       adaptive,
+                       threshold,
+                       progressive,
+                       deadline,
+                       rayDepth,
+                       sceneElements = std::cref(sceneElements),
+                       materials = std::cref(materials),
+                       voxelSpace = std::cref(voxelSpace),
+                       lightSampler = std::cref(lightSampler),
+                       masterLightIndex,
+                       useSkybox,
+                       seed,
+                       options,
+                       &estimates](std::size_t startIndex,
+                       std::size_t endIndex,
+                       std::size_t sampleLimit,
+                       bool reportProgress = false) -> std::size_t {
+    auto const pixelCount = startIndex < endIndex ? ceil2(endIndex - startIndex, numberOfThreads) : 0;
+    auto pixelsDone = std::size_t{ 0 };
+    auto samplesTaken = std::size_t{ 0 };
 
-    auto randomDevice = std::random_device{};
-    auto randomGenerator = std::mt19937{ randomDevice() };
+    auto sampler =
+      trace::buildSampler(options.sampler, seed, imageWidth, camera.get().ImageHeight(), expectedSampleCount);
+    auto packetRays = std::array<trace::Ray, packetSize>{};
+    auto packetCollisions = std::array<std::pair<std::optional<trace::Collision>, std::size_t>, packetSize>{};
+    auto const multiSampled = progressive || sampleLimit > 1;
+    auto const multipleImportanceSampling = options.integrator == Integrator::Mis;
+
+    // the depth first engine traces the samples of a pixel in packets for the primary rays
+    auto traceDepthFirst = [&packetRays,
+                             &packetCollisions,
+                             &sampler,
+                             imageWidth,
+                             multiSampled,
+                             multipleImportanceSampling,
+                             camera,
+                             rayDepth,
+                             sceneElements,
+                             materials,
+                             voxelSpace,
+                             lightSampler,
+                             masterLightIndex,
+                             useSkybox,
+                             &options](std::span<PixelSample const> samples, std::span<lina::Vec3> colors) -> void {
+      for (auto start = std::size_t{ 0 }; start < samples.size(); start += packetSize) {
+        auto const currentPacketSize = std::min(packetSize, samples.size() - start);
+        auto const rays = std::span{ packetRays }.first(currentPacketSize);
+        auto const collisions = std::span{ packetCollisions }.first(currentPacketSize);
+        for (auto k = std::size_t{ 0 }; k < currentPacketSize; ++k) {
+          auto const [pixelId, sample] = samples[start + k];
+          sampler->StartPath(pixelId, sample);
+          rays[k] = camera.get().GetSampleRayAt(pixelId / imageWidth, pixelId % imageWidth, *sampler, multiSampled);
+        }
+        closestPacketCollisions(rays, sceneElements, voxelSpace, collisions);
+        for (auto k = std::size_t{ 0 }; k < currentPacketSize; ++k) {
+          // back to the path of the sample, the bounces continue from its camera ray
+          sampler->StartPath(samples[start + k].pixelId, samples[start + k].sample);
+          if (options.integrator != Integrator::Path) {
+            colors[start + k] = lightSamplingColor(rays[k],
+              collisions[k],
+              sceneElements,
+              materials,
+              voxelSpace,
+              lightSampler,
+              *sampler,
+              rayDepth,
+              useSkybox,
+              multipleImportanceSampling,
+              options.russianRoulette);
+          } else {
+            colors[start + k] = collisionColor(rays[k],
+              collisions[k],
+              sceneElements,
+              materials,
+              voxelSpace,
+              masterLightIndex,
+              *sampler,
+              rayDepth,
+              useSkybox,
+              options.russianRoulette);
+          }
+        }
+      }
+    };
 
-    for (auto pixelId = startIndex; pixelId < endIndex; pixelId += numberOfThreads) {
+    // The pixels are taken in groups, a single pixel for the depth first engine, and wavefrontPixelCount of them for
+    // the wavefront engine. Every round takes the next packet of samples of every pixel of the group still in need of
+    // them, in adaptive mode a pixel is checked after every packet, once it has its minimum number of samples.
+    auto const groupSize = options.engine == Engine::Wavefront ? wavefrontPixelCount : std::size_t{ 1 };
+    auto group = std::vector<std::size_t>{};
+    auto samples = std::vector<PixelSample>{};
+    auto colors = std::vector<lina::Vec3>{};
+    for (auto groupStart = startIndex; groupStart < endIndex; groupStart += numberOfThreads * groupSize) {
+      group.clear();
+      for (auto pixelId = groupStart; pixelId < endIndex && group.size() < groupSize; pixelId += numberOfThreads) {
+        group.emplace_back(pixelId);
+      }
       if (reportProgress) {
-        // It complains for static_cast<double>(endIndex / numberOfThreads), but we intend doing
-        // the bugprone integer division, to have a nice approximation.
-        // NOLINTBEGIN(bugprone-integer-division)
         std::cout << std::format("\rProcessing: {}/{}, {:.2f} %",
-          pixelColors.size() + 1,
-          endIndex / numberOfThreads,
-          100.0 * static_cast<double>(pixelColors.size() + 1) / static_cast<double>(endIndex / numberOfThreads))
+          pixelsDone + group.size(),
+          pixelCount,
+          100.0 * static_cast<double>(pixelsDone + group.size()) / static_cast<double>(pixelCount))
                   << std::flush;
-        // NOLINTEND(bugprone-integer-division)
       }
-      auto i = pixelId / imageWidth;
-      auto j = pixelId % imageWidth;
-      auto color = lina::Vec3{ 0.0, 0.0, 0.0 };
-      for (auto sample = std::size_t{ 0 }; sample < sampleCount; ++sample) {
-        auto const ray = camera.get().GetSampleRayAt(i, j, randomGenerator, sampleCount > 1);
-        color += rayColor(ray, sceneElements, voxelSpace, masterLightIndex, randomGenerator, rayDepth, useSkybox);
+      // the pass is cut short when the time is up, the pixels left out keep the samples of the earlier passes
+      if (options.timeLimit && std::chrono::steady_clock::now() >= deadline) { break; }
+      while (rayDepth > 0) {
+        samples.clear();
+        for (auto const pixelId : group) {
+          auto const& estimate = estimates[pixelId];
+          if (estimate.SampleCount() >= sampleLimit) { continue; }
+          if (adaptive && estimate.SampleCount() >= minSampleCount && estimate.DisplayError() < threshold) {
+            continue;
+          }
+          auto const packetStart = estimate.SampleCount();
+          auto const currentPacketSize = std::min(packetSize, sampleLimit - packetStart);
+          for (auto sample = std::size_t{ 0 }; sample < currentPacketSize; ++sample) {
+            samples.emplace_back(PixelSample{ pixelId, static_cast<std::uint32_t>(packetStart + sample) });
+          }
+        }
+        if (samples.empty()) { break; }
+        colors.resize(samples.size());
+        if (options.engine == Engine::Wavefront) {
+          wavefrontColors(samples,
+            camera,
+            multiSampled,
+            sceneElements,
+            materials,
+            voxelSpace,
+            lightSampler,
+            *sampler,
+            rayDepth,
+            useSkybox,
+            multipleImportanceSampling,
+            options.russianRoulette,
+            colors);
+        } else {
+          traceDepthFirst(samples, colors);
+        }
+        for (auto k = std::size_t{ 0 }; k < samples.size(); ++k) { estimates[samples[k].pixelId].Add(colors[k]); }
+        samplesTaken += samples.size();
       }
-      color /= static_cast<double>(sampleCount);
-      pixelColors.emplace_back(color);
+      pixelsDone += group.size();
     }
     if (reportProgress) { std::cout << '\n'; }
-    return pixelColors;
+    return samplesTaken;
   };
 
-  auto renderChunkResults = std::vector<std::future<std::vector<lina::Vec3>>>();
-  renderChunkResults.reserve(numberOfThreads);
+  auto const endIndex = imageWidth * imageHeight;
+  auto renderPass = [numberOfThreads, endIndex, &renderChunk](std::size_t sampleLimit, bool reportProgress)
+    -> std::size_t {
+    auto renderChunkResults = std::vector<std::future<std::size_t>>();
+    renderChunkResults.reserve(numberOfThreads);
 
-  auto workingThreads = std::vector<std::jthread>{};
-  workingThreads.reserve(numberOfThreads - 1);
+    auto workingThreads = std::vector<std::jthread>{};
+    workingThreads.reserve(numberOfThreads - 1);
 
-  auto const endIndex = imageWidth * imageHeight;
-  for (auto startIndex = std::size_t{ 0 }; startIndex < numberOfThreads; ++startIndex) {
-    auto renderTask = std::packaged_task<std::vector<lina::Vec3>(std::size_t, std::size_t, bool)>(renderChunk);
-    renderChunkResults.emplace_back(renderTask.get_future());
+    for (auto startIndex = std::size_t{ 0 }; startIndex < numberOfThreads; ++startIndex) {
+      auto renderTask =
+        std::packaged_task<std::size_t(std::size_t, std::size_t, std::size_t, bool)>(std::ref(renderChunk));
+      renderChunkResults.emplace_back(renderTask.get_future());
 
-    if (startIndex < numberOfThreads - 1) {
-      workingThreads.emplace_back(std::move(renderTask), startIndex, endIndex, false);
-    } else {
-      renderTask(startIndex, endIndex, true);
+      if (startIndex < numberOfThreads - 1) {
+        workingThreads.emplace_back(std::move(renderTask), startIndex, endIndex, sampleLimit, false);
+      } else {
+        renderTask(startIndex, endIndex, sampleLimit, reportProgress);
+      }
+    }
+    auto samplesTaken = std::size_t{ 0 };
+    for (auto& renderChunkResult : renderChunkResults) { samplesTaken += renderChunkResult.get(); }
+    return samplesTaken;
+  };
+
+  if (progressive) {
+    // Passes over the whole image, so that the samples are spread evenly whenever the time runs out. The first pass
+    // takes a single sample per pixel, to have a full image quickly, then the passes double up to a full packet.
+    // With a target error the error of the image is estimated after every pass, from the half buffers of the pixels.
+    auto sampleLimit = std::size_t{ 0 };
+    auto pass = std::size_t{ 0 };
+    auto error = std::numeric_limits<double>::infinity();
+    while ((!options.timeLimit || std::chrono::steady_clock::now() < deadline) && sampleLimit < maxSampleCount) {
+      sampleLimit = std::min(sampleLimit + std::clamp(sampleLimit, std::size_t{ 1 }, packetSize), maxSampleCount);
+      auto const samplesTaken = renderPass(sampleLimit, false);
+      ++pass;
+      if (options.targetError) { error = estimateRelativeError(estimates); }
+      std::cout << std::format("\rPass {}: {} samples per pixel, {:.1f} s",
+        pass,
+        sampleLimit,
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+      if (options.targetError) { std::cout << std::format(", estimated error {:.4f}", error); }
+      std::cout << std::flush;
+      // every pixel has converged
+      if (samplesTaken == 0) { break; }
+      // at least two samples are needed for the half buffers
+      if (options.targetError && sampleLimit > 1 && error < options.targetError.value()) { break; }
     }
+    std::cout << '\n';
+    if (options.targetError) { std::cerr << std::format("Estimated relative error: {:.4f}\n", error); }
+  } else {
+    renderPass(maxSampleCount, true);
   }
 
-  auto pixelData = std::vector<std::vector<lina::Vec3>>();
-  pixelData.reserve(numberOfThreads);
-  for (auto i = std::size_t{ 0 }; i < renderChunkResults.size(); ++i) {
-    pixelData.emplace_back(renderChunkResults[i].get());
+  if (adaptive || progressive) {
+    auto totalSamples = std::size_t{ 0 };
+    for (auto const& estimate : estimates) { totalSamples += estimate.SampleCount(); }
+    std::cerr << std::format(
+      "Average samples per pixel: {:.2f}\n", static_cast<double>(totalSamples) / static_cast<double>(endIndex));
   }
 
   // serialize render results
   outputStream << "P3\n" << imageWidth << ' ' << imageHeight << "\n255\n";
-  for (auto pixelId = std::size_t{ 0 }; pixelId < endIndex; ++pixelId) {
-    auto renderResultIndex = pixelId % numberOfThreads;
-    auto pixelIndex = pixelId / numberOfThreads;
-    writeColor(pixelData[renderResultIndex][pixelIndex], outputStream);
-  }
+  for (auto const& estimate : estimates) { writeColor(estimate.Mean(), outputStream); }
 }
 
 }// namespace render
@@ -3,14 +3,22 @@
 
 #include "lib/lina/vec3.h"
 #include "lib/trace/collision.h"
+#include "lib/trace/material_table.h"
 #include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
+#include "main/render/light_sampler.h"
 #include "main/render/voxel_space.h"
 #include "main/scenes/scene.h"
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <optional>
 #include <ostream>
-#include <random>
+#include <span>
+#include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -19,26 +27,241 @@ namespace render {
 auto closestCollision(trace::Ray const& ray, std::vector<scene::Element> const& sceneElements)
   -> std::pair<std::optional<trace::Collision>, std::size_t>;
 
-// 3D DDA source: http://www.cse.yorku.ca/~amana/research/grid.pdf
-// John Amanatides, Andrew Woo "A Fast Voxel Traversal Algorithm for Ray Tracing"
+// Russian roulette may end the paths from their rouletteDepth-th bounce on, counted from the camera ray's hit as 0.
+constexpr auto rouletteDepth = std::size_t{ 3 };
+
+// The number of rays tracked together by closestPacketCollisions.
+constexpr auto packetSize = std::size_t{ 16 };
+
+auto closestAnalyticCollision(trace::Ray const& ray,
+  std::vector<scene::Element> const& sceneElements,
+  render::VoxelSpace const& voxelSpace) -> std::pair<std::optional<trace::Collision>, std::size_t>;
+
+// The closest collision with either the analytic components or the triangles in the voxel space.
 auto closestCollisionWithDDA(trace::Ray ray,
   std::vector<scene::Element> const& sceneElements,
   render::VoxelSpace const& voxelSpace) -> std::pair<std::optional<trace::Collision>, std::size_t>;
 
+// Walks through the voxel space with a VoxelWalk.
+// Only triangles closer than closestSoFar are considered, otherwise closestSoFar is returned.
+auto closestTriangleCollisionWithDDA(trace::Ray ray,
+  std::vector<scene::Element> const& sceneElements,
+  render::VoxelSpace const& voxelSpace,
+  std::pair<std::optional<trace::Collision>, std::size_t> const& closestSoFar)
+  -> std::pair<std::optional<trace::Collision>, std::size_t>;
+
+// Whether anything is in the way of the ray closer than the given distance, for the shadow rays. Unlike the closest
+// collision it doesn't have to find what is in the way, so it stops at the first analytic component in the way, and
+// the voxel walk stops at the first voxel with a triangle in the way.
+auto isOccluded(trace::Ray const& ray,
+  double distance,
+  std::vector<scene::Element> const& sceneElements,
+  render::VoxelSpace const& voxelSpace) -> bool;
+
+// Scratch space of the batch queries, kept from one batch to the next, so they stop allocating once it has grown.
+struct RayBatchBuffers
+{
+  std::vector<trace::Ray> rays;
+  std::vector<double> bounds;
+  std::vector<std::size_t> elements;
+  std::vector<std::size_t> entering;
+  std::vector<trace::Ray> enteringRays;
+  std::vector<double> distances;
+};
+
+// The same as closestCollisionWithDDA, for any number of rays at once. The components of a node of the analytic
+// hierarchy are checked for all the rays entering it, each component with a single call to CollideDistances, and only
+// the closest collision of each ray is made in full. The triangles are walked ray by ray.
+// Meant for the scattered rays of the wavefront engine, which don't have to be coherent.
+auto closestBatchCollisions(std::span<trace::Ray const> rays,
+  std::vector<scene::Element> const& sceneElements,
+  render::VoxelSpace const& voxelSpace,
+  RayBatchBuffers& buffers,
+  std::span<std::pair<std::optional<trace::Collision>, std::size_t>> collisions) -> void;
+
+// The same as closestCollisionWithDDA, only for a packet of at most packetSize rays at once.
+// Meant for coherent rays, like the primary rays of a single pixel, where every ray hits about the same components.
+auto closestPacketCollisions(std::span<trace::Ray const> rays,
+  std::vector<scene::Element> const& sceneElements,
+  render::VoxelSpace const& voxelSpace,
+  std::span<std::pair<std::optional<trace::Collision>, std::size_t>> collisions) -> void;
+
 auto rayColor(trace::Ray const& ray,
   std::vector<scene::Element> const& sceneElements,
+  trace::MaterialTable const& materials,
   render::VoxelSpace const& voxelSpace,
   int masterLightIndex,
-  std::mt19937& randomGenerator,
+  trace::Sampler& sampler,
   std::size_t depth,
   bool useSkybox) -> lina::Vec3;
 
+// The color of the ray, given its closest collision is already known.
+// With russianRoulette the paths longer than rouletteDepth bounces may be ended early, see collisionColor.
+auto collisionColor(trace::Ray const& ray,
+  std::pair<std::optional<trace::Collision>, std::size_t> const& closest,
+  std::vector<scene::Element> const& sceneElements,
+  trace::MaterialTable const& materials,
+  render::VoxelSpace const& voxelSpace,
+  int masterLightIndex,
+  trace::Sampler& sampler,
+  std::size_t depth,
+  bool useSkybox,
+  bool russianRoulette) -> lina::Vec3;
+
+// A path between its bounces, as traced by lightSamplingColor.
+struct PathState
+{
+  // the ray leaving the last collision, the camera ray at first
+  trace::Ray ray;
+  lina::Vec3 color{ 0.0, 0.0, 0.0 };
+  lina::Vec3 throughput{ 1.0, 1.0, 1.0 };
+  std::size_t bounce = 0;
+  // whether a light was sampled at the last collision, from where, and the scattering PDF of the ray
+  bool lightSampled = false;
+  lina::Vec3 previousPoint{};
+  lina::Vec3 previousNormal{};
+  double scatteringPDFValue = 0.0;
+  // false once the path has ended
+  bool active = true;
+};
+
+// The shadow ray of a light sample, its contribution is added to the color of the path, if nothing is in the way
+// before the given distance.
+struct ShadowRay
+{
+  trace::Ray ray;
+  double distance;
+  lina::Vec3 contribution;
+};
+
+// The weight of a sample taken with the density sampledPDFValue, when the other strategy would have taken it with
+// the density otherPDFValue. Veach "Optimally Combining Sampling Techniques for Monte Carlo Rendering" (1995).
+// The weights of the two strategies sum to 1, a sample neither of them could have taken gets 0.
+[[nodiscard]] auto powerHeuristic(double sampledPDFValue, double otherPDFValue) -> double;
+
+// The same as isOccluded for the rays of all the shadow rays, checked together like in closestBatchCollisions.
+// occluded ends up with as many values as there are shadow rays.
+auto occludedShadowRays(std::span<ShadowRay const> shadowRays,
+  std::vector<scene::Element> const& sceneElements,
+  render::VoxelSpace const& voxelSpace,
+  RayBatchBuffers& buffers,
+  std::vector<bool>& occluded) -> void;
+
+// A single bounce of lightSamplingColor: adds the light found at the collision of the path's ray to its color, and
+// unless the path ends there, scatters it, setting up its next ray. The shadow ray of the light sample taken is
+// returned for the caller to check.
+// The sampler has to be at the path's current bounce, just before the collision.
+auto shadeCollision(PathState& path,
+  std::pair<std::optional<trace::Collision>, std::size_t> const& closest,
+  std::vector<scene::Element> const& sceneElements,
+  trace::MaterialTable const& materials,
+  LightSampler const& lightSampler,
+  trace::Sampler& sampler,
+  std::size_t depth,
+  bool useSkybox,
+  bool multipleImportanceSampling,
+  bool russianRoulette) -> std::optional<ShadowRay>;
+
+// The same as collisionColor, but with next event estimation: at every bounce on a diffuse material one of the lights
+// is picked by the light sampler and sampled directly, with a shadow ray checking whether it is visible. The emission
+// the scattered rays find on the lights is not counted then, as the light samples already account for it, unless
+// multipleImportanceSampling combines the two with the power heuristic.
+auto lightSamplingColor(trace::Ray const& ray,
+  std::pair<std::optional<trace::Collision>, std::size_t> const& closest,
+  std::vector<scene::Element> const& sceneElements,
+  trace::MaterialTable const& materials,
+  render::VoxelSpace const& voxelSpace,
+  LightSampler const& lightSampler,
+  trace::Sampler& sampler,
+  std::size_t depth,
+  bool useSkybox,
+  bool multipleImportanceSampling,
+  bool russianRoulette) -> lina::Vec3;
+
 // applying gamma correction to the colors
 auto linearToGamma(double LinearSpaceValue) -> double;
 
 auto writeColor(lina::Vec3 const& color, std::ostream& outputStream) -> void;
 
-auto linearPartition(scene::Composition sceneComposition, std::ostream& outputStream) -> void;
+// Path follows the scattered rays only, sampling the master light of the scene half of the time. Nee samples every
+// light of the scene at each bounce, see lightSamplingColor. Mis also counts the emission the scattered rays find,
+// weighing it against the light samples.
+enum class Integrator { Path, Nee, Mis };
+
+// Throws std::invalid_argument for unknown names.
+[[nodiscard]] auto integratorFromName(std::string_view name) -> Integrator;
+
+// DepthFirst traces the paths one after the other, Wavefront a few thousand of them together, see wavefrontColors.
+// The two give the same image, the wavefront engine only works with the Nee and Mis integrators.
+enum class Engine { DepthFirst, Wavefront };
+
+// Throws std::invalid_argument for unknown names.
+[[nodiscard]] auto engineFromName(std::string_view name) -> Engine;
+
+inline constexpr auto maxThreadCount = std::size_t{ 1024 };
+
+// The number of rendering threads given as text, between 1 and maxThreadCount. Throws std::invalid_argument for
+// anything else, including negative numbers and trailing characters.
+[[nodiscard]] auto threadCountFromText(std::string const& text) -> std::size_t;
+
+// The seed of the random numbers given as text, a decimal number that fits 64 bits. Throws std::invalid_argument for
+// anything else, including signs, whitespace and trailing characters, so a typo doesn't become another seed.
+[[nodiscard]] auto seedFromText(std::string const& text) -> std::uint64_t;
+
+// The sample indices of a pixel are 32 bits, it can't take more samples than this.
+inline constexpr auto sampleCountLimit = std::size_t{ std::numeric_limits<std::uint32_t>::max() };
+// The least samples of a pixel in adaptive mode, unless set.
+inline constexpr auto defaultMinSampleCount = std::size_t{ 64 };
+
+// A number of samples per pixel given as text, between 1 and sampleCountLimit. Throws std::invalid_argument for
+// anything else, including signs and trailing characters.
+[[nodiscard]] auto sampleCountFromText(std::string const& text) -> std::size_t;
+
+// A finite number above zero given as text. Throws std::invalid_argument for anything else, including nan, inf and
+// trailing characters.
+[[nodiscard]] auto positiveNumberFromText(std::string const& text) -> double;
+
+// A time limit given as a number of seconds, finite, above zero, and short enough for the steady clock to count.
+// Throws std::invalid_argument for anything else.
+[[nodiscard]] auto timeLimitFromText(std::string const& text) -> std::chrono::duration<double>;
+
+// Settings of the renderer itself, that are independent of the rendered scene.
+// Given a seed, every sample draws the same random numbers no matter which thread traces it, so the rendered image is
+// bit-identical for any thread count.
+struct RenderOptions
+{
+  trace::SamplerType sampler = trace::SamplerType::Sobol;
+  Integrator integrator = Integrator::Mis;
+  Engine engine = Engine::DepthFirst;
+  // a random one is picked when not set
+  std::optional<std::uint64_t> seed{};
+  // zero uses every available hardware thread
+  std::size_t threadCount = 0;
+  // Adaptive sampling: when set, a pixel stops taking samples once its PixelEstimate::DisplayError falls below the
+  // threshold, which has to be above zero. Every pixel takes at least minSampleCount and at most maxSampleCount
+  // samples, the former defaulting to defaultMinSampleCount, the latter to the sample count of the scene. With a
+  // maximum above the scene's count the noisy regions get more samples than the fixed count would give them, while
+  // the converged ones stop early. Both are between 1 and sampleCountLimit, and a minimum that is set can't be above
+  // the maximum. The default minimum is lowered to the maximum.
+  std::optional<double> adaptiveThreshold{};
+  std::optional<std::size_t> minSampleCount{};
+  std::optional<std::size_t> maxSampleCount{};
+  // Progressive rendering: when set, the renderer makes passes over the whole image, adding a few samples to every
+  // pixel in each, until the time runs out, instead of taking the sample count of the scene. maxSampleCount still
+  // caps the samples when given. The time is checked between pixels, so it is kept to within a pixel's samples.
+  // It has to be above zero, and the deadline it sets has to fit the steady clock.
+  std::optional<std::chrono::duration<double>> timeLimit{};
+  // Also progressive rendering, which stops once the relative error of the image estimated by estimateRelativeError
+  // falls below the target. It can be combined with the time limit, whichever comes first. The target has to be above
+  // zero, and a time limit or maxSampleCount has to be set as well, as a noisy scene may never reach it.
+  std::optional<double> targetError{};
+  // Russian roulette, ending the paths that carry little light early, see collisionColor. Turning it off follows
+  // every path to the full ray depth, for checking that the roulette doesn't change the mean of the image.
+  bool russianRoulette = true;
+};
+
+auto linearPartition(scene::Composition sceneComposition, RenderOptions const& options, std::ostream& outputStream)
+  -> void;
 
 }// namespace render
 
@@ -0,0 +1,148 @@
+#include "lib/lina/vec3.h"
+#include "lib/trace/collision.h"
+#include "lib/trace/geometry/component.h"
+#include "lib/trace/geometry/cuboid.h"
+#include "lib/trace/geometry/sphere.h"
+#include "lib/trace/material/lambertian.h"
+#include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
+#include "lib/trace/util.h"
+#include "main/render/pixel_partition.h"
+#include "main/render/voxel_space.h"
+#include "main/scenes/scene.h"
+#include "main/scenes/scene_settings.h"
+
+#include <array>
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The primary rays of a 64x64 render of the scene, a packet of them for every pixel, as the renderer traces them.
+static auto primaryRays(scene::Composition const& composition) -> std::vector<trace::Ray>
+{
+  auto rays = std::vector<trace::Ray>{};
+  auto sampler = trace::IndependentSampler{ 42 };
+  for (auto i = std::size_t{ 0 }; i < composition.camera.ImageHeight(); ++i) {
+    for (auto j = std::size_t{ 0 }; j < composition.camera.ImageWidth(); ++j) {
+      for (auto k = std::size_t{ 0 }; k < render::packetSize; ++k) {
+        rays.push_back(composition.camera.GetSampleRayAt(i, j, sampler, true));
+      }
+    }
+  }
+  return rays;
+}
+
+static auto loadScene(std::string const& name) -> scene::Composition
+{
+  auto configuration = scene::configurations().at(name);
+  configuration.settings.imageWidth = 64;
+  configuration.settings.imageHeight = 64;
+  return configuration.sceneLoader(configuration.settings);
+}
+
+static auto voxelSpaceOf(scene::Composition const& composition) -> render::VoxelSpace
+{
+  auto components = std::vector<trace::Component const*>{};
+  for (auto const& sceneElement : composition.sceneElements) { components.emplace_back(sceneElement.component.get()); }
+  return render::VoxelSpace{ components };
+}
+
+static void singleRayPrimaryHits(benchmark::State& state, std::string const& name)
+{
+  auto const composition = loadScene(name);
+  auto const voxelSpace = voxelSpaceOf(composition);
+  auto const rays = primaryRays(composition);
+  for (auto _ : state) {
+    for (auto const& ray : rays) {
+      benchmark::DoNotOptimize(render::closestCollisionWithDDA(ray, composition.sceneElements, voxelSpace));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(rays.size()));
+}
+BENCHMARK_CAPTURE(singleRayPrimaryHits, icosphere, std::string{ "test-icosphere-material" });
+BENCHMARK_CAPTURE(singleRayPrimaryHits, cornellBox, std::string{ "cornell-box" });
+
+static void packetPrimaryHits(benchmark::State& state, std::string const& name)
+{
+  auto const composition = loadScene(name);
+  auto const voxelSpace = voxelSpaceOf(composition);
+  auto const rays = primaryRays(composition);
+  auto collisions = std::array<std::pair<std::optional<trace::Collision>, std::size_t>, render::packetSize>{};
+  for (auto _ : state) {
+    for (auto first = std::size_t{ 0 }; first < rays.size(); first += render::packetSize) {
+      render::closestPacketCollisions(
+        std::span{ rays }.subspan(first, render::packetSize), composition.sceneElements, voxelSpace, collisions);
+      benchmark::DoNotOptimize(collisions);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(rays.size()));
+}
+BENCHMARK_CAPTURE(packetPrimaryHits, icosphere, std::string{ "test-icosphere-material" });
+BENCHMARK_CAPTURE(packetPrimaryHits, cornellBox, std::string{ "cornell-box" });
+
+// A grid of spheres and cuboids, with rays from all around, so most of them miss most of the components.
+static auto analyticGrid(std::size_t side) -> std::vector<scene::Element>
+{
+  auto sceneElements = std::vector<scene::Element>{};
+  for (auto i = std::size_t{ 0 }; i < side; ++i) {
+    for (auto j = std::size_t{ 0 }; j < side; ++j) {
+      auto const center = lina::Vec3{ static_cast<double>(i) * 3.0, static_cast<double>(j) * 3.0, 0.0 };
+      auto material = std::make_unique<trace::Lambertian>(lina::Vec3{ 0.5, 0.5, 0.5 });
+      if ((i + j) % 2 == 0) {
+        sceneElements.emplace_back(
+          std::make_unique<trace::Sphere>(trace::buildSphere(center, 1.0)), std::move(material));
+      } else {
+        sceneElements.emplace_back(
+          std::make_unique<trace::Cuboid>(trace::buildCuboid(center, 1.5, 1.5, 1.5)), std::move(material));
+      }
+    }
+  }
+  return sceneElements;
+}
+
+static auto raysAround(std::size_t side) -> std::vector<trace::Ray>
+{
+  auto rays = std::vector<trace::Ray>{};
+  auto sampler = trace::IndependentSampler{ 42 };
+  auto const center = lina::Vec3{ static_cast<double>(side) * 1.5, static_cast<double>(side) * 1.5, 0.0 };
+  for (auto i = 0; i < 4096; ++i) {
+    rays.emplace_back(center + trace::randomOnUnitSphere(sampler) * static_cast<double>(side) * 2.0,
+      trace::randomOnUnitSphere(sampler));
+  }
+  return rays;
+}
+
+static void everyAnalyticComponent(benchmark::State& state)
+{
+  auto const side = static_cast<std::size_t>(state.range(0));
+  auto const sceneElements = analyticGrid(side);
+  auto const rays = raysAround(side);
+  for (auto _ : state) {
+    for (auto const& ray : rays) { benchmark::DoNotOptimize(render::closestCollision(ray, sceneElements)); }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(rays.size()));
+}
+BENCHMARK(everyAnalyticComponent)->Arg(3)->Arg(8);
+
+static void analyticHierarchy(benchmark::State& state)
+{
+  auto const side = static_cast<std::size_t>(state.range(0));
+  auto const sceneElements = analyticGrid(side);
+  auto components = std::vector<trace::Component const*>{};
+  for (auto const& sceneElement : sceneElements) { components.emplace_back(sceneElement.component.get()); }
+  auto const voxelSpace = render::VoxelSpace{ components };
+  auto const rays = raysAround(side);
+  for (auto _ : state) {
+    for (auto const& ray : rays) {
+      benchmark::DoNotOptimize(render::closestAnalyticCollision(ray, sceneElements, voxelSpace));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(rays.size()));
+}
+BENCHMARK(analyticHierarchy)->Arg(3)->Arg(8);
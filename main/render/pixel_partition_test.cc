@@ -0,0 +1,529 @@
+#include "lib/lina/vec3.h"
+#include "lib/trace/collision.h"
+#include "lib/trace/geometry/component.h"
+#include "lib/trace/geometry/cuboid.h"
+#include "lib/trace/geometry/icosphere.h"
+#include "lib/trace/geometry/plane.h"
+#include "lib/trace/geometry/sphere.h"
+#include "lib/trace/material.h"
+#include "lib/trace/material/lambertian.h"
+#include "lib/trace/material_table.h"
+#include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
+#include "lib/trace/util.h"
+#include "main/render/light_sampler.h"
+#include "main/render/pixel_partition.h"
+#include "main/render/voxel_space.h"
+#include "main/scenes/scene.h"
+#include "main/scenes/scene_settings.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+static auto buildTestScene() -> std::vector<scene::Element>
+{
+  auto sceneElements = std::vector<scene::Element>{};
+  auto const material = lina::Vec3{ 0.5, 0.5, 0.5 };
+  sceneElements.emplace_back(
+    std::make_unique<trace::Icosphere>(trace::buildIcosphere(lina::Vec3{ -1.0, 5.0, 0.0 }, 2.0, 3)),
+    std::make_unique<trace::Lambertian>(material));
+  sceneElements.emplace_back(
+    std::make_unique<trace::Icosphere>(trace::buildIcosphere(lina::Vec3{ 1.0, 6.0, 0.5 }, 2.0, 2)),
+    std::make_unique<trace::Lambertian>(material));
+  sceneElements.emplace_back(std::make_unique<trace::Sphere>(trace::buildSphere(lina::Vec3{ 0.0, 8.0, -1.0 }, 3.0)),
+    std::make_unique<trace::Lambertian>(material));
+  sceneElements.emplace_back(
+    std::make_unique<trace::Plane>(trace::buildPlane(lina::Vec3{ 0.0, 5.0, -2.0 }, 10.0, 10.0)),
+    std::make_unique<trace::Lambertian>(material));
+  return sceneElements;
+}
+
+static auto expectSameCollisions(std::span<trace::Ray const> rays,
+  std::vector<scene::Element> const& sceneElements,
+  render::VoxelSpace const& voxelSpace) -> void
+{
+  auto collisions = std::array<std::pair<std::optional<trace::Collision>, std::size_t>, render::packetSize>{};
+  auto const packetCollisions = std::span{ collisions }.first(rays.size());
+  render::closestPacketCollisions(rays, sceneElements, voxelSpace, packetCollisions);
+  for (auto i = std::size_t{ 0 }; i < rays.size(); ++i) {
+    auto const single = render::closestCollisionWithDDA(rays[i], sceneElements, voxelSpace);
+    ASSERT_EQ(single.first.has_value(), packetCollisions[i].first.has_value());
+    if (!single.first) { continue; }
+    EXPECT_EQ(single.second, packetCollisions[i].second);
+    EXPECT_DOUBLE_EQ(single.first->point[0], packetCollisions[i].first->point[0]);
+    EXPECT_DOUBLE_EQ(single.first->point[1], packetCollisions[i].first->point[1]);
+    EXPECT_DOUBLE_EQ(single.first->point[2], packetCollisions[i].first->point[2]);
+  }
+}
+
+TEST(closestPacketCollisions, coherentRaysMatchSingleRays)
+{
+  auto const sceneElements = buildTestScene();
+  auto components = std::vector<trace::Component const*>{};
+  for (auto const& sceneElement : sceneElements) { components.emplace_back(sceneElement.component.get()); }
+  auto const voxelSpace = render::VoxelSpace{ components };
+
+  auto sampler = trace::IndependentSampler{ 42 };
+  for (auto packet = 0; packet < 100; ++packet) {
+    // rays through a small patch, as the samples of a pixel would be
+    auto const target = lina::Vec3{ trace::randomUniformDouble(sampler, -3.0, 3.0),
+      5.0,
+      trace::randomUniformDouble(sampler, -2.5, 2.5) };
+    auto rays = std::array<trace::Ray, render::packetSize>{};
+    for (auto& ray : rays) {
+      auto const jitter = lina::Vec3{ trace::randomUniformDouble(sampler, -0.05, 0.05),
+        0.0,
+        trace::randomUniformDouble(sampler, -0.05, 0.05) };
+      ray = trace::Ray{ lina::Vec3{ 0.0, -5.0, 0.0 }, target + jitter - lina::Vec3{ 0.0, -5.0, 0.0 } };
+    }
+    expectSameCollisions(rays, sceneElements, voxelSpace);
+  }
+}
+
+TEST(closestPacketCollisions, incoherentRaysMatchSingleRays)
+{
+  auto const sceneElements = buildTestScene();
+  auto components = std::vector<trace::Component const*>{};
+  for (auto const& sceneElement : sceneElements) { components.emplace_back(sceneElement.component.get()); }
+  auto const voxelSpace = render::VoxelSpace{ components };
+
+  auto sampler = trace::IndependentSampler{ 42 };
+  for (auto packet = 0; packet < 100; ++packet) {
+    // a partial packet of rays from everywhere to everywhere
+    auto rays = std::array<trace::Ray, render::packetSize - 3>{};
+    for (auto& ray : rays) {
+      ray = trace::Ray{ trace::randomOnUnitSphere(sampler) * 10.0 + lina::Vec3{ 0.0, 5.0, 0.0 },
+        trace::randomOnUnitSphere(sampler) };
+    }
+    expectSameCollisions(rays, sceneElements, voxelSpace);
+  }
+}
+
+TEST(isOccluded, agreesWithTheClosestCollision)
+{
+  auto const sceneElements = buildTestScene();
+  auto components = std::vector<trace::Component const*>{};
+  for (auto const& sceneElement : sceneElements) { components.emplace_back(sceneElement.component.get()); }
+  auto const voxelSpace = render::VoxelSpace{ components };
+
+  auto sampler = trace::IndependentSampler{ 42 };
+  for (auto i = 0; i < 1000; ++i) {
+    auto const ray = trace::Ray{ trace::randomOnUnitSphere(sampler) * 10.0 + lina::Vec3{ 0.0, 5.0, 0.0 },
+      trace::randomOnUnitSphere(sampler) };
+    auto const distance = trace::randomUniformDouble(sampler, 0.0, 20.0);
+    auto const closest = render::closestCollisionWithDDA(ray, sceneElements, voxelSpace);
+    auto const closestDistance =
+      closest.first ? (closest.first->point - ray.Source()).Length() : std::numeric_limits<double>::infinity();
+    // the ray reaching exactly what it is aimed at is not occluded
+    if (std::abs(closestDistance - distance) < 1e-3) { continue; }
+    EXPECT_EQ(render::isOccluded(ray, distance, sceneElements, voxelSpace), closestDistance < distance);
+  }
+  // a ray aimed at the closest collision itself
+  auto const ray = trace::Ray{ lina::Vec3{ 0.0, -5.0, 0.0 }, lina::Vec3{ 0.0, 1.0, 0.0 } };
+  auto const closest = render::closestCollisionWithDDA(ray, sceneElements, voxelSpace);
+  ASSERT_TRUE(closest.first.has_value());
+  auto const distance = (closest.first->point - ray.Source()).Length();
+  EXPECT_FALSE(render::isOccluded(ray, distance, sceneElements, voxelSpace));
+  EXPECT_TRUE(render::isOccluded(ray, distance + 0.1, sceneElements, voxelSpace));
+}
+
+TEST(closestAnalyticCollision, agreesWithCheckingEveryComponent)
+{
+  // a row of spheres, cuboids and planes, so the hierarchy has a few levels
+  auto sceneElements = std::vector<scene::Element>{};
+  auto const material = lina::Vec3{ 0.5, 0.5, 0.5 };
+  for (auto i = 0; i < 12; ++i) {
+    auto const center = lina::Vec3{ (static_cast<double>(i) * 2.0) - 11.0, 5.0, 0.0 };
+    switch (i % 3) {
+    case 0:
+      sceneElements.emplace_back(std::make_unique<trace::Sphere>(trace::buildSphere(center, 0.8)),
+        std::make_unique<trace::Lambertian>(material));
+      break;
+    case 1:
+      sceneElements.emplace_back(std::make_unique<trace::Cuboid>(trace::buildCuboid(center, 1.0, 1.5, 2.0)),
+        std::make_unique<trace::Lambertian>(material));
+      break;
+    default:
+      sceneElements.emplace_back(std::make_unique<trace::Plane>(trace::buildPlane(center, 1.5, 1.5)),
+        std::make_unique<trace::Lambertian>(material));
+      break;
+    }
+  }
+  auto components = std::vector<trace::Component const*>{};
+  for (auto const& sceneElement : sceneElements) { components.emplace_back(sceneElement.component.get()); }
+  auto const voxelSpace = render::VoxelSpace{ components };
+  ASSERT_GT(voxelSpace.AnalyticNodes().size(), 1);
+
+  auto sampler = trace::IndependentSampler{ 42 };
+  for (auto i = 0; i < 2000; ++i) {
+    auto const ray = trace::Ray{ trace::randomOnUnitSphere(sampler) * 15.0 + lina::Vec3{ 0.0, 5.0, 0.0 },
+      trace::randomOnUnitSphere(sampler) };
+    auto const expected = render::closestCollision(ray, sceneElements);
+    auto const analytic = render::closestAnalyticCollision(ray, sceneElements, voxelSpace);
+    ASSERT_EQ(expected.first.has_value(), analytic.first.has_value());
+    if (!expected.first) { continue; }
+    EXPECT_EQ(expected.second, analytic.second);
+  }
+}
+
+TEST(closestBatchCollisions, matchesSingleRays)
+{
+  // the test scene with a cuboid as well, so every kind of component is checked in batches
+  auto sceneElements = buildTestScene();
+  sceneElements.emplace_back(
+    std::make_unique<trace::Cuboid>(trace::buildCuboid(lina::Vec3{ 2.0, 3.0, 1.0 }, 1.0, 1.5, 2.0)),
+    std::make_unique<trace::Lambertian>(lina::Vec3{ 0.5, 0.5, 0.5 }));
+  auto components = std::vector<trace::Component const*>{};
+  for (auto const& sceneElement : sceneElements) { components.emplace_back(sceneElement.component.get()); }
+  auto const voxelSpace = render::VoxelSpace{ components };
+
+  auto sampler = trace::IndependentSampler{ 42 };
+  auto rays = std::vector<trace::Ray>{};
+  auto shadowRays = std::vector<render::ShadowRay>{};
+  for (auto i = 0; i < 1000; ++i) {
+    rays.emplace_back(trace::randomOnUnitSphere(sampler) * 10.0 + lina::Vec3{ 0.0, 5.0, 0.0 },
+      trace::randomOnUnitSphere(sampler));
+    shadowRays.push_back(
+      { rays.back(), trace::randomUniformDouble(sampler, 0.0, 20.0), lina::Vec3{ 1.0, 1.0, 1.0 } });
+  }
+  auto buffers = render::RayBatchBuffers{};
+  auto collisions = std::vector<std::pair<std::optional<trace::Collision>, std::size_t>>(rays.size());
+  render::closestBatchCollisions(rays, sceneElements, voxelSpace, buffers, collisions);
+  auto occluded = std::vector<bool>{};
+  render::occludedShadowRays(shadowRays, sceneElements, voxelSpace, buffers, occluded);
+  ASSERT_EQ(occluded.size(), shadowRays.size());
+  for (auto i = std::size_t{ 0 }; i < rays.size(); ++i) {
+    auto const single = render::closestCollisionWithDDA(rays[i], sceneElements, voxelSpace);
+    ASSERT_EQ(single.first.has_value(), collisions[i].first.has_value());
+    if (single.first) {
+      EXPECT_EQ(single.second, collisions[i].second);
+      EXPECT_EQ(single.first->point[0], collisions[i].first->point[0]);
+      EXPECT_EQ(single.first->point[1], collisions[i].first->point[1]);
+      EXPECT_EQ(single.first->point[2], collisions[i].first->point[2]);
+    }
+    EXPECT_EQ(occluded[i], render::isOccluded(rays[i], shadowRays[i].distance, sceneElements, voxelSpace));
+  }
+}
+
+static auto renderCornellBox(render::RenderOptions const& options) -> std::string
+{
+  auto const configurations = scene::configurations();
+  auto const& configuration = configurations.at("cornell-box");
+  auto settings = configuration.settings;
+  settings.imageWidth = 12;
+  settings.imageHeight = 12;
+  settings.sampleCount = 5;
+  auto image = std::stringstream{};
+  render::linearPartition(configuration.sceneLoader(settings), options, image);
+  return image.str();
+}
+
+TEST(linearPartition, sameSeedGivesTheSameImageForAnyThreadCount)
+{
+  auto const adaptive = render::RenderOptions{
+    .sampler = trace::SamplerType::Sobol, .adaptiveThreshold = 0.05, .minSampleCount = 2, .maxSampleCount = 9
+  };
+  for (auto options : { render::RenderOptions{ .sampler = trace::SamplerType::Independent },
+         render::RenderOptions{ .sampler = trace::SamplerType::ZSobol },
+         adaptive }) {
+    options.seed = 42;
+    options.threadCount = 1;
+    auto const reference = renderCornellBox(options);
+    options.threadCount = 3;
+    EXPECT_EQ(renderCornellBox(options), reference);
+    options.threadCount = 7;
+    EXPECT_EQ(renderCornellBox(options), reference);
+    options.seed = 43;
+    EXPECT_NE(renderCornellBox(options), reference);
+  }
+}
+
+TEST(linearPartition, progressivePassesAddUpToTheFixedSampleCount)
+{
+  // the scene is rendered with 5 samples per pixel
+  auto const fixed = renderCornellBox({ .seed = 42 });
+  auto const progressive =
+    renderCornellBox({ .seed = 42, .maxSampleCount = 5, .timeLimit = std::chrono::duration<double>{ 600.0 } });
+  EXPECT_EQ(progressive, fixed);
+}
+
+// The channels of a rendered PPM image, after the header.
+static auto imageValues(std::string const& image) -> std::vector<double>
+{
+  auto stream = std::istringstream{ image };
+  auto format = std::string{};
+  auto width = 0;
+  auto height = 0;
+  auto maxValue = 0;
+  stream >> format >> width >> height >> maxValue;
+  auto values = std::vector<double>{};
+  for (auto value = 0; stream >> value;) { values.emplace_back(value); }
+  return values;
+}
+
+static auto rootMeanSquareError(std::vector<double> const& values, std::vector<double> const& reference) -> double
+{
+  auto sum = 0.0;
+  for (auto i = std::size_t{ 0 }; i < values.size(); ++i) {
+    sum += (values[i] - reference[i]) * (values[i] - reference[i]);
+  }
+  return std::sqrt(sum / static_cast<double>(values.size()));
+}
+
+// The progressive renders take more samples than the 5 of the scene, the Z-order Sobol sampler is built for 5, and
+// has to keep its later samples as good as the first ones.
+TEST(linearPartition, targetErrorWithZSobolConvergesLikeSobol)
+{
+  auto const reference = imageValues(
+    renderCornellBox({ .seed = 7, .maxSampleCount = 1024, .timeLimit = std::chrono::duration<double>{ 600.0 } }));
+  auto errors = std::vector<double>{};
+  for (auto const sampler : { trace::SamplerType::Sobol, trace::SamplerType::ZSobol }) {
+    auto const image = imageValues(renderCornellBox({ .sampler = sampler,
+      .seed = 42,
+      .timeLimit = std::chrono::duration<double>{ 600.0 },
+      .targetError = 0.1 }));
+    ASSERT_EQ(image.size(), reference.size());
+    errors.emplace_back(rootMeanSquareError(image, reference));
+  }
+  EXPECT_LT(errors[1], errors[0] * 1.25) << "sobol: " << errors[0] << " zsobol: " << errors[1];
+}
+
+// The mean of the linear colors of every sample of a small render of the scene, traced the way linearPartition
+// traces them, with paths up to rayDepth bounces. Without the gamma correction and the 8 bits of the image, small
+// differences of the mean show.
+static auto meanRadiance(std::string const& sceneName,
+  std::size_t imageSize,
+  std::size_t samplesPerPixel,
+  std::size_t rayDepth,
+  render::Integrator integrator,
+  bool russianRoulette) -> double
+{
+  auto const configurations = scene::configurations();
+  auto const& configuration = configurations.at(sceneName);
+  auto settings = configuration.settings;
+  settings.imageWidth = imageSize;
+  settings.imageHeight = imageSize;
+  settings.rayDepth = rayDepth;
+  auto const composition = configuration.sceneLoader(settings);
+  auto components = std::vector<trace::Component const*>{};
+  auto sceneMaterials = std::vector<trace::Material const*>{};
+  for (auto const& sceneElement : composition.sceneElements) {
+    components.emplace_back(sceneElement.component.get());
+    sceneMaterials.emplace_back(sceneElement.material.get());
+  }
+  auto const voxelSpace = render::VoxelSpace{ components };
+  auto const materials = trace::MaterialTable{ sceneMaterials };
+  auto const lightSampler = render::LightSampler{ composition.sceneElements };
+  auto sampler = trace::buildSampler(trace::SamplerType::Sobol, 42, imageSize, imageSize, samplesPerPixel);
+
+  auto sum = lina::Vec3{ 0.0, 0.0, 0.0 };
+  for (auto pixelId = std::size_t{ 0 }; pixelId < imageSize * imageSize; ++pixelId) {
+    for (auto sample = std::uint32_t{ 0 }; sample < samplesPerPixel; ++sample) {
+      sampler->StartPath(pixelId, sample);
+      auto const ray = composition.camera.GetSampleRayAt(pixelId / imageSize, pixelId % imageSize, *sampler, true);
+      auto const closest = render::closestCollisionWithDDA(ray, composition.sceneElements, voxelSpace);
+      if (integrator == render::Integrator::Path) {
+        sum += render::collisionColor(ray,
+          closest,
+          composition.sceneElements,
+          materials,
+          voxelSpace,
+          composition.masterLightIndex,
+          *sampler,
+          composition.rayDepth,
+          composition.useSkybox,
+          russianRoulette);
+      } else {
+        sum += render::lightSamplingColor(ray,
+          closest,
+          composition.sceneElements,
+          materials,
+          voxelSpace,
+          lightSampler,
+          *sampler,
+          composition.rayDepth,
+          composition.useSkybox,
+          integrator == render::Integrator::Mis,
+          russianRoulette);
+      }
+    }
+  }
+  return (sum[0] + sum[1] + sum[2]) / (3.0 * static_cast<double>(imageSize * imageSize * samplesPerPixel));
+}
+
+// Ending some of the paths early and scaling up the ones going on changes the noise, but not the mean. Inside the
+// bright closed cuboid much of the light comes from the bounces the roulette plays on.
+TEST(collisionColor, russianRouletteKeepsTheMean)
+{
+  for (auto const integrator : { render::Integrator::Path, render::Integrator::Mis }) {
+    auto const withoutRoulette = meanRadiance("test-cuboid-inside-lambertian", 16, 1024, 8, integrator, false);
+    auto const withRoulette = meanRadiance("test-cuboid-inside-lambertian", 16, 1024, 8, integrator, true);
+    EXPECT_NEAR(withRoulette, withoutRoulette, withoutRoulette * 0.02);
+  }
+}
+
+// The three integrators sample the same light differently, the means of their images agree. The floating sphere has no
+// diffuse surfaces, where nee and mis would sample the lights, the cornell box has, which also checks the mis weights.
+TEST(lightSamplingColor, integratorsConvergeToTheSameMean)
+{
+  struct Case
+  {
+    std::string sceneName;
+    std::size_t imageSize;
+    std::size_t samplesPerPixel;
+  };
+  for (auto const& [sceneName, imageSize, samplesPerPixel] :
+    { Case{ "floating-sphere", 30, 128 }, Case{ "cornell-box", 20, 256 } }) {
+    auto const path = meanRadiance(sceneName, imageSize, samplesPerPixel, 10, render::Integrator::Path, true);
+    auto const nee = meanRadiance(sceneName, imageSize, samplesPerPixel, 10, render::Integrator::Nee, true);
+    auto const mis = meanRadiance(sceneName, imageSize, samplesPerPixel, 10, render::Integrator::Mis, true);
+    EXPECT_NEAR(nee, path, path * 0.015) << sceneName;
+    EXPECT_NEAR(mis, path, path * 0.015) << sceneName;
+  }
+}
+
+TEST(powerHeuristic, weightsOfTheTwoStrategiesSumToOne)
+{
+  for (auto const& [first, second] : std::vector<std::pair<double, double>>{
+         { 1.0, 1.0 }, { 0.3, 2.5 }, { 1e-6, 40.0 }, { 1e3, 1e-3 }, { 0.0, 0.7 } }) {
+    EXPECT_DOUBLE_EQ(render::powerHeuristic(first, second) + render::powerHeuristic(second, first), 1.0);
+  }
+  EXPECT_DOUBLE_EQ(render::powerHeuristic(1.0, 1.0), 0.5);
+  EXPECT_DOUBLE_EQ(render::powerHeuristic(3.0, 1.0), 0.9);
+}
+
+TEST(powerHeuristic, zeroDensities)
+{
+  // only the sampled strategy could have taken the sample
+  EXPECT_EQ(render::powerHeuristic(0.4, 0.0), 1.0);
+  // a sample the strategy couldn't have taken
+  EXPECT_EQ(render::powerHeuristic(0.0, 0.4), 0.0);
+  // neither could have, the sample carries nothing and gets no weight rather than a NaN
+  EXPECT_EQ(render::powerHeuristic(0.0, 0.0), 0.0);
+}
+
+TEST(linearPartition, wavefrontGivesTheSameImageAsDepthFirst)
+{
+  auto const adaptive = render::RenderOptions{
+    .integrator = render::Integrator::Nee, .adaptiveThreshold = 0.05, .minSampleCount = 2, .maxSampleCount = 9
+  };
+  for (auto options : { render::RenderOptions{ .integrator = render::Integrator::Mis, .threadCount = 3 },
+         render::RenderOptions{ .sampler = trace::SamplerType::Independent, .integrator = render::Integrator::Nee },
+         adaptive }) {
+    options.seed = 42;
+    auto const depthFirst = renderCornellBox(options);
+    options.engine = render::Engine::Wavefront;
+    EXPECT_EQ(renderCornellBox(options), depthFirst);
+  }
+}
+
+TEST(threadCountFromText, acceptsOnlyPositiveCountsUpToTheLimit)
+{
+  EXPECT_EQ(render::threadCountFromText("1"), 1);
+  EXPECT_EQ(render::threadCountFromText("12"), 12);
+  EXPECT_EQ(render::threadCountFromText(std::to_string(render::maxThreadCount)), render::maxThreadCount);
+  for (auto const* text : { "-1", "0", "1025", "18446744073709551615", "4x", "", "threads" }) {
+    EXPECT_THROW(static_cast<void>(render::threadCountFromText(text)), std::invalid_argument) << text;
+  }
+}
+
+TEST(sampleCountFromText, acceptsOnlyCountsTheSampleIndicesCanHold)
+{
+  EXPECT_EQ(render::sampleCountFromText("1"), 1);
+  EXPECT_EQ(render::sampleCountFromText("64"), 64);
+  EXPECT_EQ(render::sampleCountFromText("4294967295"), render::sampleCountLimit);
+  for (auto const* text :
+    { "-1", "0", "+1", " 64", "64abc", "", "4294967296", "18446744073709551615", "99999999999999999999999" }) {
+    EXPECT_THROW(static_cast<void>(render::sampleCountFromText(text)), std::invalid_argument) << text;
+  }
+}
+
+TEST(positiveNumberFromText, acceptsOnlyFiniteNumbersAboveZero)
+{
+  EXPECT_EQ(render::positiveNumberFromText("0.01"), 0.01);
+  EXPECT_EQ(render::positiveNumberFromText("2"), 2.0);
+  EXPECT_EQ(render::positiveNumberFromText("1e3"), 1000.0);
+  for (auto const* text : { "0", "-0.5", "-0", "nan", "inf", "-inf", "1e999", "0.5s", "", "threshold" }) {
+    EXPECT_THROW(static_cast<void>(render::positiveNumberFromText(text)), std::invalid_argument) << text;
+  }
+}
+
+TEST(timeLimitFromText, acceptsOnlyLimitsTheSteadyClockCanCount)
+{
+  EXPECT_EQ(render::timeLimitFromText("2.5").count(), 2.5);
+  EXPECT_EQ(render::timeLimitFromText("3600").count(), 3600.0);
+  for (auto const* text : { "0", "-1", "nan", "inf", "1e300", "10s", "" }) {
+    EXPECT_THROW(static_cast<void>(render::timeLimitFromText(text)), std::invalid_argument) << text;
+  }
+}
+
+TEST(linearPartition, rejectsTimeLimitsOutOfRange)
+{
+  for (auto const seconds : { 0.0, -1.0, 1e300, std::numeric_limits<double>::quiet_NaN() }) {
+    EXPECT_THROW(static_cast<void>(renderCornellBox(
+                   { .seed = 42, .maxSampleCount = 2, .timeLimit = std::chrono::duration<double>{ seconds } })),
+      std::invalid_argument)
+      << seconds;
+  }
+}
+
+TEST(linearPartition, rejectsTargetErrorsThatCantBeReached)
+{
+  for (auto const targetError : { 0.0, -0.1, std::numeric_limits<double>::quiet_NaN() }) {
+    EXPECT_THROW(static_cast<void>(renderCornellBox({ .seed = 42, .maxSampleCount = 2, .targetError = targetError })),
+      std::invalid_argument)
+      << targetError;
+  }
+  // without a limit on the time or the samples the render might never end
+  EXPECT_THROW(static_cast<void>(renderCornellBox({ .seed = 42, .targetError = 0.1 })), std::invalid_argument);
+}
+
+TEST(linearPartition, rejectsSampleCountsOutOfRange)
+{
+  auto const adaptive = render::RenderOptions{ .seed = 42, .adaptiveThreshold = 0.05 };
+  auto options = adaptive;
+  options.minSampleCount = 10;
+  options.maxSampleCount = 9;
+  EXPECT_THROW(static_cast<void>(renderCornellBox(options)), std::invalid_argument);
+  options = adaptive;
+  options.minSampleCount = 0;
+  EXPECT_THROW(static_cast<void>(renderCornellBox(options)), std::invalid_argument);
+  options = adaptive;
+  options.maxSampleCount = 0;
+  EXPECT_THROW(static_cast<void>(renderCornellBox(options)), std::invalid_argument);
+  options = adaptive;
+  options.maxSampleCount = render::sampleCountLimit + 1;
+  EXPECT_THROW(static_cast<void>(renderCornellBox(options)), std::invalid_argument);
+  for (auto const threshold : { 0.0, -0.05, std::numeric_limits<double>::quiet_NaN() }) {
+    options = adaptive;
+    options.adaptiveThreshold = threshold;
+    EXPECT_THROW(static_cast<void>(renderCornellBox(options)), std::invalid_argument) << threshold;
+  }
+  // the default minimum is lowered to the maximum
+  options = adaptive;
+  options.maxSampleCount = 4;
+  EXPECT_NO_THROW(static_cast<void>(renderCornellBox(options)));
+}
+
+TEST(seedFromText, acceptsOnlyDigitsThatFit64Bits)
+{
+  EXPECT_EQ(render::seedFromText("0"), 0);
+  EXPECT_EQ(render::seedFromText("42"), 42);
+  EXPECT_EQ(render::seedFromText("18446744073709551615"), std::numeric_limits<std::uint64_t>::max());
+  for (auto const* text : { "-1", "+1", " 1", "12abc", "1 ", "", "0x10", "18446744073709551616" }) {
+    EXPECT_THROW(static_cast<void>(render::seedFromText(text)), std::invalid_argument) << text;
+  }
+}
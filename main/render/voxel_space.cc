@@ -2,7 +2,7 @@
 
 #include "lib/lina/vec3.h"
 #include "lib/trace/geometry/aabb.h"
-#include "lib/trace/geometry/cuboid.h"
+#include "lib/trace/geometry/component.h"
 #include "lib/trace/geometry/mesh.h"
 
 #include <algorithm>
@@ -43,80 +43,189 @@ auto Id::operator==(Id const& rhs) const -> bool { return object == rhs.object &
 
 VoxelSpace::VoxelSpace(std::vector<trace::Mesh> const& meshes)
 {
-  // To dynamically determine the appropriate voxel size, we go through each triangle and measure their
-  // volume. Take the average volume globally, assume that the triangles are perfectly evenly distributed
-  // along each of the three axes, fitting into a single voxel. Then we take the square root of this
-  // and divide the result by 10. Which ultimately means we divide our hypothetical space into a 1000 voxels.
-  // Of course this is a gross oversimplification, but it works as an estimate, cheap to calculate and
-  // simple to implement.
-  auto triangleCount = std::size_t{ 0 };
-  auto totalVolume = double{ 0.0 };
+  auto meshPointers = std::vector<trace::Mesh const*>{};
+  for (auto const& mesh : meshes) { meshPointers.emplace_back(&mesh); }
+  voxelDimension_ = estimateVoxelDimension(meshPointers);
+
   for (auto objectId = std::size_t{ 0 }; objectId < meshes.size(); objectId++) {
-    auto const& mesh = meshes[objectId];
-    for (auto triangleId = std::size_t{ 0 }; triangleId < mesh.triangleData.size(); triangleId++) {
-      auto const& triangleData = mesh.triangleData[triangleId];
-      auto const& triangleAabb = trace::triangleAabb(triangleData);
-      totalVolume += triangleAabb.volume();
-      triangleCount += 1;
+    registerTriangles(objectId, meshes[objectId]);
+  }
+  updateBoundingBox();
+}
+
+VoxelSpace::VoxelSpace(std::vector<trace::Component const*> const& components)
+{
+  auto meshPointers = std::vector<trace::Mesh const*>{};
+  auto analyticBoundingBoxes = std::vector<trace::Aabb>{};
+  for (auto const* component : components) {
+    if (component->IsAnalytic()) {
+      analyticBoundingBoxes.emplace_back(component->GetBoundingBox());
+    } else {
+      meshPointers.emplace_back(&component->GetMesh());
     }
   }
-  voxelDimension_ = std::max(std::cbrt(totalVolume / static_cast<double>(triangleCount)) / 10.0, 1.0);
+  voxelDimension_ = estimateVoxelDimension(meshPointers, analyticBoundingBoxes);
 
-  for (auto objectId = std::size_t{ 0 }; objectId < meshes.size(); objectId++) {
-    auto const& mesh = meshes[objectId];
-    for (auto triangleId = std::size_t{ 0 }; triangleId < mesh.triangleData.size(); triangleId++) {
-      // Simply get the bounding box of the triangle, convert the limit values into voxel identifiers
-      // on that dimension, and then just walk through the voxel matrix and check collision with the
-      // triangle
-      // Perhaps, not the most efficient algorithm, but very simple and good enough, as it only runs
-      // once before rendering a frame.
-      auto const& triangleData = mesh.triangleData[triangleId];
-      auto const& triangleAabb = trace::triangleAabb(triangleData);
+  for (auto objectId = std::size_t{ 0 }; objectId < components.size(); objectId++) {
+    auto const& component = *components[objectId];
+    if (component.IsAnalytic()) {
+      analyticObjects_.emplace_back(objectId);
+    } else {
+      registerTriangles(objectId, component.GetMesh());
+    }
+  }
+  updateBoundingBox();
+  buildAnalyticNodes(components);
+}
 
-      auto const startVoxelIdX = doubleToVoxelId(triangleAabb.minX, voxelDimension_);
-      auto const lastVoxelIdX = doubleToVoxelId(triangleAabb.maxX, voxelDimension_);
-      auto const startVoxelIdY = doubleToVoxelId(triangleAabb.minY, voxelDimension_);
-      auto const lastVoxelIdY = doubleToVoxelId(triangleAabb.maxY, voxelDimension_);
-      auto const startVoxelIdZ = doubleToVoxelId(triangleAabb.minZ, voxelDimension_);
-      auto const lastVoxelIdZ = doubleToVoxelId(triangleAabb.maxZ, voxelDimension_);
-
-      idAabb_.minVoxelIdX = std::min(idAabb_.minVoxelIdX, startVoxelIdX);
-      idAabb_.maxVoxelIdX = std::max(idAabb_.maxVoxelIdX, lastVoxelIdX);
-      idAabb_.minVoxelIdY = std::min(idAabb_.minVoxelIdY, startVoxelIdY);
-      idAabb_.maxVoxelIdY = std::max(idAabb_.maxVoxelIdY, lastVoxelIdY);
-      idAabb_.minVoxelIdZ = std::min(idAabb_.minVoxelIdZ, startVoxelIdZ);
-      idAabb_.maxVoxelIdZ = std::max(idAabb_.maxVoxelIdZ, lastVoxelIdZ);
-
-      for (auto voxelZ = startVoxelIdZ; voxelZ <= lastVoxelIdZ; voxelZ++) {
-        for (auto voxelX = startVoxelIdX; voxelX <= lastVoxelIdX; voxelX++) {
-          for (auto voxelY = startVoxelIdY; voxelY <= lastVoxelIdY; voxelY++) {
-            auto voxelCenter = lina::Vec3{ (static_cast<double>(voxelX) + 0.5) * voxelDimension_,
-              (static_cast<double>(voxelY) + 0.5) * voxelDimension_,
-              (static_cast<double>(voxelZ) + 0.5) * voxelDimension_ };
-            auto voxelId = vec3ToVoxelId(voxelCenter.Components(), voxelDimension_);
-
-            if (triangleVoxelCollide(voxelCenter, voxelDimension_, triangleData)) {
-              voxelTriangles_[voxelId].emplace(objectId, triangleId);
-            }
-          }
-        }
+// Leaves with at most this many objects aren't split any further.
+constexpr auto analyticLeafSize = std::size_t{ 2 };
+// The cost of visiting a node, testing the boxes of its children, compared to testing a component. Set by timing
+// the built-in scenes, with lower values the enclosing sphere of the floating sphere scene gets split off, which
+// only slows it down.
+constexpr auto analyticTraversalCost = 3.0;
+
+// Flat boxes, like the ones of the planes, are padded a little, so the rays hitting the plane aren't lost to the
+// rounding of the slab test.
+static auto paddedBox(trace::Aabb const& box) -> trace::Aabb
+{
+  auto const padding = 1e-6 * std::max({ 1.0, box.maxX - box.minX, box.maxY - box.minY, box.maxZ - box.minZ });
+  return trace::Aabb{ box.minX - padding,
+    box.maxX + padding,
+    box.minY - padding,
+    box.maxY + padding,
+    box.minZ - padding,
+    box.maxZ + padding };
+}
+
+static auto boxCenter(trace::Aabb const& box) -> std::array<double, 3>
+{
+  return { (box.minX + box.maxX) / 2.0, (box.minY + box.maxY) / 2.0, (box.minZ + box.maxZ) / 2.0 };
+}
+
+static auto surfaceArea(trace::Aabb const& box) -> double
+{
+  auto const x = box.maxX - box.minX;
+  auto const y = box.maxY - box.minY;
+  auto const z = box.maxZ - box.minZ;
+  return 2.0 * ((x * y) + (y * z) + (z * x));
+}
+
+static auto boundsOf(std::span<std::size_t const> objects, std::vector<trace::Aabb> const& boxes) -> trace::Aabb
+{
+  auto box = boxes[objects.front()];
+  for (auto const object : objects) { box = trace::mergeAABB(box, boxes[object]); }
+  return box;
+}
+
+// Appends the subtree of the objects depth first. The objects are split in half at the median of the centers of
+// their boxes, along the axis where the centers spread the most. A ray entering a box enters the boxes inside it
+// with the ratio of their surface areas, so the split is only kept, if the components the rays are expected to
+// test, plus the boxes of the children, are fewer than the components of the node. The walls of a room are never
+// split, every ray starts inside most of their boxes anyway.
+static auto appendAnalyticNodes(std::span<std::size_t> objects,
+  std::size_t first,
+  std::vector<trace::Aabb> const& boxes,
+  std::vector<AnalyticNode>& nodes) -> void
+{
+  auto const box = boundsOf(objects, boxes);
+  auto const index = nodes.size();
+  nodes.push_back(AnalyticNode{ box, first, objects.size(), 0 });
+  if (objects.size() > analyticLeafSize) {
+    auto minCenter = boxCenter(box);
+    auto maxCenter = minCenter;
+    for (auto const object : objects) {
+      auto const center = boxCenter(boxes[object]);
+      for (auto axis = std::size_t{ 0 }; axis < 3; ++axis) {
+        minCenter.at(axis) = std::min(minCenter.at(axis), center.at(axis));
+        maxCenter.at(axis) = std::max(maxCenter.at(axis), center.at(axis));
       }
     }
+    auto axis = std::size_t{ 0 };
+    for (auto candidate = std::size_t{ 1 }; candidate < 3; ++candidate) {
+      if (maxCenter.at(candidate) - minCenter.at(candidate) > maxCenter.at(axis) - minCenter.at(axis)) {
+        axis = candidate;
+      }
+    }
+    auto const middle = objects.size() / 2;
+    std::ranges::nth_element(objects,
+      objects.begin() + static_cast<std::ptrdiff_t>(middle),
+      {},
+      [&boxes, axis](std::size_t object) -> double { return boxCenter(boxes[object]).at(axis); });
+    auto const left = objects.first(middle);
+    auto const right = objects.subspan(middle);
+    auto const splitCost = analyticTraversalCost
+                           + (((surfaceArea(boundsOf(left, boxes)) * static_cast<double>(left.size()))
+                                + (surfaceArea(boundsOf(right, boxes)) * static_cast<double>(right.size())))
+                              / surfaceArea(box));
+    if (splitCost < static_cast<double>(objects.size())) {
+      nodes[index].count = 0;
+      appendAnalyticNodes(left, first, boxes, nodes);
+      appendAnalyticNodes(right, first + middle, boxes, nodes);
+    }
   }
+  nodes[index].skip = nodes.size();
+}
+
+auto VoxelSpace::buildAnalyticNodes(std::vector<trace::Component const*> const& components) -> void
+{
+  analyticNodeObjects_ = analyticObjects_;
+  if (analyticNodeObjects_.empty()) { return; }
+  auto boxes = std::vector<trace::Aabb>(components.size());
+  for (auto const objectId : analyticObjects_) { boxes[objectId] = paddedBox(components[objectId]->GetBoundingBox()); }
+  appendAnalyticNodes(analyticNodeObjects_, 0, boxes, analyticNodes_);
+}
+
+auto VoxelSpace::registerTriangles(std::size_t objectId, trace::Mesh const& mesh) -> void
+{
+  for (auto triangleId = std::size_t{ 0 }; triangleId < mesh.triangleData.size(); triangleId++) {
+    // Simply get the bounding box of the triangle, convert the limit values into voxel identifiers
+    // on that dimension, and then just walk through the voxel matrix and check collision with the
+    // triangle
+    // Perhaps, not the most efficient algorithm, but very simple and good enough, as it only runs
+    // once before rendering a frame.
+    auto const& triangleData = mesh.triangleData[triangleId];
+    auto const& triangleAabb = trace::triangleAabb(triangleData);
 
-  auto minX = static_cast<double>(idAabb_.minVoxelIdX) * voxelDimension_;
-  auto maxX = static_cast<double>(idAabb_.maxVoxelIdX + 1) * voxelDimension_;
-  auto minY = static_cast<double>(idAabb_.minVoxelIdY) * voxelDimension_;
-  auto maxY = static_cast<double>(idAabb_.maxVoxelIdY + 1) * voxelDimension_;
-  auto minZ = static_cast<double>(idAabb_.minVoxelIdZ) * voxelDimension_;
-  auto maxZ = static_cast<double>(idAabb_.maxVoxelIdZ + 1) * voxelDimension_;
+    auto const startVoxelIdX = doubleToVoxelId(triangleAabb.minX, voxelDimension_);
+    auto const lastVoxelIdX = doubleToVoxelId(triangleAabb.maxX, voxelDimension_);
+    auto const startVoxelIdY = doubleToVoxelId(triangleAabb.minY, voxelDimension_);
+    auto const lastVoxelIdY = doubleToVoxelId(triangleAabb.maxY, voxelDimension_);
+    auto const startVoxelIdZ = doubleToVoxelId(triangleAabb.minZ, voxelDimension_);
+    auto const lastVoxelIdZ = doubleToVoxelId(triangleAabb.maxZ, voxelDimension_);
 
-  auto center = 0.5 * lina::Vec3{ minX + maxX, minY + maxY, minZ + maxZ };
-  auto width = std::max(maxX - minX, 0.1);
-  auto depth = std::max(maxY - minY, 0.1);
-  auto height = std::max(maxZ - minZ, 0.1);
+    idAabb_.minVoxelIdX = std::min(idAabb_.minVoxelIdX, startVoxelIdX);
+    idAabb_.maxVoxelIdX = std::max(idAabb_.maxVoxelIdX, lastVoxelIdX);
+    idAabb_.minVoxelIdY = std::min(idAabb_.minVoxelIdY, startVoxelIdY);
+    idAabb_.maxVoxelIdY = std::max(idAabb_.maxVoxelIdY, lastVoxelIdY);
+    idAabb_.minVoxelIdZ = std::min(idAabb_.minVoxelIdZ, startVoxelIdZ);
+    idAabb_.maxVoxelIdZ = std::max(idAabb_.maxVoxelIdZ, lastVoxelIdZ);
 
-  boundingBox_ = trace::buildCuboid(center, width, depth, height);
+    for (auto voxelZ = startVoxelIdZ; voxelZ <= lastVoxelIdZ; voxelZ++) {
+      for (auto voxelX = startVoxelIdX; voxelX <= lastVoxelIdX; voxelX++) {
+        for (auto voxelY = startVoxelIdY; voxelY <= lastVoxelIdY; voxelY++) {
+          auto voxelCenter = lina::Vec3{ (static_cast<double>(voxelX) + 0.5) * voxelDimension_,
+            (static_cast<double>(voxelY) + 0.5) * voxelDimension_,
+            (static_cast<double>(voxelZ) + 0.5) * voxelDimension_ };
+          auto voxelId = vec3ToVoxelId(voxelCenter.Components(), voxelDimension_);
+
+          if (triangleVoxelCollide(voxelCenter, voxelDimension_, triangleData)) {
+            voxelTriangles_[voxelId].emplace(objectId, triangleId);
+          }
+        }
+      }
+    }
+  }
+}
+
+auto VoxelSpace::updateBoundingBox() -> void
+{
+  boundingBox_ = trace::Aabb{ static_cast<double>(idAabb_.minVoxelIdX) * voxelDimension_,
+    static_cast<double>(idAabb_.maxVoxelIdX + 1) * voxelDimension_,
+    static_cast<double>(idAabb_.minVoxelIdY) * voxelDimension_,
+    static_cast<double>(idAabb_.maxVoxelIdY + 1) * voxelDimension_,
+    static_cast<double>(idAabb_.minVoxelIdZ) * voxelDimension_,
+    static_cast<double>(idAabb_.maxVoxelIdZ + 1) * voxelDimension_ };
 }
 
 auto VoxelSpace::trianglesInVoxelByPosition(std::span<double const, 3> position) const
@@ -140,7 +249,13 @@ auto VoxelSpace::Dimension() const -> double { return voxelDimension_; }
 
 auto VoxelSpace::IdAabb() const -> IdAABB const& { return idAabb_; }
 
-auto VoxelSpace::BoundingBox() const -> trace::Cuboid const& { return boundingBox_; }
+auto VoxelSpace::BoundingBox() const -> trace::Aabb const& { return boundingBox_; }
+
+auto VoxelSpace::AnalyticObjects() const -> std::vector<std::size_t> const& { return analyticObjects_; }
+
+auto VoxelSpace::AnalyticNodes() const -> std::vector<AnalyticNode> const& { return analyticNodes_; }
+
+auto VoxelSpace::AnalyticNodeObjects() const -> std::vector<std::size_t> const& { return analyticNodeObjects_; }
 
 auto VoxelSpace::VoxelTriangles() const
   -> std::unordered_map<std::array<int64_t, 3>, std::unordered_set<Id, IdHash>, VoxelIdHash> const&
@@ -148,6 +263,35 @@ auto VoxelSpace::VoxelTriangles() const
   return voxelTriangles_;
 }
 
+// To dynamically determine the appropriate voxel size, we go through each triangle and measure their
+// volume. Take the average volume globally, assume that the triangles are perfectly evenly distributed
+// along each of the three axes, fitting into a single voxel. Then we take the square root of this
+// and divide the result by 10. Which ultimately means we divide our hypothetical space into a 1000 voxels.
+// Of course this is a gross oversimplification, but it works as an estimate, cheap to calculate and
+// simple to implement.
+// Analytic components are not registered, but they still tell how large the scene is, without them a
+// huge sphere around a few flat planes would leave us with tiny voxels. Each counts as a single element
+// filling its bounding box.
+auto estimateVoxelDimension(std::vector<trace::Mesh const*> const& meshes,
+  std::vector<trace::Aabb> const& analyticBoundingBoxes) -> double
+{
+  auto triangleCount = std::size_t{ 0 };
+  auto totalVolume = double{ 0.0 };
+  for (auto const* mesh : meshes) {
+    for (auto const& triangleData : mesh->triangleData) {
+      auto const& triangleAabb = trace::triangleAabb(triangleData);
+      totalVolume += triangleAabb.volume();
+      triangleCount += 1;
+    }
+  }
+  for (auto const& boundingBox : analyticBoundingBoxes) {
+    totalVolume += boundingBox.volume();
+    triangleCount += 1;
+  }
+  if (triangleCount == 0) { return 1.0; }
+  return std::max(std::cbrt(totalVolume / static_cast<double>(triangleCount)) / 10.0, 1.0);
+}
+
 auto doubleToVoxelId(double value, double voxelDimension) -> int64_t { return std::floor(value / voxelDimension); }
 
 auto vec3ToVoxelId(std::span<double const, 3> position, double voxelDimension) -> std::array<int64_t, 3>
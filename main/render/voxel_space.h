@@ -1,7 +1,8 @@
 #ifndef RAY_BUSTER_MAIN_RENDER_VOXEL_SPACE_H_
 #define RAY_BUSTER_MAIN_RENDER_VOXEL_SPACE_H_
 
-#include "lib/trace/geometry/cuboid.h"
+#include "lib/trace/geometry/aabb.h"
+#include "lib/trace/geometry/component.h"
 #include "lib/trace/geometry/mesh.h"
 
 #include <array>
@@ -44,10 +45,25 @@ struct IdAABB
   int64_t maxVoxelIdZ = std::numeric_limits<int64_t>::min();
 };
 
+// A node of the bounding volume hierarchy over the analytic components. The nodes are stored depth first, so the
+// first child of an inner node is the node right after it, and skip is the index of the node after its whole
+// subtree. A ray missing the box of a node continues at skip, otherwise at the next node. Leaves refer to the
+// objects [first, first + count) of AnalyticNodeObjects(), inner nodes have none.
+struct AnalyticNode
+{
+  trace::Aabb box;
+  std::size_t first;
+  std::size_t count;
+  std::size_t skip;
+};
+
 class VoxelSpace
 {
 public:
   explicit VoxelSpace(std::vector<trace::Mesh> const& meshes);
+  // Object ids are the indices of the components. Analytic components have no triangles to register, they are
+  // collected into a bounding volume hierarchy of their own instead.
+  explicit VoxelSpace(std::vector<trace::Component const*> const& components);
   VoxelSpace(VoxelSpace const&) = default;
   VoxelSpace(VoxelSpace&&) = default;
   auto operator=(VoxelSpace const&) -> VoxelSpace& = default;
@@ -60,18 +76,31 @@ public:
     -> std::optional<std::unordered_set<Id, IdHash> const*>;
   [[nodiscard]] auto Dimension() const -> double;
   [[nodiscard]] auto IdAabb() const -> IdAABB const&;
-  [[nodiscard]] auto BoundingBox() const -> trace::Cuboid const&;
+  [[nodiscard]] auto BoundingBox() const -> trace::Aabb const&;
+  [[nodiscard]] auto AnalyticObjects() const -> std::vector<std::size_t> const&;
+  [[nodiscard]] auto AnalyticNodes() const -> std::vector<AnalyticNode> const&;
+  // The analytic objects in the order the leaves refer to them.
+  [[nodiscard]] auto AnalyticNodeObjects() const -> std::vector<std::size_t> const&;
 
   [[nodiscard]] auto VoxelTriangles() const
     -> std::unordered_map<std::array<int64_t, 3>, std::unordered_set<Id, IdHash>, VoxelIdHash> const&;
 
 private:
+  auto registerTriangles(std::size_t objectId, trace::Mesh const& mesh) -> void;
+  auto updateBoundingBox() -> void;
+  auto buildAnalyticNodes(std::vector<trace::Component const*> const& components) -> void;
+
   std::unordered_map<std::array<int64_t, 3>, std::unordered_set<Id, IdHash>, VoxelIdHash> voxelTriangles_;
   double voxelDimension_;
   IdAABB idAabb_;
-  trace::Cuboid boundingBox_;
+  trace::Aabb boundingBox_;
+  std::vector<std::size_t> analyticObjects_;
+  std::vector<AnalyticNode> analyticNodes_;
+  std::vector<std::size_t> analyticNodeObjects_;
 };
 
+auto estimateVoxelDimension(std::vector<trace::Mesh const*> const& meshes,
+  std::vector<trace::Aabb> const& analyticBoundingBoxes = {}) -> double;
 auto doubleToVoxelId(double value, double voxelDimension) -> int64_t;
 auto vec3ToVoxelId(std::span<double const, 3> position, double voxelDimension) -> std::array<int64_t, 3>;
 
@@ -1,10 +1,15 @@
 #include "lib/lina/vec3.h"
 #include "lib/trace/geometry/mesh.h"
+#include "lib/trace/geometry/component.h"
+#include "lib/trace/geometry/icosphere.h"
 #include "lib/trace/geometry/plane.h"
+#include "lib/trace/geometry/sphere.h"
 #include "main/render/voxel_space.h"
 
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <gtest/gtest.h>
 #include <vector>
@@ -72,4 +77,66 @@ TEST(unitSizedVoxelSpace, unitSquarePlaneShiftedIntoPositiveFromOrigoPerpendicul
     EXPECT_TRUE(std::ranges::find_if(ids, [](auto const& id) { return id.triangle == 0; }) != ids.end());
     EXPECT_TRUE(std::ranges::find_if(ids, [](auto const& id) { return id.triangle == 1; }) != ids.end());
   }
-}
\ No newline at end of file
+}
+TEST(unitSizedVoxelSpace, analyticComponentsAreCollectedInsteadOfRegistered)
+{
+  auto icosphere = trace::buildIcosphere(lina::Vec3{ 0.5, 0.5, 0.5 }, 0.5, 0);
+  auto sphere = trace::buildSphere(lina::Vec3{ 0.0, 0.0, 0.0 }, 6.0);
+  auto plane = trace::buildPlane(lina::Vec3{ 0.0, 0.0, 0.0 }, 10.0, 10.0);
+  auto components = std::vector<trace::Component const*>{ &icosphere, &sphere, &plane };
+
+  auto voxelSpace = render::VoxelSpace{ components };
+
+  EXPECT_EQ(voxelSpace.Dimension(), 1.0);
+  EXPECT_EQ(voxelSpace.VoxelTriangles().size(), 1);
+  ASSERT_EQ(voxelSpace.AnalyticObjects().size(), 2);
+  EXPECT_EQ(voxelSpace.AnalyticObjects()[0], 1);
+  EXPECT_EQ(voxelSpace.AnalyticObjects()[1], 2);
+  for (auto const& [voxelId, ids] : voxelSpace.VoxelTriangles()) {
+    EXPECT_TRUE(std::ranges::all_of(ids, [](render::Id const& id) -> bool { return id.object == 0; }));
+  }
+}
+
+TEST(unitSizedVoxelSpace, analyticHierarchyHoldsEveryAnalyticComponentOnce)
+{
+  auto spheres = std::vector<trace::Sphere>{};
+  for (auto i = 0; i < 7; ++i) {
+    spheres.emplace_back(trace::buildSphere(lina::Vec3{ static_cast<double>(i) * 3.0, 0.0, 0.0 }, 1.0));
+  }
+  auto components = std::vector<trace::Component const*>{};
+  for (auto const& sphere : spheres) { components.emplace_back(&sphere); }
+
+  auto voxelSpace = render::VoxelSpace{ components };
+  auto const& nodes = voxelSpace.AnalyticNodes();
+  auto const& objects = voxelSpace.AnalyticNodeObjects();
+
+  ASSERT_FALSE(nodes.empty());
+  EXPECT_EQ(nodes.front().skip, nodes.size());
+  auto leafObjects = std::vector<std::size_t>{};
+  for (auto nodeIndex = std::size_t{ 0 }; nodeIndex < nodes.size(); ++nodeIndex) {
+    auto const& node = nodes[nodeIndex];
+    EXPECT_GT(node.skip, nodeIndex);
+    for (auto i = node.first; i < node.first + node.count; ++i) {
+      leafObjects.emplace_back(objects[i]);
+      // the box of the leaf contains the box of its objects
+      auto const box = spheres[objects[i]].GetBoundingBox();
+      EXPECT_LE(node.box.minX, box.minX);
+      EXPECT_GE(node.box.maxX, box.maxX);
+    }
+  }
+  std::ranges::sort(leafObjects);
+  EXPECT_EQ(leafObjects, voxelSpace.AnalyticObjects());
+}
+
+TEST(estimateVoxelDimension, analyticComponentsCountAsOneElementFillingTheirBoundingBox)
+{
+  auto plane = trace::buildPlane(lina::Vec3{ 0.0, 0.0, 0.0 }, 6000.0, 6000.0);
+  auto sphere = trace::buildSphere(lina::Vec3{ 0.0, 0.0, 0.0 }, 200.0);
+  auto meshes = std::vector<trace::Mesh const*>{ &plane.GetMesh() };
+
+  // flat triangles have no volume
+  EXPECT_DOUBLE_EQ(render::estimateVoxelDimension(meshes), 1.0);
+  // two triangles of the plane and the sphere
+  EXPECT_DOUBLE_EQ(
+    render::estimateVoxelDimension(meshes, { sphere.GetBoundingBox() }), std::cbrt(200.0 * 200.0 * 200.0 / 3.0) / 10.0);
+}
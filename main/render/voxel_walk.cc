@@ -0,0 +1,132 @@
+#include "main/render/voxel_walk.h"
+
+#include "lib/lina/vec3.h"
+#include "lib/trace/collision.h"
+#include "lib/trace/geometry/aabb.h"
+#include "lib/trace/geometry/mesh.h"
+#include "lib/trace/ray.h"
+#include "main/render/voxel_space.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+
+namespace render {
+
+VoxelWalk::VoxelWalk(trace::Ray ray,
+  VoxelSpace const& voxelSpace,
+  std::pair<std::optional<trace::Collision>, std::size_t> const& closestSoFar)
+  : ray_{ ray }, voxelIdAabb_{ voxelSpace.IdAabb() }, voxelId_{}, step_{ 1, 1, 1 }, T_{}, SD_{},
+    closestDistance_{ std::numeric_limits<double>::infinity() }, objectId_{ 0 }, result_{ closestSoFar },
+    walking_{ false }
+{
+  if (closestSoFar.first) { closestDistance_ = (closestSoFar.first->point - ray_.Source()).Length(); }
+  if (voxelSpace.VoxelTriangles().empty()) { return; }
+
+  // Find starting position's voxel
+  auto const slabCollision = trace::slabCollide(voxelSpace.BoundingBox(), ray_);
+  if (!slabCollision) { return; }
+  // hit the voxel space from the outside => push the ray into it
+  // the distances in the voxel space are measured from the new source from here on
+  if (slabCollision->entry > 0.0) {
+    auto const push = slabCollision->entry + 0.00001;
+    if (closestDistance_ <= push) { return; }
+    ray_ = trace::Ray{ ray_.Source() + ray_.Direction() * push, ray_.Direction() };
+    closestDistance_ -= push;
+  }
+
+  auto const Td = voxelSpace.Dimension();
+  voxelId_ = vec3ToVoxelId(ray_.Source().Components(), Td);
+  // At grazing angles the pushed in source may still be just outside on another axis, so we snap it onto the
+  // boundary voxels.
+  voxelId_[0] = std::clamp(voxelId_[0], voxelIdAabb_.minVoxelIdX, voxelIdAabb_.maxVoxelIdX);
+  voxelId_[1] = std::clamp(voxelId_[1], voxelIdAabb_.minVoxelIdY, voxelIdAabb_.maxVoxelIdY);
+  voxelId_[2] = std::clamp(voxelId_[2], voxelIdAabb_.minVoxelIdZ, voxelIdAabb_.maxVoxelIdZ);
+
+  auto const dx = ray_.Direction()[0];
+  auto const dy = ray_.Direction()[1];
+  auto const dz = ray_.Direction()[2];
+  // Calculate scaling factor for each dimension
+  auto const S = std::array<double, 3>{ std::sqrt(1.0 + std::pow(dy / dx, 2.0) + std::pow(dz / dx, 2.0)),
+    std::sqrt(1.0 + std::pow(dx / dy, 2.0) + std::pow(dz / dy, 2.0)),
+    std::sqrt(1.0 + std::pow(dx / dz, 2.0) + std::pow(dy / dz, 2.0)) };
+  // 'A' vector is the distance from the voxels starting corner
+  auto const A = ray_.Source()
+                 - lina::Vec3{ static_cast<double>(voxelId_[0]) * Td,
+                     static_cast<double>(voxelId_[1]) * Td,
+                     static_cast<double>(voxelId_[2]) * Td };
+
+  // Initialize step direction and initial travel distances on each dimension.
+  for (auto axis = std::size_t{ 0 }; axis < 3; ++axis) {
+    SD_[axis] = S[axis] * Td;
+    T_[axis] = (Td - A[axis]) * S[axis];
+    if (ray_.Direction()[axis] < 0.0) {
+      step_[axis] = int64_t{ -1 };
+      T_[axis] = A[axis] * S[axis];
+    }
+  }
+  walking_ = true;
+}
+
+auto VoxelWalk::Walking() const -> bool { return walking_; }
+
+auto VoxelWalk::VoxelId() const -> std::array<int64_t, 3> const& { return voxelId_; }
+
+auto VoxelWalk::Ray() const -> trace::Ray const& { return ray_; }
+
+auto VoxelWalk::Consider(std::optional<trace::MeshCollision> const& triangleCollision, std::size_t objectId) -> void
+{
+  if (!triangleCollision) { return; }
+  // A collision only matters if it is in the currently checked voxel!
+  // auto collisionVoxelId = vec3ToVoxelId(triangleCollision->collision.point.Components(), Td);
+  // Unfortunately, due to floating point issues we may get a voxelId which is not the current one
+  // even though we should hit the triangle right now.
+  // The solution is to keep track of the maxT distance we could see given the current voxel for a collision.
+  // If the distance is smaller then this maxT (+ a small epsilon as always), we can be sure we have hit
+  // the object.
+  if (triangleCollision->distance <= maxT() + 0.00001) {
+    if (!closestTriangleCollision_ || closestTriangleCollision_->distance > triangleCollision->distance) {
+      closestTriangleCollision_ = triangleCollision;
+      objectId_ = objectId;
+    }
+  }
+}
+
+auto VoxelWalk::Step() -> void
+{
+  if (!walking_) { return; }
+  if (closestTriangleCollision_ && closestTriangleCollision_->distance < closestDistance_) {
+    result_ = std::make_pair(std::optional<trace::Collision>{ closestTriangleCollision_->collision }, objectId_);
+    walking_ = false;
+    return;
+  }
+  // no triangle in the voxels ahead can be closer than this
+  if (closestDistance_ <= maxT()) {
+    walking_ = false;
+    return;
+  }
+
+  auto axis = std::size_t{ 2 };
+  if (T_[0] < T_[1]) {
+    if (T_[0] < T_[2]) { axis = 0; }
+  } else {
+    if (T_[1] < T_[2]) { axis = 1; }
+  }
+  voxelId_[axis] += step_[axis];
+  T_[axis] += SD_[axis];
+
+  walking_ = voxelIdAabb_.minVoxelIdX <= voxelId_[0] && voxelId_[0] <= voxelIdAabb_.maxVoxelIdX
+             && voxelIdAabb_.minVoxelIdY <= voxelId_[1] && voxelId_[1] <= voxelIdAabb_.maxVoxelIdY
+             && voxelIdAabb_.minVoxelIdZ <= voxelId_[2] && voxelId_[2] <= voxelIdAabb_.maxVoxelIdZ;
+}
+
+auto VoxelWalk::Result() const -> std::pair<std::optional<trace::Collision>, std::size_t> const& { return result_; }
+
+auto VoxelWalk::maxT() const -> double { return std::min({ T_[0], T_[1], T_[2] }); }
+
+}// namespace render
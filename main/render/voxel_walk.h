@@ -0,0 +1,69 @@
+#ifndef RAY_BUSTER_MAIN_RENDER_VOXEL_WALK_H_
+#define RAY_BUSTER_MAIN_RENDER_VOXEL_WALK_H_
+
+#include "lib/trace/collision.h"
+#include "lib/trace/geometry/mesh.h"
+#include "lib/trace/ray.h"
+#include "main/render/voxel_space.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+namespace render {
+
+// A ray walking through the voxel space, one voxel at a time.
+// 3D DDA source: http://www.cse.yorku.ca/~amana/research/grid.pdf
+// John Amanatides, Andrew Woo "A Fast Voxel Traversal Algorithm for Ray Tracing"
+// Based on the ideas from: https://www.youtube.com/watch?v=NbSee-XM7WA
+// The walk itself doesn't check the triangles, the caller does it for the current voxel, so a number of rays
+// in the same voxel can be checked together, while each of them still visits exactly the voxels it would alone.
+class VoxelWalk
+{
+public:
+  // Only triangles closer than closestSoFar are considered, otherwise the result remains closestSoFar.
+  VoxelWalk(trace::Ray ray,
+    VoxelSpace const& voxelSpace,
+    std::pair<std::optional<trace::Collision>, std::size_t> const& closestSoFar);
+  VoxelWalk(VoxelWalk const&) = default;
+  VoxelWalk(VoxelWalk&&) = default;
+  auto operator=(VoxelWalk const&) -> VoxelWalk& = default;
+  auto operator=(VoxelWalk&&) -> VoxelWalk& = default;
+  ~VoxelWalk() = default;
+
+  // Is there a voxel left to check?
+  [[nodiscard]] auto Walking() const -> bool;
+  [[nodiscard]] auto VoxelId() const -> std::array<int64_t, 3> const&;
+  // The ray to check the triangles with. If it started outside of the voxel space, it is pushed into it.
+  [[nodiscard]] auto Ray() const -> trace::Ray const&;
+  // Take a collision with a triangle of the current voxel into account.
+  auto Consider(std::optional<trace::MeshCollision> const& triangleCollision, std::size_t objectId) -> void;
+  // Done with the current voxel, either finish or move onto the next one.
+  auto Step() -> void;
+  [[nodiscard]] auto Result() const -> std::pair<std::optional<trace::Collision>, std::size_t> const&;
+
+private:
+  // maxT represents the maximum distance our ray could travel given the current voxel and its trajectory
+  [[nodiscard]] auto maxT() const -> double;
+
+  trace::Ray ray_;
+  IdAABB voxelIdAabb_;
+  std::array<int64_t, 3> voxelId_;
+  std::array<int64_t, 3> step_;
+  // travelled distance to the next voxel boundary on each axis
+  std::array<double, 3> T_;
+  // step delta for each dimension
+  std::array<double, 3> SD_;
+  // any triangle has to be closer than the collision found so far to count
+  double closestDistance_;
+  std::optional<trace::MeshCollision> closestTriangleCollision_;
+  std::size_t objectId_;
+  std::pair<std::optional<trace::Collision>, std::size_t> result_;
+  bool walking_;
+};
+
+}// namespace render
+
+#endif
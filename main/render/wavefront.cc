@@ -0,0 +1,145 @@
+#include "main/render/wavefront.h"
+
+#include "lib/lina/vec3.h"
+#include "lib/trace/camera.h"
+#include "lib/trace/collision.h"
+#include "lib/trace/material_table.h"
+#include "lib/trace/ray.h"
+#include "lib/trace/sampler.h"
+#include "main/render/light_sampler.h"
+#include "main/render/pixel_partition.h"
+#include "main/render/voxel_space.h"
+#include "main/scenes/scene.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <format>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace render {
+
+auto wavefrontColors(std::span<PixelSample const> samples,
+  trace::Camera const& camera,
+  bool multiSampled,
+  std::vector<scene::Element> const& sceneElements,
+  trace::MaterialTable const& materials,
+  render::VoxelSpace const& voxelSpace,
+  LightSampler const& lightSampler,
+  trace::Sampler& sampler,
+  std::size_t depth,
+  bool useSkybox,
+  bool multipleImportanceSampling,
+  bool russianRoulette,
+  std::span<lina::Vec3> colors) -> void
+{
+  if (colors.size() != samples.size()) {
+    throw std::logic_error(std::format("Invalid wavefront: {} samples, {} colors", samples.size(), colors.size()));
+  }
+  auto const imageWidth = camera.ImageWidth();
+
+  // generate
+  auto paths = std::vector<PathState>(samples.size());
+  auto positions = std::vector<trace::SamplerPosition>(samples.size());
+  for (auto id = std::size_t{ 0 }; id < samples.size(); ++id) {
+    auto const pixelId = samples[id].pixelId;
+    sampler.StartPath(pixelId, samples[id].sample);
+    paths[id].ray = camera.GetSampleRayAt(pixelId / imageWidth, pixelId % imageWidth, sampler, multiSampled);
+    positions[id] = sampler.Position();
+  }
+
+  // the order the materials are shaded in: by their kind, then by their index, the misses last
+  auto materialOrder = std::vector<std::size_t>(sceneElements.size());
+  std::iota(materialOrder.begin(), materialOrder.end(), std::size_t{ 0 });
+  std::ranges::sort(materialOrder, {}, [&materials](std::size_t elementIndex) -> std::pair<std::size_t, std::size_t> {
+    return { materials.Kind(elementIndex), elementIndex };
+  });
+  auto materialRank = std::vector<std::size_t>(sceneElements.size());
+  for (auto rank = std::size_t{ 0 }; rank < materialOrder.size(); ++rank) { materialRank[materialOrder[rank]] = rank; }
+  auto const missRank = sceneElements.size();
+
+  auto collisions = std::vector<std::pair<std::optional<trace::Collision>, std::size_t>>(samples.size());
+  auto active = std::vector<std::size_t>(samples.size());
+  std::iota(active.begin(), active.end(), std::size_t{ 0 });
+  auto batched = std::vector<std::size_t>(samples.size());
+  auto batchStarts = std::vector<std::size_t>(missRank + 2);
+  auto batchBuffers = RayBatchBuffers{};
+  auto activeRays = std::vector<trace::Ray>{};
+  auto activeCollisions = std::vector<std::pair<std::optional<trace::Collision>, std::size_t>>{};
+  auto shadowRays = std::vector<ShadowRay>{};
+  auto shadowIds = std::vector<std::size_t>{};
+  auto occluded = std::vector<bool>{};
+  auto packetRays = std::array<trace::Ray, packetSize>{};
+  auto cameraRays = true;
+  while (!active.empty() && depth > 0) {
+    // extend
+    // the camera rays of neighbouring samples are coherent, the scattered rays are not
+    if (cameraRays) {
+      for (auto start = std::size_t{ 0 }; start < paths.size(); start += packetSize) {
+        auto const count = std::min(packetSize, paths.size() - start);
+        for (auto k = std::size_t{ 0 }; k < count; ++k) { packetRays[k] = paths[start + k].ray; }
+        closestPacketCollisions(std::span{ packetRays }.first(count),
+          sceneElements,
+          voxelSpace,
+          std::span{ collisions }.subspan(start, count));
+      }
+      cameraRays = false;
+    } else {
+      activeRays.clear();
+      for (auto const id : active) { activeRays.emplace_back(paths[id].ray); }
+      activeCollisions.resize(active.size());
+      closestBatchCollisions(activeRays, sceneElements, voxelSpace, batchBuffers, activeCollisions);
+      for (auto k = std::size_t{ 0 }; k < active.size(); ++k) { collisions[active[k]] = activeCollisions[k]; }
+    }
+
+    // shade
+    // a batch for every material, a counting sort of the paths by the rank of the material they hit
+    auto const rankOf = [&collisions, &materialRank, missRank](std::size_t id) -> std::size_t {
+      auto const& [collision, elementIndex] = collisions[id];
+      return collision ? materialRank[elementIndex] : missRank;
+    };
+    std::ranges::fill(batchStarts, std::size_t{ 0 });
+    for (auto const id : active) { ++batchStarts[rankOf(id) + 1]; }
+    std::partial_sum(batchStarts.begin(), batchStarts.end(), batchStarts.begin());
+    for (auto const id : active) { batched[batchStarts[rankOf(id)]++] = id; }
+
+    shadowRays.clear();
+    shadowIds.clear();
+    for (auto const id : std::span{ batched }.first(active.size())) {
+      auto& path = paths[id];
+      sampler.Resume(positions[id]);
+      auto shadowRay = shadeCollision(path,
+        collisions[id],
+        sceneElements,
+        materials,
+        lightSampler,
+        sampler,
+        depth,
+        useSkybox,
+        multipleImportanceSampling,
+        russianRoulette);
+      positions[id] = sampler.Position();
+      if (shadowRay) {
+        shadowRays.emplace_back(shadowRay.value());
+        shadowIds.emplace_back(id);
+      }
+    }
+
+    // shadow
+    occludedShadowRays(shadowRays, sceneElements, voxelSpace, batchBuffers, occluded);
+    for (auto k = std::size_t{ 0 }; k < shadowRays.size(); ++k) {
+      if (!occluded[k]) { paths[shadowIds[k]].color += shadowRays[k].contribution; }
+    }
+
+    std::erase_if(active, [&paths](std::size_t id) -> bool { return !paths[id].active; });
+  }
+
+  for (auto id = std::size_t{ 0 }; id < samples.size(); ++id) { colors[id] = paths[id].color; }
+}
+
+}// namespace render
@@ -0,0 +1,57 @@
+#ifndef RAY_BUSTER_MAIN_RENDER_WAVEFRONT_H_
+#define RAY_BUSTER_MAIN_RENDER_WAVEFRONT_H_
+
+#include "lib/lina/vec3.h"
+#include "lib/trace/camera.h"
+#include "lib/trace/material_table.h"
+#include "lib/trace/sampler.h"
+#include "main/render/light_sampler.h"
+#include "main/render/voxel_space.h"
+#include "main/scenes/scene.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace render {
+
+// The number of pixels whose samples the wavefront engine traces together.
+constexpr auto wavefrontPixelCount = std::size_t{ 64 };
+
+struct PixelSample
+{
+  std::size_t pixelId;
+  std::uint32_t sample;
+};
+
+// Traces the paths of the samples breadth first, one stage at a time for all of them, instead of one path after the
+// other. The stages are
+//  - generate: the camera rays of the samples,
+//  - extend: the closest collisions of the rays of the paths still going, the camera rays in packets, the scattered
+//    rays in a batch checked against every component at once, see closestBatchCollisions,
+//  - shade: shadeCollision for every path, in batches of the paths hitting the same material, so the same code and
+//    material data are used back to back,
+//  - shadow: the occlusion tests of the shadow rays the shading made, in a batch as well.
+// The last three repeat until every path has ended. Each stage makes a single pass over the arrays of the paths, so
+// its code and the scene data it needs stay in the caches, instead of every path going through all of them in turn.
+// Every path keeps the position of the sampler, which is resumed before shading it, so every path draws the same
+// numbers as it would in lightSamplingColor, and the colors are exactly the same. They are written into colors in the
+// order of the samples.
+auto wavefrontColors(std::span<PixelSample const> samples,
+  trace::Camera const& camera,
+  bool multiSampled,
+  std::vector<scene::Element> const& sceneElements,
+  trace::MaterialTable const& materials,
+  render::VoxelSpace const& voxelSpace,
+  LightSampler const& lightSampler,
+  trace::Sampler& sampler,
+  std::size_t depth,
+  bool useSkybox,
+  bool multipleImportanceSampling,
+  bool russianRoulette,
+  std::span<lina::Vec3> colors) -> void;
+
+}// namespace render
+
+#endif
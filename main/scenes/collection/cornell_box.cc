@@ -1,8 +1,8 @@
 #include "lib/lina/vec3.h"
 #include "lib/trace/camera.h"
 #include "lib/trace/geometry/cuboid.h"
-#include "lib/trace/geometry/icosphere.h"
 #include "lib/trace/geometry/plane.h"
+#include "lib/trace/geometry/sphere.h"
 #include "lib/trace/material/dielectric.h"
 #include "lib/trace/material/emissive.h"
 #include "lib/trace/material/lambertian.h"
@@ -124,7 +124,7 @@ auto cornellBoxAdvanced(RenderSettings const& settings) -> Composition
   sceneElements.emplace_back(
     std::move(cuboidOne), std::make_unique<trace::Metal>(lina::Vec3{ 0.8, 0.85, 0.88 }));// aluminium
 
-  auto sphere = std::make_unique<trace::Icosphere>(trace::buildIcosphere(lina::Vec3{ 22.0, -8.0, 17.5 }, 35.0, 4));
+  auto sphere = std::make_unique<trace::Sphere>(trace::buildSphere(lina::Vec3{ 22.0, -8.0, 17.5 }, 35.0));
   sceneElements.emplace_back(std::move(sphere), std::make_unique<trace::Dielectric>(1.4));
 
   return Composition{
@@ -2,8 +2,8 @@
 
 #include "lib/lina/vec3.h"
 #include "lib/trace/camera.h"
-#include "lib/trace/geometry/icosphere.h"
 #include "lib/trace/geometry/plane.h"
+#include "lib/trace/geometry/sphere.h"
 #include "lib/trace/material/dielectric.h"
 #include "lib/trace/material/emissive.h"
 #include "lib/trace/material/lambertian.h"
@@ -36,9 +36,9 @@ auto floatingSphere(RenderSettings const& settings) -> Composition
     std::make_unique<trace::Lambertian>(lina::Vec3{ 0.9296, 0.9179, 0.8476 }));
 
   // dome
-  auto dome = trace::buildIcosphere(lina::Vec3{ 0.0, 0.0, -400.0 }, 6000.0, 5);
+  auto dome = trace::buildSphere(lina::Vec3{ 0.0, 0.0, -400.0 }, 6000.0);
   sceneElements.emplace_back(
-    std::make_unique<trace::Icosphere>(std::move(dome)), std::make_unique<trace::Metal>(lina::Vec3{ 1.0, 1.0, 1.0 }));
+    std::make_unique<trace::Sphere>(std::move(dome)), std::make_unique<trace::Metal>(lina::Vec3{ 1.0, 1.0, 1.0 }));
 
   // lights
   auto whiteLight = lina::Vec3{ 6.0, 6.0, 6.0 };
@@ -66,9 +66,9 @@ auto floatingSphere(RenderSettings const& settings) -> Composition
     std::make_unique<trace::Plane>(std::move(blueStrip)), std::make_unique<trace::Emissive>(blueLight, true));
 
   // sphere
-  auto floatingSphere = trace::buildIcosphere(lina::Vec3{ 0.0, 0.0, 800.0 }, 1000, 4);
+  auto floatingSphere = trace::buildSphere(lina::Vec3{ 0.0, 0.0, 800.0 }, 1000);
   sceneElements.emplace_back(
-    std::make_unique<trace::Icosphere>(std::move(floatingSphere)), std::make_unique<trace::Dielectric>(1.5));
+    std::make_unique<trace::Sphere>(std::move(floatingSphere)), std::make_unique<trace::Dielectric>(1.5));
 
   return Composition{
     camera, settings.sampleCount, settings.rayDepth, std::move(sceneElements), masterLightIndex, false
@@ -55,7 +55,7 @@ auto configurations() -> std::map<std::string, Configuration>
           1.0,
         } } },
     { "floating-sphere",
-      Configuration{ "A floating glass icosphere inside a metal icosphere, lit from below by 4 lights. A white light "
+      Configuration{ "A floating glass sphere inside a metal sphere, lit from below by 4 lights. A white light "
                      "at the center of the frame and a red, green, blue light strips further back. The RGB light strip "
                      "produces a pleasing rainbow pattern on the surface of the metal dome and in the refraction of "
                      "the sphere.Pleas note, this is a tasking scene.Even with the default settings, it can take up to "